@@ -0,0 +1,133 @@
+﻿// 체크섬 검증 및 처리량 벤치마크
+// 먼저 CRC32C와 테이블 계산(CRC32CTable)이 표준 검사값 CRC32C("123456789") = 0xE3069283 을 내는지,
+// 그리고 여러 길이와 정렬되지 않은 위치, 나누어 계산한 경우에도 두 계산 결과가 같은지 확인합니다
+// 이후 메시지 크기별로 이전 체크섬(바이트 합 % 256), 테이블 계산, CRC32C의 초당 처리량(GB/s)을 측정합니다
+//
+// 사용법 : ChecksumBench [megabytes per size]
+// 빌드 (Linux) : g++ -std=c++14 -O2 -pthread -I../IOCPCore ChecksumBench.cpp ../IOCPCore/Checksum.cpp -o ChecksumBench
+// 빌드 (Windows) : cl /O2 /EHsc /I..\IOCPCore ChecksumBench.cpp ..\IOCPCore\Checksum.cpp
+
+#include "Core.h"
+#include "Checksum.h"
+
+using namespace azely;
+
+#define BENCH_VERIFY_SIZE_MAX 3000
+#define BENCH_CHECK_VALUE 0xE3069283
+
+typedef UINT32(*ChecksumFunction)(const UCHAR *data, size_t size);
+
+static volatile UINT32	checksumSink = 0;
+
+/**
+ * \brief 이전 SerializedBuffer가 쓰던 체크섬 (비교용)
+ */
+static UINT32 ByteSum(const UCHAR *data, size_t size)
+{
+	UINT32 calculatedChecksum = 0;
+	for (size_t i = 0; i < size; i++)
+	{
+		calculatedChecksum += data[i];
+	}
+	return calculatedChecksum % 256;
+}
+
+static UINT32 CRC32CTableOnly(const UCHAR *data, size_t size)
+{
+	return Checksum::CRC32CTable(data, size);
+}
+
+static UINT32 CRC32CDefault(const UCHAR *data, size_t size)
+{
+	return Checksum::CRC32C(data, size);
+}
+
+/**
+ * \brief CRC32C와 테이블 계산이 검사값을 내고, 모든 길이와 시작 위치에서 서로 같은지 확인합니다
+ * \return 모두 같다면 true
+ */
+static BOOL Verify(const UCHAR *buffer)
+{
+	const UCHAR *checkString = reinterpret_cast<const UCHAR *>("123456789");
+	UINT32 hardwareCheck = Checksum::CRC32C(checkString, 9);
+	UINT32 tableCheck = Checksum::CRC32CTable(checkString, 9);
+	wcout << L"crc32c(\"123456789\") : " << hex << hardwareCheck << L" / table : " << tableCheck << dec << endl;
+	if (hardwareCheck != BENCH_CHECK_VALUE || tableCheck != BENCH_CHECK_VALUE) return false;
+
+	for (INT32 offset = 0; offset < 8; offset++)
+	{
+		for (INT32 size = 0; size <= BENCH_VERIFY_SIZE_MAX; size++)
+		{
+			const UCHAR *data = buffer + offset;
+			UINT32 tableCRC = Checksum::CRC32CTable(data, size);
+			if (Checksum::CRC32C(data, size) != tableCRC) return false;
+
+			// 나누어 계산한 결과도 한 번에 계산한 결과와 같아야 합니다
+			INT32 splitSize = size / 3;
+			if (Checksum::CRC32C(data + splitSize, size - splitSize, Checksum::CRC32C(data, splitSize)) != tableCRC) return false;
+			if (Checksum::CRC32CTable(data + splitSize, size - splitSize, Checksum::CRC32CTable(data, splitSize)) != tableCRC) return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief 같은 크기의 메시지를 totalSize 바이트만큼 반복 계산하여 처리량을 잽니다
+ * \return GB/s
+ */
+static double Measure(ChecksumFunction function, const UCHAR *data, size_t size, DWORD64 totalSize)
+{
+	DWORD64 repeatCount = totalSize / size;
+	if (repeatCount == 0) repeatCount = 1;
+
+	UINT32 checksum = 0;
+	DWORD startTime = timeGetTime();
+	for (DWORD64 i = 0; i < repeatCount; i++)
+	{
+		checksum += function(data, size);
+	}
+	DWORD elapsedTime = timeGetTime() - startTime;
+	checksumSink = checksum;
+
+	return static_cast<double>(repeatCount * size) / (elapsedTime == 0 ? 1 : elapsedTime) / 1000000.0;
+}
+
+int main(int argc, char *argv[])
+{
+	INT32 megabytes = argc > 1 ? atoi(argv[1]) : 256;
+
+	// 만일 측정 크기가 범위를 벗어난다면 범위 안으로 맞춥니다
+	if (megabytes < 1) megabytes = 1;
+	if (megabytes > 4096) megabytes = 4096;
+
+	// 정렬되지 않은 위치에서 시작하도록 1바이트 어긋나게 씁니다
+	const size_t bufferSize = 1024 * 1024 + 64;
+	UCHAR *buffer = new UCHAR[bufferSize];
+	srand(12345);
+	for (size_t i = 0; i < bufferSize; i++)
+	{
+		buffer[i] = static_cast<UCHAR>(rand());
+	}
+
+	wcout << L"hardware crc32c : " << (Checksum::IsHardwareCRC32C() ? L"yes" : L"no") << endl;
+	if (!Verify(buffer))
+	{
+		wcout << L"crc32c mismatch between hardware and table" << endl;
+		delete[] buffer;
+		return 1;
+	}
+	wcout << L"crc32c hardware and table results agree" << endl;
+
+	const size_t sizes[] = { 8, 64, 1460, 16384, 1024 * 1024 };
+	DWORD64 totalSize = static_cast<DWORD64>(megabytes) * 1024 * 1024;
+	for (size_t size : sizes)
+	{
+		wcout << L"size " << size;
+		wcout << L" / byte sum GB/s : " << Measure(ByteSum, buffer + 1, size, totalSize);
+		wcout << L" / table GB/s : " << Measure(CRC32CTableOnly, buffer + 1, size, totalSize);
+		wcout << L" / crc32c GB/s : " << Measure(CRC32CDefault, buffer + 1, size, totalSize) << endl;
+	}
+
+	delete[] buffer;
+	return 0;
+}
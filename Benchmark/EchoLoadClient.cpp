@@ -0,0 +1,281 @@
+﻿// 에코서버 루프백 부하 클라이언트
+// 연결마다 스레드 하나가 메시지를 pipeline 개씩 보내 두고, 에코가 돌아온 만큼 다시 보내며 초당 에코 개수를 측정합니다
+// payload는 보내는 메시지의 페이로드 크기이며, 에코서버는 앞의 DWORD64만 되돌려주므로 되돌아오는 메시지는 항상 DWORD64 페이로드입니다
+// churn 모드는 연결, 메시지 한 번 왕복, 종료를 반복하여 세션 생성과 정리(종료 통지) 경로의 초당 처리량을 측정합니다
+//
+// 사용법 : EchoLoadClient [address] [port] [connections] [pipeline] [seconds] [echo|churn] [payload]
+// 빌드 (Linux) : g++ -std=c++14 -O2 -pthread -I../IOCPCore EchoLoadClient.cpp ../IOCPCore/Checksum.cpp -o EchoLoadClient
+// 빌드 (Windows) : cl /O2 /EHsc /I..\IOCPCore EchoLoadClient.cpp ..\IOCPCore\Checksum.cpp
+
+#include "Core.h"
+#include "NetworkHeader.h"
+
+using namespace azely;
+
+#define LOAD_CONNECTION_MAX 256
+#define LOAD_PIPELINE_MAX 1024
+#define LOAD_PAYLOAD_MAX 4096
+
+struct LoadSettings
+{
+	WCHAR address[64];
+	INT32 connectionCount;
+	INT32 pipeline;
+	INT32 seconds;
+	INT32 payloadSize;
+	BOOL isChurn;
+};
+
+/**
+ * \brief 연결 스레드마다 세는 완료 개수, 다른 스레드와 캐시 라인을 나누지 않도록 정렬합니다
+ */
+struct alignas(64) LoadCounter
+{
+	volatile DWORD64 completeCount;
+	volatile DWORD64 failCount;
+};
+
+static LoadSettings	settings;
+static LoadCounter	counters[LOAD_CONNECTION_MAX];
+static volatile LONG	isStopped = false;
+static UCHAR		frame[NETWORK_HEADER_SIZE_MAX + LOAD_PAYLOAD_MAX];
+static INT32		frameSize = 0;
+static INT32		echoFrameSize = 0;
+
+/**
+ * \brief payload 크기의 메시지 하나를 만들고, 에코서버가 되돌려줄 DWORD64 페이로드 메시지의 크기를 구합니다
+ */
+static VOID BuildFrame()
+{
+	UCHAR payload[LOAD_PAYLOAD_MAX];
+	DWORD64 echoData = 0x0123456789abcdef;
+	memcpy(payload, &echoData, sizeof(echoData));
+	for (INT32 i = sizeof(echoData); i < settings.payloadSize; i++)
+	{
+		payload[i] = static_cast<UCHAR>(i);
+	}
+
+	NetworkHeader header;
+	header.secureCode = NETWORK_SECURE_CODE;
+	header.length = settings.payloadSize;
+#ifndef _SIMPLE_HEADER
+	header.checksum = NETWORK_CHECKSUM(payload, settings.payloadSize);
+#endif
+	frameSize = EncodeNetworkHeader(&header, frame);
+	memcpy(frame + frameSize, payload, settings.payloadSize);
+	frameSize += settings.payloadSize;
+
+	UCHAR echoHeader[NETWORK_HEADER_SIZE_MAX];
+	header.length = sizeof(echoData);
+	echoFrameSize = EncodeNetworkHeader(&header, echoHeader) + sizeof(echoData);
+}
+
+/**
+ * \brief 서버에 연결된 소켓을 만듭니다
+ * \return 연결된 소켓, 실패했다면 INVALID_SOCKET
+ */
+static SOCKET Connect()
+{
+	SOCKADDR_IN serverAddress;
+	INT serverAddressLength = sizeof(serverAddress);
+	ZeroMemory(&serverAddress, sizeof(serverAddress));
+	if (WSAStringToAddressW(settings.address, AF_INET, nullptr, reinterpret_cast<LPSOCKADDR>(&serverAddress), &serverAddressLength) != 0)
+	{
+		return INVALID_SOCKET;
+	}
+
+	SOCKET clientSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (clientSocket == INVALID_SOCKET) return INVALID_SOCKET;
+	int nodelay = 1;
+	setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&nodelay), sizeof(nodelay));
+	if (connect(clientSocket, reinterpret_cast<PSOCKADDR>(&serverAddress), sizeof(serverAddress)) != 0)
+	{
+		closesocket(clientSocket);
+		return INVALID_SOCKET;
+	}
+	return clientSocket;
+}
+
+/**
+ * \brief 버퍼를 모두 보냅니다
+ * \return 성공 여부
+ */
+static BOOL SendAll(SOCKET clientSocket, const char *buffer, INT32 size)
+{
+	while (size > 0)
+	{
+		int sendResult = send(clientSocket, buffer, size, 0);
+		if (sendResult <= 0) return false;
+		buffer += sendResult;
+		size -= sendResult;
+	}
+	return true;
+}
+
+/**
+ * \brief 메시지를 pipeline 개씩 띄워 두고, 돌아온 에코 개수만큼 다시 보냅니다
+ */
+static UINT WINAPI EchoThread(PVOID param)
+{
+	LoadCounter *counter = static_cast<LoadCounter *>(param);
+	SOCKET clientSocket = Connect();
+	if (clientSocket == INVALID_SOCKET)
+	{
+		counter->failCount++;
+		return 0;
+	}
+
+	char *sendBuffer = new char[frameSize * settings.pipeline];
+	for (INT32 i = 0; i < settings.pipeline; i++)
+	{
+		memcpy(sendBuffer + i * frameSize, frame, frameSize);
+	}
+	char recvBuffer[65536];
+	INT32 pendingSize = 0;
+
+	if (SendAll(clientSocket, sendBuffer, frameSize * settings.pipeline))
+	{
+		while (!isStopped)
+		{
+			int recvResult = recv(clientSocket, recvBuffer, sizeof(recvBuffer), 0);
+			if (recvResult <= 0)
+			{
+				counter->failCount++;
+				break;
+			}
+
+			// 다 받은 에코 개수만큼 세고, 같은 개수를 다시 보냅니다
+			pendingSize += recvResult;
+			INT32 echoCount = pendingSize / echoFrameSize;
+			pendingSize -= echoCount * echoFrameSize;
+			counter->completeCount += echoCount;
+			while (echoCount > 0)
+			{
+				INT32 sendCount = echoCount < settings.pipeline ? echoCount : settings.pipeline;
+				if (!SendAll(clientSocket, sendBuffer, frameSize * sendCount))
+				{
+					counter->failCount++;
+					isStopped = true;
+					break;
+				}
+				echoCount -= sendCount;
+			}
+		}
+	} else
+	{
+		counter->failCount++;
+	}
+
+	delete[] sendBuffer;
+	closesocket(clientSocket);
+	return 0;
+}
+
+/**
+ * \brief 연결, 메시지 한 번 왕복, 종료를 반복합니다
+ */
+static UINT WINAPI ChurnThread(PVOID param)
+{
+	LoadCounter *counter = static_cast<LoadCounter *>(param);
+	char recvBuffer[256];
+
+	while (!isStopped)
+	{
+		SOCKET clientSocket = Connect();
+		if (clientSocket == INVALID_SOCKET)
+		{
+			counter->failCount++;
+			Sleep(1);
+			continue;
+		}
+
+		BOOL isEchoed = SendAll(clientSocket, reinterpret_cast<const char *>(frame), frameSize);
+		INT32 recvSize = 0;
+		while (isEchoed && recvSize < echoFrameSize)
+		{
+			int recvResult = recv(clientSocket, recvBuffer + recvSize, sizeof(recvBuffer) - recvSize, 0);
+			if (recvResult <= 0)
+			{
+				isEchoed = false;
+				break;
+			}
+			recvSize += recvResult;
+		}
+		closesocket(clientSocket);
+
+		if (isEchoed)
+		{
+			counter->completeCount++;
+		} else
+		{
+			counter->failCount++;
+		}
+	}
+	return 0;
+}
+
+/**
+ * \brief 모든 연결 스레드의 완료 개수를 합합니다
+ */
+static DWORD64 SumComplete()
+{
+	DWORD64 completeCount = 0;
+	for (INT32 i = 0; i < settings.connectionCount; i++)
+	{
+		completeCount += counters[i].completeCount;
+	}
+	return completeCount;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *address = argc > 1 ? argv[1] : "127.0.0.1";
+	INT32 port = argc > 2 ? atoi(argv[2]) : 6000;
+	settings.connectionCount = argc > 3 ? atoi(argv[3]) : 16;
+	settings.pipeline = argc > 4 ? atoi(argv[4]) : 32;
+	settings.seconds = argc > 5 ? atoi(argv[5]) : 5;
+	settings.isChurn = argc > 6 && strcmp(argv[6], "churn") == 0;
+	settings.payloadSize = argc > 7 ? atoi(argv[7]) : sizeof(DWORD64);
+
+	// 만일 연결 수와 pipeline, payload가 범위를 벗어난다면 범위 안으로 맞춥니다
+	if (settings.connectionCount < 1) settings.connectionCount = 1;
+	if (settings.connectionCount > LOAD_CONNECTION_MAX) settings.connectionCount = LOAD_CONNECTION_MAX;
+	if (settings.pipeline < 1) settings.pipeline = 1;
+	if (settings.pipeline > LOAD_PIPELINE_MAX) settings.pipeline = LOAD_PIPELINE_MAX;
+	if (settings.seconds < 1) settings.seconds = 1;
+	if (settings.payloadSize < static_cast<INT32>(sizeof(DWORD64))) settings.payloadSize = sizeof(DWORD64);
+	if (settings.payloadSize > LOAD_PAYLOAD_MAX) settings.payloadSize = LOAD_PAYLOAD_MAX;
+	swprintf(settings.address, 64, L"%hs:%d", address, port);
+
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return -1;
+	BuildFrame();
+
+	HANDLE threads[LOAD_CONNECTION_MAX];
+	for (INT32 i = 0; i < settings.connectionCount; i++)
+	{
+		threads[i] = (HANDLE)_beginthreadex(nullptr, 0, settings.isChurn ? ChurnThread : EchoThread, &counters[i], 0, nullptr);
+	}
+
+	// 연결이 자리잡을 때까지 1초를 기다린 뒤부터 잽니다
+	Sleep(1000);
+	DWORD64 startCount = SumComplete();
+	DWORD startTime = timeGetTime();
+	Sleep(settings.seconds * 1000);
+	DWORD64 endCount = SumComplete();
+	DWORD elapsedTime = timeGetTime() - startTime;
+
+	isStopped = true;
+	WaitForMultipleObjects(settings.connectionCount, threads, true, INFINITE);
+
+	DWORD64 failCount = 0;
+	for (INT32 i = 0; i < settings.connectionCount; i++)
+	{
+		failCount += counters[i].failCount;
+	}
+	wcout << (settings.isChurn ? L"connections per second : " : L"echo messages per second : ") << (endCount - startCount) * 1000 / (elapsedTime == 0 ? 1 : elapsedTime);
+	wcout << L" / failures : " << failCount << endl;
+
+	WSACleanup();
+	return failCount == 0 ? 0 : 1;
+}
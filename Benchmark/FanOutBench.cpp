@@ -0,0 +1,349 @@
+﻿// 브로드캐스트 송신 벤치마크
+// 같은 프로세스에 서버를 띄우고 루프백 클라이언트를 접속시킨 뒤, 메시지 하나를 수신자 전원에게 보내는 라운드를 반복합니다
+// 세션마다 SendPacket을 호출하는 방식과 SendPacketMulti, SendPacketGroup을 수신자 10, 100, 1000 명으로 비교하여
+// 보내는 호출에 걸린 수신자당 시간(ns)과, 클라이언트가 모두 받기까지의 초당 수신 메시지 개수를 측정합니다
+// 클라이언트가 받은 바이트 수가 보낸 메시지 수와 맞지 않거나 서버 예외가 발생했다면 실패로 처리합니다
+//
+// 사용법 : FanOutBench [port] [messages per recipient] [payload] [sendZeroCopy]
+// 빌드 (Linux) : g++ -std=c++14 -O2 -pthread -I../IOCPCore FanOutBench.cpp ../IOCPCore/*.cpp -o FanOutBench -lcrypto
+// 빌드 (Windows) : cl /O2 /EHsc /I..\IOCPCore FanOutBench.cpp ..\lib\IOCPCore.lib
+
+#include "IOCPServer.h"
+#include <chrono>
+
+#ifdef _WIN32
+#define poll WSAPoll
+#endif
+
+using namespace azely;
+
+#define FANOUT_RECIPIENT_MAX 1000
+#define FANOUT_PAYLOAD_MAX 1024
+// 수신자마다 클라이언트가 아직 받지 않은 메시지를 이 개수까지만 두어, 세션의 송신 링버퍼가 넘치지 않도록 합니다
+#define FANOUT_WINDOW 32
+
+struct FanOutSettings
+{
+	INT32 port;
+	INT32 messageCount;
+	INT32 payloadSize;
+	INT32 sendZeroCopy;
+};
+
+enum FanOutMode
+{
+	FANOUT_SEND_PACKET,
+	FANOUT_SEND_PACKET_MULTI,
+	FANOUT_SEND_PACKET_GROUP
+};
+
+/**
+ * \brief 접속한 세션 ID를 모아두고 그 외의 통지는 무시하는 서버
+ */
+class FanOutServer : public IOCPServer
+{
+public:
+	BOOL Start(const FanOutSettings *fanOutSettings)
+	{
+		InitializeSRWLock(&sessionSRW);
+		sessionCount = 0;
+		exceptionCount = 0;
+
+		// 클라이언트는 보내지 않으므로, 측정 도중 타임아웃되지 않도록 타임아웃을 길게 잡습니다
+		IOCPServerSettings::Settings settings;
+		wcscpy(settings.listenAddress, L"127.0.0.1");
+		settings.listenPort = static_cast<USHORT>(fanOutSettings->port);
+		settings.nodelay = 1;
+		settings.sessionCountMax = FANOUT_RECIPIENT_MAX + 100;
+		settings.sessionTimeout = 3600000;
+		settings.sendZeroCopy = fanOutSettings->sendZeroCopy;
+		return InitializeServer(&settings) && ReadyServer() && ListenServer();
+	}
+
+	VOID Stop()
+	{
+		StopServer();
+	}
+
+	INT32 GetSessionIDs(DWORD64 *outSessionIDs)
+	{
+		AcquireSRWLockShared(&sessionSRW);
+		INT32 count = sessionCount;
+		memcpy(outSessionIDs, sessionIDs, sizeof(DWORD64) * count);
+		ReleaseSRWLockShared(&sessionSRW);
+		return count;
+	}
+
+	LONG GetExceptionCount() const
+	{
+		return exceptionCount;
+	}
+
+protected:
+	VOID OnRecvMessage(DWORD64 /*sessionID*/, SerializedBuffer * /*message*/) override
+	{
+	}
+
+	BOOL OnSessionConnectionRequest(DWORD /*addressIP*/, USHORT /*addressPort*/, PCWSTR /*addressString*/) override
+	{
+		return true;
+	}
+
+	VOID OnSessionConnected(DWORD64 sessionID, DWORD /*addressIP*/, USHORT /*addressPort*/, PCWSTR /*addressString*/) override
+	{
+		AcquireSRWLockExclusive(&sessionSRW);
+		if (sessionCount < FANOUT_RECIPIENT_MAX) sessionIDs[sessionCount++] = sessionID;
+		ReleaseSRWLockExclusive(&sessionSRW);
+	}
+
+	VOID OnSessionDisconnected(DWORD64 /*sessionID*/) override
+	{
+	}
+
+	VOID OnSessionTimeout(DWORD64 /*sessionID*/) override
+	{
+	}
+
+	VOID OnException(IOCPServerException /*exception*/) override
+	{
+		InterlockedIncrement(&exceptionCount);
+	}
+
+private:
+	SRWLOCK			sessionSRW;
+	DWORD64			sessionIDs[FANOUT_RECIPIENT_MAX];
+	INT32			sessionCount;
+	volatile LONG	exceptionCount;
+};
+
+static FanOutSettings	settings;
+static FanOutServer		server;
+static SOCKET			clientSockets[FANOUT_RECIPIENT_MAX];
+static DWORD64			sessionIDs[FANOUT_RECIPIENT_MAX];
+static volatile DWORD64	recvTotalSize = 0;
+static volatile LONG	isStopped = false;
+
+static DWORD64 GetNanoseconds()
+{
+	return static_cast<DWORD64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * \brief 모든 클라이언트 소켓에서 받은 만큼 버리며 받은 바이트 수를 셉니다
+ */
+static UINT WINAPI DrainThread(PVOID /*param*/)
+{
+	static pollfd pollSockets[FANOUT_RECIPIENT_MAX];
+	char recvBuffer[65536];
+	for (INT32 i = 0; i < FANOUT_RECIPIENT_MAX; i++)
+	{
+		pollSockets[i].fd = clientSockets[i];
+		pollSockets[i].events = POLLIN;
+	}
+
+	while (!isStopped)
+	{
+		int readyCount = poll(pollSockets, FANOUT_RECIPIENT_MAX, 10);
+		for (INT32 i = 0; i < FANOUT_RECIPIENT_MAX && readyCount > 0; i++)
+		{
+			if (pollSockets[i].revents == 0) continue;
+			readyCount--;
+			int recvResult = recv(clientSockets[i], recvBuffer, sizeof(recvBuffer), 0);
+			if (recvResult > 0) InterlockedExchangeAdd(&recvTotalSize, static_cast<DWORD64>(recvResult));
+		}
+	}
+	return 0;
+}
+
+/**
+ * \brief 서버에 연결된 클라이언트 소켓을 만듭니다
+ */
+static SOCKET Connect()
+{
+	SOCKADDR_IN serverAddress;
+	ZeroMemory(&serverAddress, sizeof(serverAddress));
+	serverAddress.sin_family = AF_INET;
+	serverAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	serverAddress.sin_port = htons(static_cast<USHORT>(settings.port));
+
+	SOCKET clientSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (clientSocket == INVALID_SOCKET) return INVALID_SOCKET;
+	if (connect(clientSocket, reinterpret_cast<PSOCKADDR>(&serverAddress), sizeof(serverAddress)) != 0)
+	{
+		closesocket(clientSocket);
+		return INVALID_SOCKET;
+	}
+	return clientSocket;
+}
+
+/**
+ * \brief 한 방식으로 수신자 recipientCount 명에게 메시지를 messageCount 번씩 보냅니다
+ * \param outCallNanoseconds [out] 보내는 호출에 걸린 시간의 합
+ * \param outElapsedMilliseconds [out] 클라이언트가 모두 받기까지 걸린 시간
+ * \return 클라이언트가 받은 바이트 수가 맞다면 true
+ */
+static BOOL RunFanOut(FanOutMode mode, INT32 recipientCount, INT32 frameSize, DWORD64 *outCallNanoseconds, DWORD *outElapsedMilliseconds)
+{
+	UCHAR payload[FANOUT_PAYLOAD_MAX];
+	memset(payload, 0x5a, settings.payloadSize);
+	DWORD64 groupID = static_cast<DWORD64>(recipientCount);
+	if (mode == FANOUT_SEND_PACKET_GROUP)
+	{
+		for (INT32 i = 0; i < recipientCount; i++)
+		{
+			server.JoinGroup(groupID, sessionIDs[i]);
+		}
+	}
+
+	// 세션마다 SendPacket으로 보내는 방식은 컨텐츠에서 만든 메시지 하나를 그대로 넘깁니다
+	SerializedBuffer message;
+	DWORD64 startSize = recvTotalSize;
+	DWORD64 roundSize = static_cast<DWORD64>(recipientCount) * frameSize;
+	DWORD64 callNanoseconds = 0;
+	DWORD startTime = timeGetTime();
+	for (INT32 round = 0; round < settings.messageCount; round++)
+	{
+		// 클라이언트가 받지 않은 메시지가 많다면 받을 때까지 양보합니다
+		while (startSize + roundSize * round - recvTotalSize > roundSize * FANOUT_WINDOW)
+		{
+			SwitchToThread();
+		}
+
+		DWORD64 callStartTime = GetNanoseconds();
+		if (mode == FANOUT_SEND_PACKET)
+		{
+			message.Clear(true);
+			message.PutData(payload, settings.payloadSize);
+			for (INT32 i = 0; i < recipientCount; i++)
+			{
+				server.SendPacket(sessionIDs[i], &message);
+			}
+		} else
+		{
+			SerializedBuffer *packet = server.AllocPacket(settings.payloadSize);
+			packet->PutData(payload, settings.payloadSize);
+			if (mode == FANOUT_SEND_PACKET_MULTI)
+			{
+				server.SendPacketMulti(sessionIDs, recipientCount, packet);
+			} else
+			{
+				server.SendPacketGroup(groupID, packet);
+			}
+			server.FreePacket(packet);
+		}
+		callNanoseconds += GetNanoseconds() - callStartTime;
+	}
+
+	// 클라이언트가 모두 받을 때까지 기다리되, 빠진 메시지가 있다면 더 오지 않으므로 1초 동안 늘지 않으면 멈춥니다
+	DWORD64 expectedSize = startSize + roundSize * settings.messageCount;
+	DWORD64 lastSize = recvTotalSize;
+	DWORD lastTime = timeGetTime();
+	while (recvTotalSize < expectedSize && timeGetTime() - lastTime < 1000)
+	{
+		SwitchToThread();
+		if (recvTotalSize != lastSize)
+		{
+			lastSize = recvTotalSize;
+			lastTime = timeGetTime();
+		}
+	}
+	*outElapsedMilliseconds = timeGetTime() - startTime;
+	*outCallNanoseconds = callNanoseconds;
+
+	if (mode == FANOUT_SEND_PACKET_GROUP)
+	{
+		for (INT32 i = 0; i < recipientCount; i++)
+		{
+			server.LeaveGroup(groupID, sessionIDs[i]);
+		}
+	}
+	return recvTotalSize == expectedSize;
+}
+
+int main(int argc, char *argv[])
+{
+	settings.port = argc > 1 ? atoi(argv[1]) : 6100;
+	settings.messageCount = argc > 2 ? atoi(argv[2]) : 1000;
+	settings.payloadSize = argc > 3 ? atoi(argv[3]) : 64;
+	settings.sendZeroCopy = argc > 4 ? atoi(argv[4]) : 0;
+
+	// 만일 메시지 개수와 페이로드 크기가 범위를 벗어난다면 범위 안으로 맞춥니다
+	if (settings.messageCount < 1) settings.messageCount = 1;
+	if (settings.payloadSize < 1) settings.payloadSize = 1;
+	if (settings.payloadSize > FANOUT_PAYLOAD_MAX) settings.payloadSize = FANOUT_PAYLOAD_MAX;
+	if (settings.sendZeroCopy != 0) settings.sendZeroCopy = 1;
+
+	if (!server.Start(&settings))
+	{
+		wcout << L"server start failed" << endl;
+		return 1;
+	}
+
+	// 수신자를 모두 접속시키고, 서버가 접속을 다 처리할 때까지 기다립니다
+	for (INT32 i = 0; i < FANOUT_RECIPIENT_MAX; i++)
+	{
+		clientSockets[i] = Connect();
+		if (clientSockets[i] == INVALID_SOCKET)
+		{
+			wcout << L"connect failed at " << i << endl;
+			return 1;
+		}
+	}
+	DWORD connectStartTime = timeGetTime();
+	while (server.GetSessionIDs(sessionIDs) < FANOUT_RECIPIENT_MAX && timeGetTime() - connectStartTime < 10000)
+	{
+		Sleep(10);
+	}
+	if (server.GetSessionIDs(sessionIDs) < FANOUT_RECIPIENT_MAX)
+	{
+		wcout << L"sessions not connected" << endl;
+		return 1;
+	}
+	HANDLE drainThread = (HANDLE)_beginthreadex(nullptr, 0, DrainThread, nullptr, 0, nullptr);
+
+	// 네트워크 헤더를 붙인 메시지 하나의 크기를 구합니다
+	UCHAR header[NETWORK_HEADER_SIZE_MAX];
+	NetworkHeader networkHeader;
+	networkHeader.secureCode = NETWORK_SECURE_CODE;
+	networkHeader.length = settings.payloadSize;
+#ifndef _SIMPLE_HEADER
+	networkHeader.checksum = 0;
+#endif
+	INT32 frameSize = EncodeNetworkHeader(&networkHeader, header) + settings.payloadSize;
+
+	const PCWSTR modeNames[] = { L"SendPacket", L"SendPacketMulti", L"SendPacketGroup" };
+	const INT32 recipientCounts[] = { 10, 100, 1000 };
+	BOOL isFailed = false;
+	wcout << L"sendZeroCopy : " << settings.sendZeroCopy << L" / payload : " << settings.payloadSize << L" / messages per recipient : " << settings.messageCount << endl;
+	for (INT32 recipientCount : recipientCounts)
+	{
+		for (INT32 mode = FANOUT_SEND_PACKET; mode <= FANOUT_SEND_PACKET_GROUP; mode++)
+		{
+			DWORD64 callNanoseconds = 0;
+			DWORD elapsedTime = 0;
+			BOOL runResult = RunFanOut(static_cast<FanOutMode>(mode), recipientCount, frameSize, &callNanoseconds, &elapsedTime);
+			if (!runResult) isFailed = true;
+
+			DWORD64 deliveredCount = static_cast<DWORD64>(recipientCount) * settings.messageCount;
+			wcout << L"recipients " << recipientCount << L" / " << modeNames[mode];
+			wcout << L" / call ns per recipient : " << callNanoseconds / deliveredCount;
+			wcout << L" / delivered messages per second : " << deliveredCount * 1000 / (elapsedTime == 0 ? 1 : elapsedTime);
+			wcout << (runResult ? L"" : L" / delivery mismatch") << endl;
+		}
+	}
+
+	isStopped = true;
+	WaitForSingleObject(drainThread, INFINITE);
+	for (INT32 i = 0; i < FANOUT_RECIPIENT_MAX; i++)
+	{
+		closesocket(clientSockets[i]);
+	}
+	server.Stop();
+
+	if (server.GetExceptionCount() > 0)
+	{
+		wcout << L"server exceptions : " << server.GetExceptionCount() << endl;
+		isFailed = true;
+	}
+	return isFailed ? 1 : 0;
+}
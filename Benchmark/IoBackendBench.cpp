@@ -0,0 +1,435 @@
+﻿// 입출력 백엔드 비교 벤치마크 (Linux 전용)
+// ioBackend 설정(0 = epoll, 1 = io_uring multishot recv, 2 = io_uring 고정 버퍼 recv)마다 자식 프로세스에 에코 서버를 띄우고,
+// 부모 프로세스가 루프백 연결마다 메시지를 pipeline 개씩 띄워 두는 부하를 걸어 초당 에코 메시지 개수를 측정합니다
+// 측정 구간 동안 서버 프로세스가 부른 시스템 호출은 raw_syscalls:sys_enter 트레이스포인트 카운터(perf_event_open)로 세어 메시지당 횟수로 비교합니다
+// 트레이스포인트 카운터는 root 권한과 tracefs가 필요하며, 열 수 없다면 시스템 호출 횟수 없이 측정합니다
+// 에코된 값이 보낸 순서와 다르거나, 연결이 끊어졌거나, 서버 예외가 발생했다면 실패로 처리합니다
+//
+// 사용법 : IoBackendBench [port] [connections] [pipeline] [seconds] [workerThreadTotal]
+// 빌드 (Linux) : g++ -std=c++14 -O2 -pthread -I../IOCPCore IoBackendBench.cpp ../IOCPCore/*.cpp -o IoBackendBench -lcrypto
+
+#include "IOCPServer.h"
+#include <sys/wait.h>
+#include <linux/perf_event.h>
+
+using namespace azely;
+
+#define BENCH_CONNECTION_MAX 256
+#define BENCH_PIPELINE_MAX 1024
+#define BENCH_RECV_BUFFER_SIZE 32768
+#define BENCH_WARMUP_MILLISECONDS 500
+
+#define BENCH_SIGNAL_READY 'R'
+#define BENCH_SIGNAL_START 'S'
+#define BENCH_SIGNAL_STOP 'E'
+
+struct BenchSettings
+{
+	INT32 port;
+	INT32 connectionCount;
+	INT32 pipeline;
+	INT32 seconds;
+	INT32 workerThreadTotal;
+};
+
+/**
+ * \brief 서버 프로세스가 측정을 마치고 부모에게 넘기는 결과
+ */
+struct BenchServerResult
+{
+	INT64 syscallCount;
+	LONG exceptionCount;
+};
+
+/**
+ * \brief 받은 메시지의 DWORD64를 WorkerThread에서 바로 되돌려주는 에코 서버
+ */
+class BenchEchoServer : public IOCPServer
+{
+public:
+	BOOL Start(const BenchSettings *benchSettings, INT32 ioBackend)
+	{
+		exceptionCount = 0;
+
+		IOCPServerSettings::Settings settings;
+		wcscpy(settings.listenAddress, L"127.0.0.1");
+		settings.listenPort = static_cast<USHORT>(benchSettings->port);
+		settings.nodelay = 1;
+		settings.workerThreadTotal = benchSettings->workerThreadTotal;
+		settings.workerThreadRunning = benchSettings->workerThreadTotal;
+		settings.sessionCountMax = BENCH_CONNECTION_MAX + 100;
+		settings.sessionTimeout = 3600000;
+		settings.inlineDispatch = 1;
+		settings.ioBackend = ioBackend;
+		return InitializeServer(&settings) && ReadyServer() && ListenServer();
+	}
+
+	VOID Stop()
+	{
+		StopServer();
+	}
+
+	LONG GetExceptionCount() const
+	{
+		return exceptionCount;
+	}
+
+protected:
+	VOID OnRecvMessage(DWORD64 sessionID, SerializedBuffer *message) override
+	{
+		DWORD64 data = 0;
+		if (message->GetBufferSizeUsed() < static_cast<INT32>(sizeof(data)))
+		{
+			DisconnectSession(sessionID);
+			return;
+		}
+		*message >> data;
+		SerializedBuffer *echoPacket = AllocPacket(sizeof(data));
+		*echoPacket << data;
+		SendPacketPooled(sessionID, echoPacket);
+		FreePacket(echoPacket);
+	}
+
+	BOOL OnSessionConnectionRequest(DWORD /*addressIP*/, USHORT /*addressPort*/, PCWSTR /*addressString*/) override
+	{
+		return true;
+	}
+
+	VOID OnSessionConnected(DWORD64 /*sessionID*/, DWORD /*addressIP*/, USHORT /*addressPort*/, PCWSTR /*addressString*/) override
+	{
+	}
+
+	VOID OnSessionDisconnected(DWORD64 /*sessionID*/) override
+	{
+	}
+
+	VOID OnSessionTimeout(DWORD64 /*sessionID*/) override
+	{
+	}
+
+	VOID OnException(IOCPServerException /*exception*/) override
+	{
+		InterlockedIncrement(&exceptionCount);
+	}
+
+private:
+	volatile LONG	exceptionCount;
+};
+
+/**
+ * \brief 부하 연결 하나의 상태, 보낸 값과 에코된 값은 연결마다 0부터 1씩 늘어납니다
+ */
+struct BenchConnection
+{
+	SOCKET	clientSocket;
+	DWORD64	sendSequence;
+	DWORD64	recvSequence;
+	INT32	pendingSize;
+	char	pending[BENCH_RECV_BUFFER_SIZE];
+};
+
+static BenchSettings	settings;
+static BenchConnection	connections[BENCH_CONNECTION_MAX];
+static pollfd			pollSockets[BENCH_CONNECTION_MAX];
+static INT32			echoFrameSize = 0;
+
+/**
+ * \brief value를 페이로드로 담은 메시지 하나를 만듭니다
+ * \return 만든 메시지의 크기
+ */
+static INT32 BuildFrame(DWORD64 value, PUCHAR outFrame)
+{
+	NetworkHeader header;
+	header.secureCode = NETWORK_SECURE_CODE;
+	header.length = sizeof(value);
+#ifndef _SIMPLE_HEADER
+	header.checksum = NETWORK_CHECKSUM(reinterpret_cast<const UCHAR *>(&value), sizeof(value));
+#endif
+	INT32 headerSize = EncodeNetworkHeader(&header, outFrame);
+	memcpy(outFrame + headerSize, &value, sizeof(value));
+	return headerSize + sizeof(value);
+}
+
+/**
+ * \brief 다음 순서의 메시지를 count 개 보냅니다
+ * \return 성공 여부
+ */
+static BOOL SendFrames(BenchConnection *connection, INT32 count)
+{
+	static UCHAR sendBuffer[(NETWORK_HEADER_SIZE_MAX + sizeof(DWORD64)) * BENCH_PIPELINE_MAX];
+	INT32 sendSize = 0;
+	for (INT32 i = 0; i < count; i++)
+	{
+		sendSize += BuildFrame(connection->sendSequence++, sendBuffer + sendSize);
+	}
+
+	const char *buffer = reinterpret_cast<const char *>(sendBuffer);
+	while (sendSize > 0)
+	{
+		int sendResult = send(connection->clientSocket, buffer, sendSize, MSG_NOSIGNAL);
+		if (sendResult <= 0) return false;
+		buffer += sendResult;
+		sendSize -= sendResult;
+	}
+	return true;
+}
+
+/**
+ * \brief 받은 에코를 순서대로 확인하고, 돌아온 개수만큼 다시 보냅니다
+ * \param outEchoCount [out] 확인한 에코 개수가 더해집니다
+ * \return 연결이 끊어지지 않았고 에코가 순서대로 돌아왔다면 true
+ */
+static BOOL ReceiveEchoes(BenchConnection *connection, DWORD64 *outEchoCount)
+{
+	int recvResult = recv(connection->clientSocket, connection->pending + connection->pendingSize, BENCH_RECV_BUFFER_SIZE - connection->pendingSize, 0);
+	if (recvResult <= 0) return false;
+	connection->pendingSize += recvResult;
+
+	INT32 echoCount = connection->pendingSize / echoFrameSize;
+	for (INT32 i = 0; i < echoCount; i++)
+	{
+		DWORD64 echoData = 0;
+		memcpy(&echoData, connection->pending + (i + 1) * echoFrameSize - sizeof(echoData), sizeof(echoData));
+		if (echoData != connection->recvSequence++) return false;
+	}
+	connection->pendingSize -= echoCount * echoFrameSize;
+	memmove(connection->pending, connection->pending + echoCount * echoFrameSize, connection->pendingSize);
+	*outEchoCount += echoCount;
+	return echoCount == 0 || SendFrames(connection, echoCount);
+}
+
+/**
+ * \brief 모든 연결에 부하를 milliseconds 동안 겁니다
+ * \param outEchoCount [out] 확인한 에코 개수가 더해집니다
+ * \return 실패한 연결이 없다면 true
+ */
+static BOOL RunLoad(DWORD milliseconds, DWORD64 *outEchoCount)
+{
+	DWORD startTime = timeGetTime();
+	while (timeGetTime() - startTime < milliseconds)
+	{
+		int readyCount = poll(pollSockets, settings.connectionCount, 10);
+		if (readyCount < 0) return false;
+		for (INT32 i = 0; i < settings.connectionCount && readyCount > 0; i++)
+		{
+			if (pollSockets[i].revents == 0) continue;
+			readyCount--;
+			if (!ReceiveEchoes(&connections[i], outEchoCount)) return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief 서버에 연결된 클라이언트 소켓을 만듭니다
+ */
+static SOCKET Connect()
+{
+	SOCKADDR_IN serverAddress;
+	ZeroMemory(&serverAddress, sizeof(serverAddress));
+	serverAddress.sin_family = AF_INET;
+	serverAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	serverAddress.sin_port = htons(static_cast<USHORT>(settings.port));
+
+	SOCKET clientSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (clientSocket == INVALID_SOCKET) return INVALID_SOCKET;
+	int nodelay = 1;
+	setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&nodelay), sizeof(nodelay));
+	if (connect(clientSocket, reinterpret_cast<PSOCKADDR>(&serverAddress), sizeof(serverAddress)) != 0)
+	{
+		closesocket(clientSocket);
+		return INVALID_SOCKET;
+	}
+	return clientSocket;
+}
+
+/**
+ * \brief 이 프로세스와 이후에 만드는 스레드의 시스템 호출 횟수를 세는 카운터를 엽니다 (멈춘 상태로 열립니다)
+ * \return 카운터 파일 디스크립터, 열 수 없다면 -1
+ */
+static int OpenSyscallCounter()
+{
+	const char *idPaths[] = { "/sys/kernel/tracing/events/raw_syscalls/sys_enter/id", "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id" };
+	long long tracepointID = -1;
+	for (const char *idPath : idPaths)
+	{
+		FILE *idFile = fopen(idPath, "r");
+		if (idFile == nullptr) continue;
+		if (fscanf(idFile, "%lld", &tracepointID) != 1) tracepointID = -1;
+		fclose(idFile);
+		if (tracepointID >= 0) break;
+	}
+	if (tracepointID < 0) return -1;
+
+	perf_event_attr counterAttribute;
+	ZeroMemory(&counterAttribute, sizeof(counterAttribute));
+	counterAttribute.type = PERF_TYPE_TRACEPOINT;
+	counterAttribute.size = sizeof(counterAttribute);
+	counterAttribute.config = static_cast<DWORD64>(tracepointID);
+	counterAttribute.disabled = 1;
+	counterAttribute.inherit = 1;
+	return static_cast<int>(syscall(__NR_perf_event_open, &counterAttribute, 0, -1, -1, 0));
+}
+
+/**
+ * \brief 자식 프로세스에서 서버를 띄우고, 부모의 신호에 맞춰 시스템 호출 횟수를 센 뒤 결과를 넘깁니다
+ * \details WorkerThread의 횟수는 스레드가 끝날 때 카운터에 합쳐지므로, 서버를 중지한 뒤에 읽습니다
+ */
+static int RunServerProcess(INT32 ioBackend, int signalReadFD, int resultWriteFD)
+{
+	BenchServerResult result;
+	result.syscallCount = -1;
+	result.exceptionCount = 0;
+	int counterFD = OpenSyscallCounter();
+
+	BenchEchoServer server;
+	char signal = BENCH_SIGNAL_READY;
+	if (!server.Start(&settings, ioBackend)) return 1;
+	if (write(resultWriteFD, &signal, 1) != 1) return 1;
+
+	if (read(signalReadFD, &signal, 1) != 1 || signal != BENCH_SIGNAL_START) return 1;
+	if (counterFD >= 0) ioctl(counterFD, PERF_EVENT_IOC_ENABLE, 0);
+	if (read(signalReadFD, &signal, 1) != 1 || signal != BENCH_SIGNAL_STOP) return 1;
+	if (counterFD >= 0) ioctl(counterFD, PERF_EVENT_IOC_DISABLE, 0);
+
+	server.Stop();
+	if (counterFD >= 0)
+	{
+		DWORD64 counterValue = 0;
+		if (read(counterFD, &counterValue, sizeof(counterValue)) == sizeof(counterValue)) result.syscallCount = static_cast<INT64>(counterValue);
+		close(counterFD);
+	}
+	result.exceptionCount = server.GetExceptionCount();
+	if (write(resultWriteFD, &result, sizeof(result)) != sizeof(result)) return 1;
+	return 0;
+}
+
+/**
+ * \brief 백엔드 하나로 서버 프로세스를 띄워 부하를 걸고 결과를 출력합니다
+ * \return 실패가 없다면 true
+ */
+static BOOL RunBackend(INT32 ioBackend)
+{
+	int signalPipe[2];
+	int resultPipe[2];
+	if (pipe(signalPipe) != 0) return false;
+	if (pipe(resultPipe) != 0)
+	{
+		close(signalPipe[0]);
+		close(signalPipe[1]);
+		return false;
+	}
+
+	wcout.flush();
+	pid_t serverProcess = fork();
+	if (serverProcess == 0)
+	{
+		close(signalPipe[1]);
+		close(resultPipe[0]);
+		int exitCode = RunServerProcess(ioBackend, signalPipe[0], resultPipe[1]);
+		wcout.flush();
+		_exit(exitCode);
+	}
+	close(signalPipe[0]);
+	close(resultPipe[1]);
+
+	BOOL isFailed = serverProcess < 0;
+	char signal = 0;
+	if (!isFailed && (read(resultPipe[0], &signal, 1) != 1 || signal != BENCH_SIGNAL_READY)) isFailed = true;
+
+	// 연결마다 메시지를 pipeline 개씩 띄워 두고, 잠시 돌린 뒤부터 잽니다
+	INT32 connectedCount = 0;
+	for (INT32 i = 0; i < settings.connectionCount && !isFailed; i++)
+	{
+		BenchConnection *connection = &connections[i];
+		connection->clientSocket = Connect();
+		connection->sendSequence = 0;
+		connection->recvSequence = 0;
+		connection->pendingSize = 0;
+		if (connection->clientSocket == INVALID_SOCKET)
+		{
+			isFailed = true;
+			break;
+		}
+		connectedCount++;
+		pollSockets[i].fd = connection->clientSocket;
+		pollSockets[i].events = POLLIN;
+		if (!SendFrames(connection, settings.pipeline)) isFailed = true;
+	}
+
+	DWORD64 warmupCount = 0;
+	DWORD64 echoCount = 0;
+	DWORD elapsedTime = 0;
+	if (!isFailed && !RunLoad(BENCH_WARMUP_MILLISECONDS, &warmupCount)) isFailed = true;
+	if (!isFailed)
+	{
+		signal = BENCH_SIGNAL_START;
+		if (write(signalPipe[1], &signal, 1) != 1) isFailed = true;
+		DWORD startTime = timeGetTime();
+		if (!isFailed && !RunLoad(settings.seconds * 1000, &echoCount)) isFailed = true;
+		elapsedTime = timeGetTime() - startTime;
+	}
+
+	// 서버를 멈추게 하고 연결을 닫은 뒤 결과를 받습니다
+	signal = BENCH_SIGNAL_STOP;
+	if (write(signalPipe[1], &signal, 1) != 1) isFailed = true;
+	close(signalPipe[1]);
+	for (INT32 i = 0; i < connectedCount; i++)
+	{
+		closesocket(connections[i].clientSocket);
+	}
+
+	BenchServerResult result;
+	result.syscallCount = -1;
+	result.exceptionCount = 0;
+	if (read(resultPipe[0], &result, sizeof(result)) != sizeof(result)) isFailed = true;
+	close(resultPipe[0]);
+	int exitStatus = 0;
+	if (serverProcess > 0 && (waitpid(serverProcess, &exitStatus, 0) != serverProcess || !WIFEXITED(exitStatus) || WEXITSTATUS(exitStatus) != 0)) isFailed = true;
+	if (result.exceptionCount > 0) isFailed = true;
+
+	wcout << L"ioBackend " << ioBackend;
+	wcout << L" / echo messages per second : " << echoCount * 1000 / (elapsedTime == 0 ? 1 : elapsedTime);
+	if (result.syscallCount >= 0)
+	{
+		wcout << L" / syscalls : " << result.syscallCount;
+		wcout << L" / syscalls per message : " << static_cast<double>(result.syscallCount) / (echoCount == 0 ? 1 : echoCount);
+	} else
+	{
+		wcout << L" / syscalls : unavailable";
+	}
+	if (result.exceptionCount > 0) wcout << L" / server exceptions : " << result.exceptionCount;
+	wcout << (isFailed ? L" / failed" : L"") << endl;
+	return !isFailed;
+}
+
+int main(int argc, char *argv[])
+{
+	settings.port = argc > 1 ? atoi(argv[1]) : 6200;
+	settings.connectionCount = argc > 2 ? atoi(argv[2]) : 64;
+	settings.pipeline = argc > 3 ? atoi(argv[3]) : 16;
+	settings.seconds = argc > 4 ? atoi(argv[4]) : 3;
+	settings.workerThreadTotal = argc > 5 ? atoi(argv[5]) : 1;
+
+	// 만일 연결 수와 pipeline, 측정 시간, WorkerThread 개수가 범위를 벗어난다면 범위 안으로 맞춥니다
+	if (settings.connectionCount < 1) settings.connectionCount = 1;
+	if (settings.connectionCount > BENCH_CONNECTION_MAX) settings.connectionCount = BENCH_CONNECTION_MAX;
+	if (settings.pipeline < 1) settings.pipeline = 1;
+	if (settings.pipeline > BENCH_PIPELINE_MAX) settings.pipeline = BENCH_PIPELINE_MAX;
+	if (settings.seconds < 1) settings.seconds = 1;
+	if (settings.workerThreadTotal < 1) settings.workerThreadTotal = 1;
+
+	// 에코 메시지 하나의 크기를 구합니다
+	UCHAR echoFrame[NETWORK_HEADER_SIZE_MAX + sizeof(DWORD64)];
+	echoFrameSize = BuildFrame(0, echoFrame);
+
+	wcout << L"connections : " << settings.connectionCount << L" / pipeline : " << settings.pipeline << L" / seconds : " << settings.seconds << L" / workerThreadTotal : " << settings.workerThreadTotal << endl;
+	BOOL isFailed = false;
+	for (INT32 ioBackend = IO_BACKEND_EPOLL; ioBackend <= IO_BACKEND_URING_FIXED; ioBackend++)
+	{
+		// 백엔드마다 포트를 바꾸어, 이전 서버가 남긴 TIME_WAIT 연결과 겹치지 않게 합니다
+		if (!RunBackend(ioBackend)) isFailed = true;
+		settings.port++;
+	}
+	return isFailed ? 1 : 0;
+}
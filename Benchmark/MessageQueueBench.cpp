@@ -0,0 +1,224 @@
+﻿// 메시지 큐 마이크로벤치마크
+// 여러 생산자 스레드가 메시지를 넣고 한 소비자 스레드가 모두 꺼낼 때까지의 초당 메시지 개수를
+// 현재의 lock-free MPSC MessageQueue와 이전의 mutex + std::queue 교체(SwapQueue) 방식으로 각각 측정합니다
+//
+// 사용법 : MessageQueueBench [producers] [messages per producer] [rounds]
+// 빌드 (Linux) : g++ -std=c++14 -O2 -pthread -I../IOCPCore MessageQueueBench.cpp -o MessageQueueBench
+// 빌드 (Windows) : cl /O2 /EHsc /I..\IOCPCore MessageQueueBench.cpp
+
+#include "Core.h"
+#include "MessageQueue.h"
+#include <queue>
+#include <mutex>
+
+using namespace azely;
+
+#define BENCH_PRODUCER_MAX 64
+
+struct BenchNode
+{
+	BenchNode *volatile next;
+	DWORD64 value;
+};
+
+/**
+ * \brief 이전 IOCPServer가 쓰던 메시지 큐 (비교용)
+ * \details 넣을 때마다 mutex를 잡고, 꺼내는 스레드는 잠금 아래에서 큐 포인터를 통째로 교체한 뒤 비웁니다
+ */
+template <typename T>
+class SwapMessageQueue
+{
+public:
+	typedef queue<T> QueueType;
+
+	SwapMessageQueue()
+	{
+		messageQueue = new QueueType();
+	}
+
+	~SwapMessageQueue()
+	{
+		delete messageQueue;
+	}
+
+	void Enqueue(const T &message)
+	{
+		lock_guard<mutex> guard(locker);
+		messageQueue->push(message);
+	}
+
+	void SwapQueue(QueueType *&target)
+	{
+		lock_guard<mutex> guard(locker);
+		QueueType *swapTarget = messageQueue;
+		messageQueue = target;
+		target = swapTarget;
+	}
+
+private:
+	QueueType *messageQueue;
+	mutex locker;
+};
+
+struct BenchSettings
+{
+	INT32 producerCount;
+	INT32 messageCount;
+	INT32 roundCount;
+};
+
+struct alignas(64) ProducerContext
+{
+	BenchNode *nodes;
+};
+
+static BenchSettings				settings;
+static ProducerContext				producers[BENCH_PRODUCER_MAX];
+static volatile LONG				isStarted = false;
+static MessageQueue<BenchNode>		mpscQueue;
+static SwapMessageQueue<BenchNode *>	swapQueue;
+
+/**
+ * \brief 시작 신호가 올 때까지 기다립니다
+ */
+static VOID WaitStart()
+{
+	while (!isStarted)
+	{
+		SwitchToThread();
+	}
+}
+
+static UINT WINAPI MPSCProducerThread(PVOID param)
+{
+	ProducerContext *context = static_cast<ProducerContext *>(param);
+	WaitStart();
+	for (INT32 i = 0; i < settings.messageCount; i++)
+	{
+		mpscQueue.Enqueue(&context->nodes[i]);
+	}
+	return 0;
+}
+
+static UINT WINAPI SwapProducerThread(PVOID param)
+{
+	ProducerContext *context = static_cast<ProducerContext *>(param);
+	WaitStart();
+	for (INT32 i = 0; i < settings.messageCount; i++)
+	{
+		swapQueue.Enqueue(&context->nodes[i]);
+	}
+	return 0;
+}
+
+/**
+ * \brief 현재 IOCPServer의 LogicThread처럼, 비었을 때는 Wait로 잠들며 모든 메시지를 꺼냅니다
+ * \return 꺼낸 메시지 값의 합
+ */
+static DWORD64 ConsumeMPSC(DWORD64 totalCount)
+{
+	DWORD64 consumeCount = 0;
+	DWORD64 valueSum = 0;
+	while (consumeCount < totalCount)
+	{
+		BenchNode *node = mpscQueue.Dequeue();
+		if (node == nullptr)
+		{
+			mpscQueue.Wait();
+			continue;
+		}
+		valueSum += node->value;
+		consumeCount++;
+	}
+	return valueSum;
+}
+
+/**
+ * \brief 이전 IOCPServer의 PacketThread처럼, 큐를 교체해가며 쉬지 않고 모든 메시지를 꺼냅니다
+ * \return 꺼낸 메시지 값의 합
+ */
+static DWORD64 ConsumeSwap(DWORD64 totalCount)
+{
+	SwapMessageQueue<BenchNode *>::QueueType *currentQueue = new SwapMessageQueue<BenchNode *>::QueueType();
+	DWORD64 consumeCount = 0;
+	DWORD64 valueSum = 0;
+	while (consumeCount < totalCount)
+	{
+		swapQueue.SwapQueue(currentQueue);
+		while (!currentQueue->empty())
+		{
+			valueSum += currentQueue->front()->value;
+			currentQueue->pop();
+			consumeCount++;
+		}
+	}
+	delete currentQueue;
+	return valueSum;
+}
+
+/**
+ * \brief 생산자 스레드를 띄우고, 호출한 스레드가 소비자가 되어 한 라운드를 잽니다
+ * \return 초당 메시지 개수, 꺼낸 값의 합이 맞지 않다면 0
+ */
+static DWORD64 RunRound(BOOL isMPSC)
+{
+	DWORD64 totalCount = static_cast<DWORD64>(settings.producerCount) * settings.messageCount;
+	DWORD64 expectedSum = totalCount * (totalCount - 1) / 2;
+
+	isStarted = false;
+	HANDLE threads[BENCH_PRODUCER_MAX];
+	for (INT32 i = 0; i < settings.producerCount; i++)
+	{
+		threads[i] = (HANDLE)_beginthreadex(nullptr, 0, isMPSC ? MPSCProducerThread : SwapProducerThread, &producers[i], 0, nullptr);
+	}
+
+	DWORD startTime = timeGetTime();
+	InterlockedExchange(&isStarted, true);
+	DWORD64 valueSum = isMPSC ? ConsumeMPSC(totalCount) : ConsumeSwap(totalCount);
+	DWORD elapsedTime = timeGetTime() - startTime;
+
+	WaitForMultipleObjects(settings.producerCount, threads, true, INFINITE);
+
+	if (valueSum != expectedSum) return 0;
+	return totalCount * 1000 / (elapsedTime == 0 ? 1 : elapsedTime);
+}
+
+int main(int argc, char *argv[])
+{
+	settings.producerCount = argc > 1 ? atoi(argv[1]) : 4;
+	settings.messageCount = argc > 2 ? atoi(argv[2]) : 1000000;
+	settings.roundCount = argc > 3 ? atoi(argv[3]) : 3;
+
+	// 만일 생산자 수와 메시지 개수가 범위를 벗어난다면 범위 안으로 맞춥니다
+	if (settings.producerCount < 1) settings.producerCount = 1;
+	if (settings.producerCount > BENCH_PRODUCER_MAX) settings.producerCount = BENCH_PRODUCER_MAX;
+	if (settings.messageCount < 1) settings.messageCount = 1;
+	if (settings.roundCount < 1) settings.roundCount = 1;
+
+	// 노드 값은 전체에서 0부터 차례로 매겨, 소비자가 꺼낸 합으로 빠짐과 중복을 확인합니다
+	BenchNode *nodes = new BenchNode[static_cast<size_t>(settings.producerCount) * settings.messageCount];
+	for (INT32 i = 0; i < settings.producerCount; i++)
+	{
+		producers[i].nodes = nodes + static_cast<size_t>(i) * settings.messageCount;
+		for (INT32 j = 0; j < settings.messageCount; j++)
+		{
+			producers[i].nodes[j].value = static_cast<DWORD64>(i) * settings.messageCount + j;
+		}
+	}
+
+	// 두 큐 모두 라운드가 끝나면 비어있으므로 다음 라운드에 그대로 다시 씁니다
+	BOOL isFailed = false;
+	for (INT32 round = 0; round < settings.roundCount; round++)
+	{
+		DWORD64 mpscRate = RunRound(true);
+		DWORD64 swapRate = RunRound(false);
+
+		if (mpscRate == 0 || swapRate == 0) isFailed = true;
+		wcout << L"round " << round << L" / producers : " << settings.producerCount;
+		wcout << L" / mpsc messages per second : " << mpscRate;
+		wcout << L" / swap queue messages per second : " << swapRate << endl;
+	}
+
+	delete[] nodes;
+	return isFailed ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+﻿// 메시지 스키마(PACKET_DEFINE) 벤치마크
+// 먼저 링버퍼에 예약한 구간이 버퍼 끝에서 끊기는 모든 위치에서 SerializeTo(Reservation &)가 연속 메모리에 직렬화한 결과와 같은지 확인합니다
+// 이후 필드 5개, 20개 메시지를 직렬화 버퍼에 쓰고 다시 읽는 데 걸리는 시간을 스키마 구조체와 >>, << 연산자 체인으로 각각 측정합니다
+//
+// 사용법 : PacketSchemaBench [iterations]
+// 빌드 (Linux) : g++ -std=c++14 -O2 -pthread -I../IOCPCore PacketSchemaBench.cpp ../IOCPCore/SerializedBuffer.cpp ../IOCPCore/RingBuffer.cpp ../IOCPCore/Checksum.cpp -o PacketSchemaBench
+// 빌드 (Windows) : cl /O2 /EHsc /I..\IOCPCore PacketSchemaBench.cpp ..\IOCPCore\SerializedBuffer.cpp ..\IOCPCore\RingBuffer.cpp ..\IOCPCore\Checksum.cpp
+
+#include "Core.h"
+#include "PacketSchema.h"
+
+using namespace azely;
+
+#define BENCH_RING_BUFFER_SIZE 512
+
+enum BenchMessageType
+{
+	MESSAGE_MOVE = 1,
+	MESSAGE_CHAT = 2,
+	MESSAGE_STAT = 3
+};
+
+#define PACKET_MOVE(FIELD, ARRAY)	FIELD(DWORD64, characterID) FIELD(FLOAT, x) FIELD(FLOAT, y) FIELD(FLOAT, z) FIELD(UCHAR, direction)
+#define PACKET_CHAT(FIELD, ARRAY)	FIELD(UINT32, roomID) FIELD(DWORD64, senderID) ARRAY(WCHAR, text, 128)
+#define PACKET_STAT(FIELD, ARRAY)	FIELD(DWORD64, stat0) FIELD(UINT32, stat1) FIELD(UINT32, stat2) FIELD(USHORT, stat3) FIELD(USHORT, stat4) \
+	FIELD(INT32, stat5) FIELD(INT32, stat6) FIELD(FLOAT, stat7) FIELD(FLOAT, stat8) FIELD(DOUBLE, stat9) \
+	FIELD(UCHAR, stat10) FIELD(UCHAR, stat11) FIELD(INT64, stat12) FIELD(UINT32, stat13) FIELD(UINT32, stat14) \
+	FIELD(SHORT, stat15) FIELD(SHORT, stat16) FIELD(FLOAT, stat17) FIELD(DWORD64, stat18) FIELD(INT32, stat19)
+
+#pragma pack(push, 1)
+PACKET_DEFINE(MoveMessage, MESSAGE_MOVE, PACKET_MOVE)
+PACKET_DEFINE(ChatMessage, MESSAGE_CHAT, PACKET_CHAT)
+PACKET_DEFINE(StatMessage, MESSAGE_STAT, PACKET_STAT)
+#pragma pack(pop)
+
+static RingBuffer		ringBuffer(BENCH_RING_BUFFER_SIZE);
+static volatile DWORD64	resultSink = 0;
+
+/**
+ * \brief 링버퍼의 시작 위치를 하나씩 옮겨가며, 예약 구간에 직렬화한 결과가 연속 메모리에 직렬화한 결과와 같은지 확인합니다
+ * \return 모든 위치에서 같다면 true
+ */
+static BOOL VerifyReservation()
+{
+	ChatMessage chatMessage;
+	chatMessage.roomID = 7;
+	chatMessage.senderID = 0x0123456789abcdef;
+	chatMessage.textCount = 100;
+	for (INT32 i = 0; i < chatMessage.textCount; i++)
+	{
+		chatMessage.text[i] = static_cast<WCHAR>(L'a' + i % 26);
+	}
+
+	UCHAR expected[sizeof(ChatMessage) + sizeof(USHORT)];
+	UCHAR actual[sizeof(ChatMessage) + sizeof(USHORT)];
+	INT32 serializedSize = chatMessage.SerializeTo(expected);
+	INT32 splitCount = 0;
+
+	for (INT32 start = 0; start < BENCH_RING_BUFFER_SIZE; start++)
+	{
+		// 읽기, 쓰기 포인터를 start 위치로 옮깁니다
+		ringBuffer.Clear();
+		ringBuffer.MoveWriteBuffer(start);
+		ringBuffer.MoveReadBuffer(start);
+
+		RingBuffer::Reservation reservation;
+		if (!ringBuffer.Reserve(serializedSize, &reservation)) return false;
+		if (reservation.secondSize > 0) splitCount++;
+		if (chatMessage.SerializeTo(reservation) != serializedSize) return false;
+		if (!ringBuffer.Commit(serializedSize)) return false;
+
+		INT32 dequeuedSize = 0;
+		if (!ringBuffer.Dequeue(reinterpret_cast<PCHAR>(actual), serializedSize, &dequeuedSize, false)) return false;
+		if (memcmp(expected, actual, serializedSize) != 0) return false;
+	}
+
+	wcout << L"reservation serialize matched at " << BENCH_RING_BUFFER_SIZE << L" start positions (" << splitCount << L" split)" << endl;
+	return splitCount > 0;
+}
+
+/**
+ * \brief 경과 시간을 메시지 하나당 나노초로 바꿉니다
+ */
+static double ToNanoseconds(DWORD elapsedTime, INT32 iterationCount)
+{
+	return static_cast<double>(elapsedTime) * 1000000.0 / iterationCount;
+}
+
+int main(int argc, char *argv[])
+{
+	INT32 iterationCount = argc > 1 ? atoi(argv[1]) : 10000000;
+
+	// 만일 반복 횟수가 범위를 벗어난다면 범위 안으로 맞춥니다
+	if (iterationCount < 1) iterationCount = 1;
+
+	if (!VerifyReservation())
+	{
+		wcout << L"reservation serialize mismatch" << endl;
+		return 1;
+	}
+
+	SerializedBuffer buffer(1460);
+	INT32 movedSize = 0;
+	DWORD64 resultSum = 0;
+
+	MoveMessage moveMessage;
+	moveMessage.x = 1.0f;
+	moveMessage.y = 2.0f;
+	moveMessage.z = 3.0f;
+	moveMessage.direction = 4;
+
+	DWORD startTime = timeGetTime();
+	for (INT32 i = 0; i < iterationCount; i++)
+	{
+		buffer.Clear(false);
+		moveMessage.characterID = i;
+		moveMessage.Serialize(buffer);
+		buffer.MoveReadPointer(sizeof(USHORT), &movedSize);
+		MoveMessage readMessage;
+		readMessage.Deserialize(buffer);
+		resultSum += readMessage.characterID;
+	}
+	DWORD moveSchemaTime = timeGetTime() - startTime;
+
+	startTime = timeGetTime();
+	for (INT32 i = 0; i < iterationCount; i++)
+	{
+		buffer.Clear(false);
+		buffer << static_cast<USHORT>(MESSAGE_MOVE) << static_cast<DWORD64>(i) << 1.0f << 2.0f << 3.0f << static_cast<UCHAR>(4);
+		USHORT messageType;
+		DWORD64 characterID;
+		FLOAT x, y, z;
+		UCHAR direction;
+		buffer >> messageType >> characterID >> x >> y >> z >> direction;
+		resultSum += characterID;
+	}
+	DWORD moveOperatorTime = timeGetTime() - startTime;
+
+	StatMessage statMessage;
+	ZeroMemory(static_cast<StatMessageLayout *>(&statMessage), sizeof(StatMessageLayout));
+	statMessage.messageType = MESSAGE_STAT;
+
+	startTime = timeGetTime();
+	for (INT32 i = 0; i < iterationCount; i++)
+	{
+		buffer.Clear(false);
+		statMessage.stat0 = i;
+		statMessage.Serialize(buffer);
+		buffer.MoveReadPointer(sizeof(USHORT), &movedSize);
+		StatMessage readMessage;
+		readMessage.Deserialize(buffer);
+		resultSum += readMessage.stat0;
+	}
+	DWORD statSchemaTime = timeGetTime() - startTime;
+
+	startTime = timeGetTime();
+	for (INT32 i = 0; i < iterationCount; i++)
+	{
+		buffer.Clear(false);
+		buffer << static_cast<USHORT>(MESSAGE_STAT) << static_cast<DWORD64>(i) << 1u << 2u << static_cast<USHORT>(3) << static_cast<USHORT>(4)
+			<< 5 << 6 << 7.0f << 8.0f << 9.0 << static_cast<UCHAR>(10) << static_cast<UCHAR>(11) << static_cast<INT64>(12) << 13u << 14u
+			<< static_cast<SHORT>(15) << static_cast<SHORT>(16) << 17.0f << static_cast<DWORD64>(18) << 19;
+		USHORT messageType;
+		DWORD64 stat0, stat18;
+		UINT32 stat1, stat2, stat13, stat14;
+		USHORT stat3, stat4;
+		INT32 stat5, stat6, stat19;
+		FLOAT stat7, stat8, stat17;
+		DOUBLE stat9;
+		UCHAR stat10, stat11;
+		INT64 stat12;
+		SHORT stat15, stat16;
+		buffer >> messageType >> stat0 >> stat1 >> stat2 >> stat3 >> stat4 >> stat5 >> stat6 >> stat7 >> stat8 >> stat9
+			>> stat10 >> stat11 >> stat12 >> stat13 >> stat14 >> stat15 >> stat16 >> stat17 >> stat18 >> stat19;
+		resultSum += stat0;
+	}
+	DWORD statOperatorTime = timeGetTime() - startTime;
+	resultSink = resultSum;
+
+	wcout << L"5 fields / schema ns : " << ToNanoseconds(moveSchemaTime, iterationCount) << L" / operators ns : " << ToNanoseconds(moveOperatorTime, iterationCount) << endl;
+	wcout << L"20 fields / schema ns : " << ToNanoseconds(statSchemaTime, iterationCount) << L" / operators ns : " << ToNanoseconds(statOperatorTime, iterationCount) << endl;
+	return 0;
+}
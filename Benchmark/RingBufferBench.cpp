@@ -0,0 +1,168 @@
+﻿// 링버퍼 Produce 경합 벤치마크
+// 여러 생산자 스레드가 한 링버퍼에 Produce로 고정 크기 레코드를 넣고 한 소비자 스레드가 LoadReadable, Consume으로 꺼낼 때의
+// 초당 레코드 개수를 동기화 모드(SYNC_LOCK, SYNC_MPSC, 생산자가 하나일 때는 SYNC_SPSC 포함)별로 측정합니다
+// 소비자는 생산자마다 레코드 순서를 확인하여, 빠지거나 섞인 레코드가 있다면 실패로 처리합니다
+//
+// 사용법 : RingBufferBench [producers] [records per producer] [rounds]
+// 빌드 (Linux) : g++ -std=c++14 -O2 -pthread -I../IOCPCore RingBufferBench.cpp ../IOCPCore/RingBuffer.cpp -o RingBufferBench
+// 빌드 (Windows) : cl /O2 /EHsc /I..\IOCPCore RingBufferBench.cpp ..\IOCPCore\RingBuffer.cpp
+
+#include "Core.h"
+#include "RingBuffer.h"
+#include <new>
+
+using namespace azely;
+
+#define BENCH_PRODUCER_MAX 64
+// 레코드 크기의 배수로 잡아, 레코드가 버퍼 끝에서 끊기지 않도록 합니다
+#define BENCH_BUFFER_SIZE 65536
+
+struct BenchRecord
+{
+	DWORD64 producerIndex;
+	DWORD64 sequence;
+};
+
+struct BenchSettings
+{
+	INT32 producerCount;
+	INT32 recordCount;
+	INT32 roundCount;
+};
+
+struct alignas(64) ProducerContext
+{
+	INT32 producerIndex;
+	volatile DWORD64 fullCount;
+};
+
+static BenchSettings		settings;
+static ProducerContext		producers[BENCH_PRODUCER_MAX];
+static volatile LONG		isStarted = false;
+static RingBuffer			*ringBuffer = nullptr;
+
+static UINT WINAPI ProducerThread(PVOID param)
+{
+	ProducerContext *context = static_cast<ProducerContext *>(param);
+	while (!isStarted)
+	{
+		SwitchToThread();
+	}
+
+	BenchRecord record;
+	record.producerIndex = context->producerIndex;
+	for (INT32 i = 0; i < settings.recordCount; i++)
+	{
+		record.sequence = i;
+
+		// 만일 버퍼가 가득 찼다면 소비자에게 양보한 뒤 다시 넣습니다
+		while (!ringBuffer->Produce(reinterpret_cast<const char *>(&record), sizeof(record)))
+		{
+			context->fullCount++;
+			SwitchToThread();
+		}
+	}
+	return 0;
+}
+
+/**
+ * \brief 구간 안의 레코드들이 생산자마다 순서대로 들어왔는지 확인합니다
+ * \return 순서가 맞다면 true
+ */
+static BOOL CheckRecords(PCHAR data, INT32 size, DWORD64 *nextSequences)
+{
+	for (INT32 offset = 0; offset < size; offset += sizeof(BenchRecord))
+	{
+		BenchRecord *record = reinterpret_cast<BenchRecord *>(data + offset);
+		if (record->producerIndex >= static_cast<DWORD64>(settings.producerCount)) return false;
+		if (record->sequence != nextSequences[record->producerIndex]) return false;
+		nextSequences[record->producerIndex]++;
+	}
+	return true;
+}
+
+/**
+ * \brief 생산자 스레드를 띄우고, 호출한 스레드가 소비자가 되어 한 라운드를 잽니다
+ * \return 초당 레코드 개수, 레코드가 빠지거나 순서가 어긋났다면 0
+ */
+static DWORD64 RunRound(RingBuffer::SyncMode syncMode, INT32 producerCount)
+{
+	DWORD64 totalSize = static_cast<DWORD64>(producerCount) * settings.recordCount * sizeof(BenchRecord);
+	DWORD64 consumeTotalSize = 0;
+	DWORD64 nextSequences[BENCH_PRODUCER_MAX] = { 0 };
+	BOOL isOrdered = true;
+
+	// 링버퍼는 alignas(64) 멤버를 가지므로 캐시라인 정렬된 메모리에 생성합니다
+	ringBuffer = new (_aligned_malloc(sizeof(RingBuffer), alignof(RingBuffer))) RingBuffer(BENCH_BUFFER_SIZE, false, syncMode);
+	isStarted = false;
+	HANDLE threads[BENCH_PRODUCER_MAX];
+	for (INT32 i = 0; i < producerCount; i++)
+	{
+		producers[i].producerIndex = i;
+		producers[i].fullCount = 0;
+		threads[i] = (HANDLE)_beginthreadex(nullptr, 0, ProducerThread, &producers[i], 0, nullptr);
+	}
+
+	DWORD startTime = timeGetTime();
+	InterlockedExchange(&isStarted, true);
+	while (consumeTotalSize < totalSize)
+	{
+		RingBuffer::Reservation readable;
+		INT32 readableSize = ringBuffer->LoadReadable(&readable);
+		if (readableSize == 0)
+		{
+			SwitchToThread();
+			continue;
+		}
+
+		if (!CheckRecords(readable.first, readable.firstSize, nextSequences)) isOrdered = false;
+		if (!CheckRecords(readable.second, readable.secondSize, nextSequences)) isOrdered = false;
+		ringBuffer->Consume(readableSize);
+		consumeTotalSize += readableSize;
+	}
+	DWORD elapsedTime = timeGetTime() - startTime;
+
+	WaitForMultipleObjects(producerCount, threads, true, INFINITE);
+	ringBuffer->~RingBuffer();
+	_aligned_free(ringBuffer);
+	ringBuffer = nullptr;
+
+	if (!isOrdered || consumeTotalSize != totalSize) return 0;
+	return static_cast<DWORD64>(producerCount) * settings.recordCount * 1000 / (elapsedTime == 0 ? 1 : elapsedTime);
+}
+
+int main(int argc, char *argv[])
+{
+	settings.producerCount = argc > 1 ? atoi(argv[1]) : 4;
+	settings.recordCount = argc > 2 ? atoi(argv[2]) : 1000000;
+	settings.roundCount = argc > 3 ? atoi(argv[3]) : 3;
+
+	// 만일 생산자 수와 레코드 개수가 범위를 벗어난다면 범위 안으로 맞춥니다
+	if (settings.producerCount < 1) settings.producerCount = 1;
+	if (settings.producerCount > BENCH_PRODUCER_MAX) settings.producerCount = BENCH_PRODUCER_MAX;
+	if (settings.recordCount < 1) settings.recordCount = 1;
+	if (settings.roundCount < 1) settings.roundCount = 1;
+
+	BOOL isFailed = false;
+	for (INT32 round = 0; round < settings.roundCount; round++)
+	{
+		DWORD64 lockRate = RunRound(RingBuffer::SYNC_LOCK, settings.producerCount);
+		DWORD64 mpscRate = RunRound(RingBuffer::SYNC_MPSC, settings.producerCount);
+		if (lockRate == 0 || mpscRate == 0) isFailed = true;
+
+		wcout << L"round " << round << L" / producers : " << settings.producerCount;
+		wcout << L" / lock records per second : " << lockRate;
+		wcout << L" / mpsc records per second : " << mpscRate;
+
+		// SPSC 모드는 생산자가 하나일 때만 쓸 수 있으므로, 같은 레코드 수를 생산자 하나로 잽니다
+		if (settings.producerCount == 1)
+		{
+			DWORD64 spscRate = RunRound(RingBuffer::SYNC_SPSC, 1);
+			if (spscRate == 0) isFailed = true;
+			wcout << L" / spsc records per second : " << spscRate;
+		}
+		wcout << endl;
+	}
+
+	return isFailed ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+﻿// 링버퍼 복사 처리량 벤치마크
+// Enqueue, Dequeue, Peek, Reserve(예약한 구간에 직접 쓴 뒤 Commit)의 초당 처리량(GB/s)을 8B ~ 64KB 크기별로 측정합니다
+// 크기마다 구간이 버퍼 끝에서 끊기지 않는 경우(no wrap)와 버퍼 끝에서 반으로 끊기는 경우(wrap)를 나누어 잽니다
+// 측정 전에 크기와 경우마다 꺼낸 데이터가 넣은 데이터와 같은지 확인하여, 다르다면 실패로 처리합니다
+//
+// 사용법 : RingBufferCopyBench [megabytes per case]
+// 빌드 (Linux) : g++ -std=c++14 -O2 -pthread -I../IOCPCore RingBufferCopyBench.cpp ../IOCPCore/RingBuffer.cpp -o RingBufferCopyBench
+// 빌드 (Windows) : cl /O2 /EHsc /I..\IOCPCore RingBufferCopyBench.cpp ..\IOCPCore\RingBuffer.cpp
+
+#include "Core.h"
+#include "RingBuffer.h"
+#include <new>
+
+using namespace azely;
+
+// 64KB 구간이 버퍼 끝에서 끊기더라도 들어갈 수 있도록 두 배로 잡습니다
+#define BENCH_BUFFER_SIZE 131072
+#define BENCH_SIZE_MAX 65536
+
+typedef BOOL(*CopyCase)(INT32 size, BOOL isWrapped);
+
+static RingBuffer	*ringBuffer = nullptr;
+static char			source[BENCH_SIZE_MAX];
+static char			destination[BENCH_SIZE_MAX];
+
+/**
+ * \brief 링버퍼를 비우고, wrap이라면 size 구간이 버퍼 끝에서 반으로 끊기도록 읽기, 쓰기 포인터를 옮겨둡니다
+ */
+static VOID Position(INT32 size, BOOL isWrapped)
+{
+	ringBuffer->Clear();
+	if (!isWrapped) return;
+	INT32 offset = static_cast<INT32>(ringBuffer->GetBufferEnd() - ringBuffer->GetBufferBegin()) - size / 2;
+	ringBuffer->MoveWriteBuffer(offset);
+	ringBuffer->MoveReadBuffer(offset);
+}
+
+static BOOL EnqueueCase(INT32 size, BOOL isWrapped)
+{
+	int enqueueSize = 0;
+	Position(size, isWrapped);
+	return ringBuffer->Enqueue(source, size, &enqueueSize);
+}
+
+static BOOL DequeueCase(INT32 size, BOOL isWrapped)
+{
+	int dequeueSize = 0;
+	Position(size, isWrapped);
+	ringBuffer->MoveWriteBuffer(size);
+	return ringBuffer->Dequeue(destination, size, &dequeueSize);
+}
+
+static BOOL PeekCase(INT32 size, BOOL isWrapped)
+{
+	// Peek은 포인터를 옮기지 않으므로, Measure에서 한 번 채워둔 구간을 반복해서 읽습니다
+	int peekSize = 0;
+	(void)isWrapped;
+	return ringBuffer->Peek(destination, size, &peekSize, false);
+}
+
+static BOOL ReserveCase(INT32 size, BOOL isWrapped)
+{
+	RingBuffer::Reservation reservation;
+	Position(size, isWrapped);
+	if (!ringBuffer->Reserve(size, &reservation)) return false;
+	memcpy(reservation.first, source, reservation.firstSize);
+	if (reservation.secondSize > 0) memcpy(reservation.second, source + reservation.firstSize, reservation.secondSize);
+	return ringBuffer->Commit(size);
+}
+
+/**
+ * \brief 각 경우로 넣은 데이터를 Peek, Dequeue로 꺼내 넣은 데이터와 같은지 확인합니다
+ * \return 모두 같다면 true
+ */
+static BOOL Verify(INT32 size, BOOL isWrapped)
+{
+	int copiedSize = 0;
+
+	Position(size, isWrapped);
+	if (!ringBuffer->Enqueue(source, size, &copiedSize) || copiedSize != size) return false;
+	memset(destination, 0, size);
+	if (!ringBuffer->Peek(destination, size, &copiedSize, false) || memcmp(source, destination, size) != 0) return false;
+	memset(destination, 0, size);
+	if (!ringBuffer->Dequeue(destination, size, &copiedSize) || memcmp(source, destination, size) != 0) return false;
+	if (ringBuffer->GetSizeUsed() != 0) return false;
+
+	memset(destination, 0, size);
+	if (!ReserveCase(size, isWrapped) || ringBuffer->GetSizeUsed() != size) return false;
+	if (!ringBuffer->Dequeue(destination, size, &copiedSize) || memcmp(source, destination, size) != 0) return false;
+	return true;
+}
+
+/**
+ * \brief 같은 크기의 경우를 totalSize 바이트만큼 반복하여 처리량을 잽니다
+ * \return GB/s, 실패한 호출이 있었다면 0
+ */
+static double Measure(CopyCase copyCase, INT32 size, BOOL isWrapped, DWORD64 totalSize)
+{
+	DWORD64 repeatCount = totalSize / size;
+	if (repeatCount == 0) repeatCount = 1;
+
+	// Peek은 미리 구간을 채워둡니다
+	Position(size, isWrapped);
+	ringBuffer->MoveWriteBuffer(size);
+
+	BOOL isSucceeded = true;
+	DWORD startTime = timeGetTime();
+	for (DWORD64 i = 0; i < repeatCount; i++)
+	{
+		if (!copyCase(size, isWrapped)) isSucceeded = false;
+	}
+	DWORD elapsedTime = timeGetTime() - startTime;
+
+	if (!isSucceeded) return 0;
+	return static_cast<double>(repeatCount * size) / (elapsedTime == 0 ? 1 : elapsedTime) / 1000000.0;
+}
+
+int main(int argc, char *argv[])
+{
+	INT32 megabytes = argc > 1 ? atoi(argv[1]) : 1024;
+
+	// 만일 측정 크기가 범위를 벗어난다면 범위 안으로 맞춥니다
+	if (megabytes < 1) megabytes = 1;
+	if (megabytes > 65536) megabytes = 65536;
+
+	srand(12345);
+	for (INT32 i = 0; i < BENCH_SIZE_MAX; i++)
+	{
+		source[i] = static_cast<char>(rand());
+	}
+
+	// 링버퍼는 alignas(64) 멤버를 가지므로 캐시라인 정렬된 메모리에 생성합니다
+	ringBuffer = new (_aligned_malloc(sizeof(RingBuffer), alignof(RingBuffer))) RingBuffer(BENCH_BUFFER_SIZE);
+
+	const INT32 sizes[] = { 8, 64, 512, 4096, 16384, 65536 };
+	DWORD64 totalSize = static_cast<DWORD64>(megabytes) * 1024 * 1024;
+	BOOL isFailed = false;
+	for (INT32 size : sizes)
+	{
+		for (INT32 wrapCase = 0; wrapCase < 2; wrapCase++)
+		{
+			BOOL isWrapped = wrapCase == 1;
+			if (!Verify(size, isWrapped))
+			{
+				wcout << L"size " << size << (isWrapped ? L" / wrap" : L" / no wrap") << L" / data mismatch" << endl;
+				isFailed = true;
+				continue;
+			}
+
+			double enqueueRate = Measure(EnqueueCase, size, isWrapped, totalSize);
+			double dequeueRate = Measure(DequeueCase, size, isWrapped, totalSize);
+			double peekRate = Measure(PeekCase, size, isWrapped, totalSize);
+			double reserveRate = Measure(ReserveCase, size, isWrapped, totalSize);
+			if (enqueueRate == 0 || dequeueRate == 0 || peekRate == 0 || reserveRate == 0) isFailed = true;
+
+			wcout << L"size " << size << (isWrapped ? L" / wrap" : L" / no wrap");
+			wcout << L" / enqueue GB/s : " << enqueueRate;
+			wcout << L" / dequeue GB/s : " << dequeueRate;
+			wcout << L" / peek GB/s : " << peekRate;
+			wcout << L" / reserve GB/s : " << reserveRate << endl;
+		}
+	}
+
+	ringBuffer->~RingBuffer();
+	_aligned_free(ringBuffer);
+	return isFailed ? 1 : 0;
+}
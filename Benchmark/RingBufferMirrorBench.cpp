@@ -0,0 +1,248 @@
+﻿// 미러 모드 링버퍼와 일반 링버퍼 비교 벤치마크
+// 수신 경로처럼 링버퍼의 쓰기 구간(일반 모드는 버퍼 끝에서 끊기면 두 구간)에 chunk 크기씩 받아 넣고, 받은 데이터에서 메시지를 링버퍼 안에서 바로 해석합니다
+// 해석은 RecvProc과 같이 DecodeNetworkFrames로 끊기지 않은 구간을 한 번에 훑고, 버퍼 끝에서 끊긴 메시지는 Peek으로 복사하여 해석합니다
+// 메시지 크기별로 초당 메시지 개수와 끊겨서 복사한 메시지 개수, 그리고 같은 chunk 크기로 Enqueue, Dequeue를 반복한 처리량(GB/s)을 두 모드로 측정합니다
+// 해석한 메시지의 순번이 보낸 순서와 다르다면 실패로 처리합니다
+//
+// 사용법 : RingBufferMirrorBench [chunk size] [megabytes per case]
+// 빌드 (Linux) : g++ -std=c++14 -O2 -pthread -I../IOCPCore RingBufferMirrorBench.cpp ../IOCPCore/RingBuffer.cpp ../IOCPCore/Checksum.cpp -o RingBufferMirrorBench
+// 빌드 (Windows) : cl /O2 /EHsc /I..\IOCPCore RingBufferMirrorBench.cpp ..\IOCPCore\RingBuffer.cpp ..\IOCPCore\Checksum.cpp
+
+#include "Core.h"
+#include "RingBuffer.h"
+#include "NetworkHeader.h"
+#include <new>
+
+using namespace azely;
+
+// 두 모드의 크기를 같게 맞추도록 페이지 크기의 배수로 잡습니다
+#define BENCH_BUFFER_SIZE 16384
+#define BENCH_STREAM_SIZE (1024 * 1024)
+#define BENCH_PAYLOAD_MAX 4096
+#define BENCH_FRAME_BATCH_MAX 64
+
+struct BenchSettings
+{
+	INT32 chunkSize;
+	INT32 megabytes;
+};
+
+struct ParseResult
+{
+	DWORD64 framePerSecond;
+	DWORD64 wrappedCount;
+};
+
+static BenchSettings	settings;
+static UCHAR			*stream = nullptr;
+static INT32			streamSize = 0;
+static INT32			streamFrameCount = 0;
+static INT32			streamOffset = 0;
+
+/**
+ * \brief 순번을 페이로드 앞에 담은 payloadSize 크기의 메시지들을 이어 붙여, 끝에서 처음으로 이어 보낼 수 있는 스트림을 만듭니다
+ */
+static VOID BuildStream(INT32 payloadSize)
+{
+	UCHAR payload[BENCH_PAYLOAD_MAX];
+	for (INT32 i = 0; i < payloadSize; i++)
+	{
+		payload[i] = static_cast<UCHAR>(i);
+	}
+
+	streamSize = 0;
+	streamFrameCount = 0;
+	streamOffset = 0;
+	while (streamSize + NETWORK_HEADER_SIZE_MAX + payloadSize <= BENCH_STREAM_SIZE)
+	{
+		UINT32 sequence = static_cast<UINT32>(streamFrameCount);
+		memcpy(payload, &sequence, sizeof(sequence));
+
+		NetworkHeader header;
+		header.secureCode = NETWORK_SECURE_CODE;
+		header.length = payloadSize;
+#ifndef _SIMPLE_HEADER
+		header.checksum = NETWORK_CHECKSUM(payload, payloadSize);
+#endif
+		streamSize += EncodeNetworkHeader(&header, stream + streamSize);
+		memcpy(stream + streamSize, payload, payloadSize);
+		streamSize += payloadSize;
+		streamFrameCount++;
+	}
+}
+
+/**
+ * \brief 스트림에서 이어서 size만큼 복사합니다
+ */
+static VOID ReadStream(PCHAR outData, INT32 size)
+{
+	while (size > 0)
+	{
+		INT32 copySize = streamSize - streamOffset < size ? streamSize - streamOffset : size;
+		memcpy(outData, stream + streamOffset, copySize);
+		outData += copySize;
+		size -= copySize;
+		streamOffset = (streamOffset + copySize) % streamSize;
+	}
+}
+
+/**
+ * \brief 해석한 메시지의 순번이 기대한 순번인지 확인합니다
+ */
+static BOOL CheckFrame(const UCHAR *payload, INT32 length, INT32 payloadSize, UINT32 *nextSequence)
+{
+	UINT32 sequence;
+	memcpy(&sequence, payload, sizeof(sequence));
+	if (length != payloadSize || sequence != *nextSequence) return false;
+	*nextSequence = (*nextSequence + 1) % static_cast<UINT32>(streamFrameCount);
+	return true;
+}
+
+/**
+ * \brief 링버퍼에 chunk 크기씩 받아 넣고 메시지를 해석하기를 totalSize 바이트만큼 반복합니다
+ * \return 초당 메시지 개수(순서가 어긋났다면 0)와 끊겨서 복사한 메시지 개수
+ */
+static ParseResult RunParse(BOOL isMirrored, INT32 payloadSize, DWORD64 totalSize)
+{
+	ParseResult result = { 0, 0 };
+	RingBuffer *ringBuffer = new (_aligned_malloc(sizeof(RingBuffer), alignof(RingBuffer))) RingBuffer(BENCH_BUFFER_SIZE, isMirrored);
+	static UCHAR wrappedFrame[NETWORK_HEADER_SIZE_MAX + BENCH_PAYLOAD_MAX];
+	NetworkFrame frames[BENCH_FRAME_BATCH_MAX];
+	UINT32 nextSequence = 0;
+	DWORD64 frameCount = 0;
+	DWORD64 recvTotalSize = 0;
+	BOOL isOrdered = true;
+	streamOffset = 0;
+
+	DWORD startTime = timeGetTime();
+	while (recvTotalSize < totalSize && isOrdered)
+	{
+		// 수신 링버퍼의 WriteBuffer와 BeginBuffer 두 구간으로 받습니다 (미러 모드라면 첫 구간에 모두 들어갑니다)
+		INT32 recvSize = ringBuffer->GetSizeFree() < settings.chunkSize ? ringBuffer->GetSizeFree() : settings.chunkSize;
+		INT32 directSize = ringBuffer->GetSizeDirectEnqueueAble() < recvSize ? ringBuffer->GetSizeDirectEnqueueAble() : recvSize;
+		ReadStream(ringBuffer->GetWriteBuffer(), directSize);
+		if (recvSize > directSize) ReadStream(ringBuffer->GetBufferBegin(), recvSize - directSize);
+		ringBuffer->MoveWriteBuffer(recvSize);
+		recvTotalSize += recvSize;
+
+		while (isOrdered)
+		{
+			// 끊기지 않은 구간에서 완성된 메시지들을 한 번에 찾아 링버퍼 안에서 바로 확인합니다
+			INT32 scannedSize = 0;
+			const UCHAR *scanBuffer = reinterpret_cast<const UCHAR *>(ringBuffer->GetReadBuffer());
+			INT32 scannedCount = DecodeNetworkFrames(scanBuffer, ringBuffer->GetSizeDirectDequeueAble(), BENCH_PAYLOAD_MAX, frames, BENCH_FRAME_BATCH_MAX, &scannedSize);
+			if (scannedCount > 0)
+			{
+				for (INT32 i = 0; i < scannedCount; i++)
+				{
+					if (!CheckFrame(scanBuffer + frames[i].offset, frames[i].length, payloadSize, &nextSequence)) isOrdered = false;
+				}
+				frameCount += scannedCount;
+				ringBuffer->MoveReadBuffer(scannedSize);
+				continue;
+			}
+
+			// 찾지 못했다면 다 오지 않은 메시지이거나 버퍼 끝에서 끊긴 메시지이므로, 끊긴 메시지라면 복사하여 확인합니다
+			INT32 usedSize = ringBuffer->GetSizeUsed();
+			INT32 peekSize = usedSize < NETWORK_HEADER_SIZE_MAX ? usedSize : NETWORK_HEADER_SIZE_MAX;
+			int peekedSize = 0;
+			NetworkHeader header;
+			if (peekSize < NETWORK_HEADER_SIZE_MIN || !ringBuffer->Peek(reinterpret_cast<PCHAR>(wrappedFrame), peekSize, &peekedSize, false)) break;
+			INT32 headerSize = DecodeNetworkHeader(wrappedFrame, peekedSize, &header);
+			if (headerSize <= 0) break;
+			INT32 frameSize = headerSize + static_cast<INT32>(header.length);
+			if (usedSize < frameSize || !ringBuffer->Peek(reinterpret_cast<PCHAR>(wrappedFrame), frameSize, &peekedSize, false)) break;
+
+			if (!CheckFrame(wrappedFrame + headerSize, header.length, payloadSize, &nextSequence)) isOrdered = false;
+			frameCount++;
+			result.wrappedCount++;
+			ringBuffer->MoveReadBuffer(frameSize);
+		}
+	}
+	DWORD elapsedTime = timeGetTime() - startTime;
+
+	ringBuffer->~RingBuffer();
+	_aligned_free(ringBuffer);
+
+	if (isOrdered) result.framePerSecond = frameCount * 1000 / (elapsedTime == 0 ? 1 : elapsedTime);
+	return result;
+}
+
+/**
+ * \brief chunk 크기씩 Enqueue와 Dequeue를 totalSize 바이트만큼 반복하여 처리량을 잽니다
+ * \return GB/s, 꺼낸 데이터가 넣은 데이터와 다르다면 0
+ */
+static double RunCopy(BOOL isMirrored, DWORD64 totalSize)
+{
+	RingBuffer *ringBuffer = new (_aligned_malloc(sizeof(RingBuffer), alignof(RingBuffer))) RingBuffer(BENCH_BUFFER_SIZE, isMirrored);
+	char *source = new char[settings.chunkSize];
+	char *destination = new char[settings.chunkSize];
+	memcpy(source, stream, settings.chunkSize);
+	BOOL isSucceeded = true;
+
+	DWORD64 repeatCount = totalSize / settings.chunkSize;
+	DWORD startTime = timeGetTime();
+	for (DWORD64 i = 0; i < repeatCount; i++)
+	{
+		int copiedSize = 0;
+		if (!ringBuffer->Enqueue(source, settings.chunkSize, &copiedSize)) isSucceeded = false;
+		if (!ringBuffer->Dequeue(destination, settings.chunkSize, &copiedSize)) isSucceeded = false;
+	}
+	DWORD elapsedTime = timeGetTime() - startTime;
+	if (memcmp(source, destination, settings.chunkSize) != 0) isSucceeded = false;
+
+	delete[] source;
+	delete[] destination;
+	ringBuffer->~RingBuffer();
+	_aligned_free(ringBuffer);
+
+	if (!isSucceeded) return 0;
+	return static_cast<double>(repeatCount * settings.chunkSize) / (elapsedTime == 0 ? 1 : elapsedTime) / 1000000.0;
+}
+
+int main(int argc, char *argv[])
+{
+	settings.chunkSize = argc > 1 ? atoi(argv[1]) : 1460;
+	settings.megabytes = argc > 2 ? atoi(argv[2]) : 1024;
+
+	// 만일 chunk 크기와 측정 크기가 범위를 벗어난다면 범위 안으로 맞춥니다
+	if (settings.chunkSize < 1) settings.chunkSize = 1;
+	if (settings.chunkSize > BENCH_BUFFER_SIZE / 2) settings.chunkSize = BENCH_BUFFER_SIZE / 2;
+	if (settings.megabytes < 1) settings.megabytes = 1;
+
+	// 미러 모드로 만들 수 없는 환경이라면 비교할 수 없으므로 실패로 처리합니다
+	RingBuffer *mirrorCheck = new (_aligned_malloc(sizeof(RingBuffer), alignof(RingBuffer))) RingBuffer(BENCH_BUFFER_SIZE, true);
+	BOOL isMirrorAvailable = mirrorCheck->IsMirrored() && mirrorCheck->GetSizeTotal() == BENCH_BUFFER_SIZE - 1;
+	mirrorCheck->~RingBuffer();
+	_aligned_free(mirrorCheck);
+	if (!isMirrorAvailable)
+	{
+		wcout << L"mirrored ring buffer of " << BENCH_BUFFER_SIZE << L" bytes is not available" << endl;
+		return 1;
+	}
+
+	stream = new UCHAR[BENCH_STREAM_SIZE];
+	DWORD64 totalSize = static_cast<DWORD64>(settings.megabytes) * 1024 * 1024;
+	BOOL isFailed = false;
+
+	const INT32 payloadSizes[] = { 8, 64, 512, 1400, 4096 };
+	for (INT32 payloadSize : payloadSizes)
+	{
+		BuildStream(payloadSize);
+		ParseResult plainResult = RunParse(false, payloadSize, totalSize);
+		ParseResult mirroredResult = RunParse(true, payloadSize, totalSize);
+		if (plainResult.framePerSecond == 0 || mirroredResult.framePerSecond == 0) isFailed = true;
+
+		wcout << L"payload " << payloadSize << L" / chunk " << settings.chunkSize;
+		wcout << L" / plain frames per second : " << plainResult.framePerSecond << L" (wrapped copies " << plainResult.wrappedCount << L")";
+		wcout << L" / mirrored frames per second : " << mirroredResult.framePerSecond << L" (wrapped copies " << mirroredResult.wrappedCount << L")" << endl;
+	}
+
+	double plainRate = RunCopy(false, totalSize);
+	double mirroredRate = RunCopy(true, totalSize);
+	if (plainRate == 0 || mirroredRate == 0) isFailed = true;
+	wcout << L"enqueue, dequeue chunk " << settings.chunkSize << L" / plain GB/s : " << plainRate << L" / mirrored GB/s : " << mirroredRate << endl;
+
+	delete[] stream;
+	return isFailed ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+﻿// 세션 암호화 처리량 벤치마크
+// 먼저 알고리즘마다 Seal로 암호화한 메시지를 상대편 키의 Open으로 복호화하여 원문이 되돌아오는지, 변조한 메시지는 인증에 실패하는지 확인합니다
+// 이후 메시지 크기별로 한 스레드(코어 하나)에서 Seal의 처리량과, Seal 후 Open까지 한 왕복에서 Seal 시간을 뺀 Open의 처리량(GB/s)을 측정합니다
+// Windows에서는 CNG(bcrypt), Linux에서는 OpenSSL(libcrypto)이 CPU에 맞게 고른 AES-NI, AVX2 구현의 처리량입니다
+//
+// 사용법 : SessionCipherBench [megabytes per size]
+// 빌드 (Linux) : g++ -std=c++14 -O2 -pthread -I../IOCPCore SessionCipherBench.cpp ../IOCPCore/SessionCipher.cpp -o SessionCipherBench -lcrypto
+// 빌드 (Windows) : cl /O2 /EHsc /I..\IOCPCore SessionCipherBench.cpp ..\IOCPCore\SessionCipher.cpp
+
+#include "Core.h"
+#include "SessionCipher.h"
+
+using namespace azely;
+
+#define BENCH_MESSAGE_SIZE_MAX 16384
+
+struct SuiteInfo
+{
+	SessionCipher::Suite	suite;
+	PCWSTR					name;
+};
+
+static UCHAR	message[BENCH_MESSAGE_SIZE_MAX];
+static UCHAR	original[BENCH_MESSAGE_SIZE_MAX];
+static UCHAR	tag[SessionCipher::TAG_SIZE];
+
+/**
+ * \brief 한쪽의 송신 키와 IV를 다른 쪽의 수신 키와 IV로 하는 키 한 쌍을 만듭니다
+ */
+static VOID MakeKeys(SessionCipher::Suite suite, SessionCipher::Key *outSenderKey, SessionCipher::Key *outReceiverKey)
+{
+	ZeroMemory(outSenderKey, sizeof(SessionCipher::Key));
+	outSenderKey->suite = suite;
+	for (INT32 i = 0; i < SessionCipher::KEY_SIZE_MAX; i++)
+	{
+		outSenderKey->sendKey[i] = static_cast<UCHAR>(i * 7 + 1);
+		outSenderKey->recvKey[i] = static_cast<UCHAR>(i * 13 + 5);
+	}
+	for (INT32 i = 0; i < SessionCipher::IV_SIZE; i++)
+	{
+		outSenderKey->sendIV[i] = static_cast<UCHAR>(i * 3 + 2);
+		outSenderKey->recvIV[i] = static_cast<UCHAR>(i * 5 + 9);
+	}
+
+	outReceiverKey->suite = suite;
+	memcpy(outReceiverKey->sendKey, outSenderKey->recvKey, SessionCipher::KEY_SIZE_MAX);
+	memcpy(outReceiverKey->sendIV, outSenderKey->recvIV, SessionCipher::IV_SIZE);
+	memcpy(outReceiverKey->recvKey, outSenderKey->sendKey, SessionCipher::KEY_SIZE_MAX);
+	memcpy(outReceiverKey->recvIV, outSenderKey->sendIV, SessionCipher::IV_SIZE);
+}
+
+/**
+ * \brief 암호화한 메시지가 원문으로 복호화되는지, 변조한 메시지는 인증에 실패하는지 확인합니다
+ * \return 확인에 성공했다면 true
+ */
+static BOOL Verify(SessionCipher::Suite suite)
+{
+	SessionCipher::Key senderKey;
+	SessionCipher::Key receiverKey;
+	MakeKeys(suite, &senderKey, &receiverKey);
+	SessionCipher sender;
+	SessionCipher receiver;
+	if (!sender.Initialize(&senderKey) || !receiver.Initialize(&receiverKey)) return false;
+
+	const INT32 size = 1000;
+	if (!sender.Seal(original, size, message, tag)) return false;
+	if (memcmp(original, message, size) == 0) return false;
+	if (!receiver.Open(message, size, tag) || memcmp(original, message, size) != 0) return false;
+
+	// 한 바이트를 바꾼 메시지는 인증에 실패해야 합니다
+	if (!sender.Seal(original, size, message, tag)) return false;
+	message[size / 2] ^= 1;
+	return !receiver.Open(message, size, tag);
+}
+
+/**
+ * \brief 같은 크기의 메시지를 totalSize 바이트만큼 제자리에서 암호화(isRoundTrip이라면 이어서 복호화까지)하며 시간을 잽니다
+ * \return 걸린 시간(ms), 실패한 호출이 있었다면 -1
+ */
+static INT64 Measure(SessionCipher::Suite suite, INT32 size, DWORD64 totalSize, BOOL isRoundTrip)
+{
+	SessionCipher::Key senderKey;
+	SessionCipher::Key receiverKey;
+	MakeKeys(suite, &senderKey, &receiverKey);
+	SessionCipher sender;
+	SessionCipher receiver;
+	if (size > BENCH_MESSAGE_SIZE_MAX || !sender.Initialize(&senderKey) || !receiver.Initialize(&receiverKey)) return -1;
+
+	DWORD64 repeatCount = totalSize / size;
+	if (repeatCount == 0) repeatCount = 1;
+	memcpy(message, original, size);
+	BOOL isSucceeded = true;
+
+	DWORD startTime = timeGetTime();
+	for (DWORD64 i = 0; i < repeatCount; i++)
+	{
+		if (!sender.Seal(message, size, message, tag)) isSucceeded = false;
+		if (isRoundTrip && !receiver.Open(message, size, tag)) isSucceeded = false;
+	}
+	DWORD elapsedTime = timeGetTime() - startTime;
+
+	// 왕복했다면 원문으로 되돌아와 있어야 합니다
+	if (isRoundTrip && memcmp(message, original, size) != 0) isSucceeded = false;
+	if (!isSucceeded) return -1;
+	return elapsedTime == 0 ? 1 : elapsedTime;
+}
+
+int main(int argc, char *argv[])
+{
+	INT32 megabytes = argc > 1 ? atoi(argv[1]) : 256;
+
+	// 만일 측정 크기가 범위를 벗어난다면 범위 안으로 맞춥니다
+	if (megabytes < 1) megabytes = 1;
+	if (megabytes > 65536) megabytes = 65536;
+
+	srand(12345);
+	for (INT32 i = 0; i < BENCH_MESSAGE_SIZE_MAX; i++)
+	{
+		original[i] = static_cast<UCHAR>(rand());
+	}
+
+	const SuiteInfo suites[] = {
+		{ SessionCipher::SUITE_AES_128_GCM, L"aes-128-gcm" },
+		{ SessionCipher::SUITE_AES_256_GCM, L"aes-256-gcm" },
+		{ SessionCipher::SUITE_CHACHA20_POLY1305, L"chacha20-poly1305" }
+	};
+	const INT32 sizes[] = { 64, 512, 1460, 16384 };
+	DWORD64 totalSize = static_cast<DWORD64>(megabytes) * 1024 * 1024;
+	BOOL isFailed = false;
+
+	for (const SuiteInfo &suiteInfo : suites)
+	{
+		// 지원하지 않는 환경(_SESSION_CIPHER 없이 빌드, 알고리즘 미지원)이거나 결과가 틀리다면 실패로 처리합니다
+		if (!Verify(suiteInfo.suite))
+		{
+			wcout << suiteInfo.name << L" / verification failed" << endl;
+			isFailed = true;
+			continue;
+		}
+
+		for (INT32 size : sizes)
+		{
+			INT64 sealTime = Measure(suiteInfo.suite, size, totalSize, false);
+			INT64 roundTripTime = Measure(suiteInfo.suite, size, totalSize, true);
+			if (sealTime < 0 || roundTripTime < 0)
+			{
+				wcout << suiteInfo.name << L" / size " << size << L" / seal or open failed" << endl;
+				isFailed = true;
+				continue;
+			}
+
+			INT64 openTime = roundTripTime - sealTime;
+			if (openTime < 1) openTime = 1;
+			DWORD64 measuredSize = totalSize / size * size;
+			wcout << suiteInfo.name << L" / size " << size;
+			wcout << L" / seal GB/s : " << static_cast<double>(measuredSize) / sealTime / 1000000.0;
+			wcout << L" / open GB/s : " << static_cast<double>(measuredSize) / openTime / 1000000.0 << endl;
+		}
+	}
+
+	return isFailed ? 1 : 0;
+}
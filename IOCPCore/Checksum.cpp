@@ -0,0 +1,134 @@
+﻿#include "Checksum.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CHECKSUM_HARDWARE_CRC32C
+#include <nmmintrin.h>
+#ifdef _WIN32
+#include <intrin.h>
+#define CHECKSUM_TARGET_SSE42
+#else
+#define CHECKSUM_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#endif
+
+// CRC32C 다항식 (비트 순서를 뒤집은 0x1EDC6F41)
+#define CHECKSUM_CRC32C_POLYNOMIAL 0x82F63B78
+
+namespace azely
+{
+	namespace Checksum
+	{
+		/**
+		 * \brief slicing-by-8 테이블
+		 * \details table[k][b]는 바이트 b 뒤에 0인 바이트가 k개 이어졌을 때의 CRC 값입니다
+		 */
+		struct CRC32CTables
+		{
+			UINT32 table[8][256];
+
+			CRC32CTables()
+			{
+				for (UINT32 i = 0; i < 256; i++)
+				{
+					UINT32 crc = i;
+					for (int bit = 0; bit < 8; bit++)
+					{
+						crc = (crc >> 1) ^ ((crc & 1) ? CHECKSUM_CRC32C_POLYNOMIAL : 0);
+					}
+					table[0][i] = crc;
+				}
+				for (UINT32 i = 0; i < 256; i++)
+				{
+					for (int k = 1; k < 8; k++)
+					{
+						table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+					}
+				}
+			}
+		};
+
+		static const CRC32CTables crc32cTables;
+
+		UINT32 CRC32CTable(const UCHAR *data, size_t size, UINT32 crc)
+		{
+			const UINT32 (*table)[256] = crc32cTables.table;
+			crc = ~crc;
+
+			// 8바이트씩 한 번에 테이블 8개를 찾아 계산합니다 (리틀 엔디언 기준)
+			while (size >= 8)
+			{
+				UINT32 low;
+				UINT32 high;
+				memcpy(&low, data, sizeof(low));
+				memcpy(&high, data + 4, sizeof(high));
+				low ^= crc;
+				crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+					table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+				data += 8;
+				size -= 8;
+			}
+			while (size > 0)
+			{
+				crc = (crc >> 8) ^ table[0][(crc ^ *data) & 0xFF];
+				data++;
+				size--;
+			}
+
+			return ~crc;
+		}
+
+#ifdef CHECKSUM_HARDWARE_CRC32C
+		CHECKSUM_TARGET_SSE42 static UINT32 CRC32CHardware(const UCHAR *data, size_t size, UINT32 crc)
+		{
+			UINT64 crc64 = ~crc;
+
+			// crc32 명령어로 8바이트씩 계산합니다 (x86은 정렬되지 않은 읽기도 느리지 않으므로 정렬을 맞추지 않습니다)
+			while (size >= 8)
+			{
+				UINT64 value;
+				memcpy(&value, data, sizeof(value));
+				crc64 = _mm_crc32_u64(crc64, value);
+				data += 8;
+				size -= 8;
+			}
+			while (size > 0)
+			{
+				crc64 = _mm_crc32_u8(static_cast<UINT32>(crc64), *data);
+				data++;
+				size--;
+			}
+
+			return ~static_cast<UINT32>(crc64);
+		}
+
+		static BOOL IsSSE42Supported()
+		{
+#ifdef _WIN32
+			int cpuInfo[4];
+			__cpuid(cpuInfo, 1);
+			return (cpuInfo[2] & (1 << 20)) != 0;
+#else
+			return __builtin_cpu_supports("sse4.2") != 0;
+#endif
+		}
+
+		static const BOOL isHardwareCRC32C = IsSSE42Supported();
+#else
+		static const BOOL isHardwareCRC32C = false;
+#endif
+
+		UINT32 CRC32C(const UCHAR *data, size_t size, UINT32 crc)
+		{
+#ifdef CHECKSUM_HARDWARE_CRC32C
+			if (isHardwareCRC32C) return CRC32CHardware(data, size, crc);
+#endif
+			return CRC32CTable(data, size, crc);
+		}
+
+		BOOL IsHardwareCRC32C()
+		{
+			return isHardwareCRC32C;
+		}
+	}
+
+}
@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include "Core.h"
+
+namespace azely
+{
+	/**
+	 * \brief 메시지 무결성 검사용 체크섬
+	 * \details CRC32C(Castagnoli)를 계산합니다 / x86 CPU가 SSE4.2를 지원한다면 crc32 명령어로 8바이트씩, 아니라면 slicing-by-8 테이블로 계산합니다
+	 * 어느 쪽으로 계산할지는 프로세스가 시작될 때 한 번만 확인합니다
+	 */
+	namespace Checksum
+	{
+		/**
+		 * \brief CRC32C를 계산합니다
+		 * \param data 계산할 데이터
+		 * \param size 데이터 크기
+		 * \param crc 나누어 계산하는 경우 앞 부분까지의 CRC32C (처음이라면 0)
+		 * \return CRC32C
+		 */
+		UINT32 CRC32C(const UCHAR *data, size_t size, UINT32 crc = 0);
+
+		/**
+		 * \brief 테이블만 사용하여 CRC32C를 계산합니다
+		 * \details 결과는 CRC32C와 같으며, 하드웨어 계산과 비교 검증할 때 사용합니다
+		 * \param data 계산할 데이터
+		 * \param size 데이터 크기
+		 * \param crc 나누어 계산하는 경우 앞 부분까지의 CRC32C (처음이라면 0)
+		 * \return CRC32C
+		 */
+		UINT32 CRC32CTable(const UCHAR *data, size_t size, UINT32 crc = 0);
+
+		/**
+		 * \brief CRC32C를 crc32 명령어로 계산하는지 여부를 리턴합니다
+		 * \return SSE4.2 crc32 명령어 사용 여부
+		 */
+		BOOL IsHardwareCRC32C();
+	}
+
+}
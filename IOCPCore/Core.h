@@ -1,11 +1,15 @@
 ﻿#pragma once
 
+#ifdef _WIN32
+
 #pragma comment(lib, "ws2_32.lib")
 #pragma comment(lib, "winmm.lib")
 #pragma comment(lib, "DbgHelp.lib")
 #pragma comment(lib, "Pdh.lib")
+#pragma comment(lib, "Synchronization.lib")
 
 #include <WinSock2.h>
+#include <MSWSock.h>
 #include <Windows.h>
 #include <iostream>
 #include <fstream>
@@ -19,6 +23,16 @@
 #include <string>
 #include <conio.h>
 
+#else
+
+#include "CoreLinux.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#endif
+
 #include <unordered_map>
 
-using namespace std;
\ No newline at end of file
+using namespace std;
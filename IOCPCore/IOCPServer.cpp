@@ -1,25 +1,32 @@
 ﻿#include "IOCPServer.h"
 
+#include <new>
+
 #define EXCEPTION(CODE, ...) do {HandleException(__FUNCTIONW__, __LINE__, CODE, ##__VA_ARGS__);} while(0)
 
+// WorkerThread가 한 번의 대기로 꺼내는 최대 완료 통지 개수
+#define COMPLETION_ENTRY_MAX 128
+
 namespace azely
 {
 
 	UINT WINAPI WorkerThreadProc(PVOID param)
 	{
-		IOCPServer *iocpServer = (IOCPServer *)param;
+		IOCPServer *iocpServer = ((IOCPServer::ServerShard *)param)->server;
 		return iocpServer->WorkerThread(param);
 	}
 
-	UINT WINAPI AcceptThreadProc(PVOID param)
+#ifndef _WIN32
+	UINT WINAPI UringWorkerThreadProc(PVOID param)
 	{
-		IOCPServer *iocpServer = (IOCPServer *)param;
-		return iocpServer->AcceptThread(param);
+		IOCPServer *iocpServer = ((IOCPServer::UringRing *)param)->shard->server;
+		return iocpServer->UringWorkerThread(param);
 	}
+#endif
 
 	UINT WINAPI PacketThreadProc(PVOID param)
 	{
-		IOCPServer *iocpServer = (IOCPServer *)param;
+		IOCPServer *iocpServer = ((IOCPServer::LogicThread *)param)->server;
 		return iocpServer->PacketThread(param);
 	}
 
@@ -29,17 +36,26 @@ namespace azely
 		return iocpServer->TimeCheckThread(param);
 	}
 
-	IOCPServer::IOCPServer() : serverStatus(STATUS_INITIAL), handleIOCP(INVALID_HANDLE_VALUE), handleWorkers(nullptr), handleAccept(INVALID_HANDLE_VALUE), handleTimeout(INVALID_HANDLE_VALUE), listenSocket(INVALID_SOCKET), sessionNextID(1000)
+	IOCPServer::IOCPServer() : serverStatus(STATUS_INITIAL), shards(nullptr), logicThreads(nullptr),
+#ifdef _WIN32
+		fnAcceptEx(nullptr), fnGetAcceptExSockaddrs(nullptr), acceptPendingCount(0), acceptShardNext(0),
+#endif
+		handleTimeout(INVALID_HANDLE_VALUE),
+		timeBegin(0), sessionCount(0), recvMessagePerSecondCounter(0), sendMessagePerSecondCounter(0), acceptPerSecondCounter(0), sessionAccepted(0), sessionReleased(0), acceptBatchPerSecondCounter(0)
 	{
 		// SRWLock 초기화
-		InitializeSRWLock(&sessionPoolSRW);
-		InitializeSRWLock(&packetPoolSRW);
-		InitializeSRWLock(&messagePoolSRW);
-		InitializeSRWLock(&sessionMapSRW);
+		InitializeSRWLock(&timerWheelSRW);
+		InitializeSRWLock(&groupTableSRW);
 
 		// 타이머 해상도 상향
 		// timeGetTime 과 타이머 인터럽트에 영향을 줍니다
 		timeBeginPeriod(1);
+
+#ifndef _WIN32
+		// glibc 에서는 stdout 이 먼저 출력한 스트림의 방향(wide, narrow)으로 고정되어 wcout 과 cout 을 섞어 쓰면 한 쪽 출력이 사라지므로,
+		// C stdio 와의 동기화를 끄고 각 스트림이 직접 출력하도록 합니다
+		ios::sync_with_stdio(false);
+#endif
 	}
 
 	IOCPServer::~IOCPServer()
@@ -57,19 +73,40 @@ namespace azely
 			return;
 		}
 
-		// 메시지의 앞 부분 헤더를 만들어 채웁니다
-		serializedBuffer->BuildNetworkHeader();
-		
 		InterlockedIncrement(&sendMessagePerSecondCounter);
 
-		// 세션의 송신 큐를 잠그고 패킷을 삽입합니다
-		session->SendRingBuffer.LockSRWExclusive();
-		INT32 enqueuedSize = 0;
-		BOOL enqueueResult = session->SendRingBuffer.Enqueue((PCHAR)serializedBuffer->GetBufferRead(), serializedBuffer->GetBufferSizeUsed(), &enqueuedSize);
-		session->SendRingBuffer.UnlockSRWExclusive();
-		if (!enqueueResult || enqueuedSize != serializedBuffer->GetBufferSizeUsed())
+		if (session->Cipher.IsEnabled())
+		{
+			// 암호화된 세션이라면 세션 전용 패킷에 암호화하여 보냅니다
+			SendPacketSealed(session, serializedBuffer);
+		} else
 		{
-			EXCEPTION(EXCEPTION_BUFFER_ERROR);
+			// 메시지의 앞 부분 헤더를 만들어 채웁니다
+			serializedBuffer->BuildNetworkHeader();
+
+			if (serverSettings.sendZeroCopy)
+			{
+				// 호출한 쪽의 메시지는 호출이 끝나면 재사용되므로, 패킷 풀의 메시지에 복사하여 송신 큐에 넣습니다
+				SerializedBuffer *packet = AllocPacket(serializedBuffer->GetBufferSizeUsed());
+				packet->Clear(false);
+				if (!packet->PutData(serializedBuffer->GetBufferRead(), serializedBuffer->GetBufferSizeUsed()))
+				{
+					EXCEPTION(EXCEPTION_BUFFER_ERROR);
+					FreePacket(packet);
+				} else
+				{
+					// 할당받은 참조를 송신 큐에 넘깁니다
+					EnqueueSendMessage(session, packet);
+				}
+			} else
+			{
+				// 세션의 송신 큐에 동기화 모드에 맞게 패킷을 삽입합니다
+				BOOL enqueueResult = session->SendRingBuffer.Produce((PCHAR)serializedBuffer->GetBufferRead(), serializedBuffer->GetBufferSizeUsed());
+				if (!enqueueResult)
+				{
+					EXCEPTION(EXCEPTION_BUFFER_ERROR);
+				}
+			}
 		}
 
 		// 세션의 WSASend를 시도합니다
@@ -79,6 +116,190 @@ namespace azely
 		ReturnSession(session);
 	}
 
+	VOID IOCPServer::SendPacketPooled(DWORD64 sessionID, SerializedBuffer *packet)
+	{
+		SendPacketMulti(&sessionID, 1, packet);
+	}
+
+	VOID IOCPServer::SendPacketMulti(const DWORD64 *sessionIDs, INT32 sessionCount, SerializedBuffer *packet)
+	{
+		if (sessionCount <= 0) return;
+
+		// 메시지의 앞 부분 헤더를 처음 보낼 때 한 번만 채웁니다
+		if (!packet->isHeaderBuilt)
+		{
+			packet->BuildNetworkHeader();
+			packet->isHeaderBuilt = true;
+		}
+
+		// 송신 큐에 넣을 참조를 한 번에 올려두고, 넣지 못한 만큼은 마지막에 내립니다
+		// 호출한 쪽이 참조를 가지고 있으므로, 그 사이에 참조 카운트가 0이 되지는 않습니다
+		if (serverSettings.sendZeroCopy) InterlockedExchangeAdd(&packet->refCount, sessionCount);
+
+		INT32 sentCount = 0;
+		INT32 enqueuedCount = 0;
+		for (int i = 0; i < sessionCount; i++)
+		{
+			// 세션을 얻어옵니다
+			Session *session = AcquireSession(sessionIDs[i]);
+			if (session == nullptr)
+			{
+				continue;
+			}
+
+			if (session->Cipher.IsEnabled())
+			{
+				// 암호화된 세션에는 미리 올려둔 참조를 쓰지 않고, 세션 전용 패킷에 암호화하여 보냅니다
+				SendPacketSealed(session, packet);
+			} else if (serverSettings.sendZeroCopy)
+			{
+				// 메시지를 복사하지 않고 미리 올려둔 참조 하나를 세션의 송신 큐에 넘깁니다
+				EnqueueSendMessage(session, packet);
+				enqueuedCount++;
+			} else
+			{
+				// 세션의 송신 큐에 동기화 모드에 맞게 패킷을 삽입합니다
+				BOOL enqueueResult = session->SendRingBuffer.Produce((PCHAR)packet->GetBufferRead(), packet->GetBufferSizeUsed());
+				if (!enqueueResult)
+				{
+					EXCEPTION(EXCEPTION_BUFFER_ERROR);
+				}
+			}
+			sentCount++;
+
+			// 세션의 WSASend를 시도합니다
+			SendPost(session);
+
+			// 세션을 반환합니다
+			ReturnSession(session);
+		}
+
+		if (serverSettings.sendZeroCopy && enqueuedCount < sessionCount) InterlockedExchangeAdd(&packet->refCount, -(sessionCount - enqueuedCount));
+		InterlockedExchangeAdd(&sendMessagePerSecondCounter, sentCount);
+	}
+
+	BOOL IOCPServer::JoinGroup(DWORD64 groupID, DWORD64 sessionID)
+	{
+		// 세션을 얻어와, 그룹에 넣는 동안 세션이 정리되지 않도록 합니다
+		// 넣은 뒤에 세션이 정리되더라도 RemoveSession에서 그룹에서 빠집니다
+		Session *session = AcquireSession(sessionID);
+		if (session == nullptr)
+		{
+			return false;
+		}
+
+		AcquireSRWLockExclusive(&groupTableSRW);
+		BOOL joinResult = groupTable->Join(groupID, sessionID);
+		ReleaseSRWLockExclusive(&groupTableSRW);
+
+		// 세션을 반환합니다
+		ReturnSession(session);
+		return joinResult;
+	}
+
+	BOOL IOCPServer::LeaveGroup(DWORD64 groupID, DWORD64 sessionID)
+	{
+		AcquireSRWLockExclusive(&groupTableSRW);
+		BOOL leaveResult = groupTable->Leave(groupID, sessionID);
+		ReleaseSRWLockExclusive(&groupTableSRW);
+		return leaveResult;
+	}
+
+	VOID IOCPServer::SendPacketGroup(DWORD64 groupID, SerializedBuffer *packet)
+	{
+		// 보내는 도중에 세션이 정리되면 RemoveSession에서 그룹 잠금을 잡으므로, 멤버 배열을 복사한 뒤 잠금을 풀고 보냅니다
+		static thread_local vector<DWORD64> members;
+		AcquireSRWLockShared(&groupTableSRW);
+		INT32 memberCount = 0;
+		const DWORD64 *groupMembers = groupTable->GetMembers(groupID, &memberCount);
+		members.assign(groupMembers, groupMembers + memberCount);
+		ReleaseSRWLockShared(&groupTableSRW);
+
+		SendPacketMulti(members.data(), memberCount, packet);
+	}
+
+	VOID IOCPServer::EnqueueSendMessage(Session *session, SerializedBuffer *packet)
+	{
+		NetworkMessage *sendMessage = messagePool->Alloc();
+		sendMessage->sessionID = session->sessionID;
+		sendMessage->packet = packet;
+		session->SendQueue.Enqueue(sendMessage);
+	}
+
+	VOID IOCPServer::SendPacketSealed(Session *session, SerializedBuffer *packet)
+	{
+		// 헤더를 제외한 평문 페이로드를 세션 전용 패킷에 바로 암호화하여 넣습니다
+		PUCHAR payload = packet->begin + NETWORK_HEADER_SIZE_MAX;
+		INT32 payloadSize = static_cast<INT32>(packet->write - payload);
+		SerializedBuffer *sealedPacket = AllocPacket(payloadSize + SessionCipher::TAG_SIZE);
+
+		// 메시지 순번이 곧 송신 순서여야 하므로, 암호화부터 송신 버퍼에 넣기까지 세션의 송신 암호화를 잠급니다
+		session->Cipher.LockSend();
+		if (!session->Cipher.Seal(payload, payloadSize, sealedPacket->write, sealedPacket->write + payloadSize))
+		{
+			// 순번이 이미 소비되었으므로 이후 메시지는 상대가 인증할 수 없습니다 / 세션을 종료합니다
+			session->Cipher.UnlockSend();
+			EXCEPTION(EXCEPTION_SESSION_CIPHER);
+			FreePacket(sealedPacket);
+			DisconnectSession(session->sessionID);
+			return;
+		}
+		sealedPacket->write += payloadSize + SessionCipher::TAG_SIZE;
+		sealedPacket->BuildNetworkHeader();
+
+		if (serverSettings.sendZeroCopy)
+		{
+			// 할당받은 참조를 송신 큐에 넘깁니다
+			EnqueueSendMessage(session, sealedPacket);
+			sealedPacket = nullptr;
+		} else
+		{
+			// 세션의 송신 큐에 동기화 모드에 맞게 패킷을 삽입합니다
+			BOOL enqueueResult = session->SendRingBuffer.Produce((PCHAR)sealedPacket->GetBufferRead(), sealedPacket->GetBufferSizeUsed());
+			if (!enqueueResult)
+			{
+				EXCEPTION(EXCEPTION_BUFFER_ERROR);
+			}
+		}
+		session->Cipher.UnlockSend();
+
+		if (sealedPacket != nullptr) FreePacket(sealedPacket);
+	}
+
+	SerializedBuffer *IOCPServer::AllocPacket()
+	{
+		return AllocPacket(SerializedBuffer::BUFFER_SIZE_DEFAULT - NETWORK_HEADER_SIZE_MAX);
+	}
+
+	SerializedBuffer *IOCPServer::AllocPacket(INT32 payloadSize)
+	{
+		SerializedBuffer *packet = packetPool->Alloc(payloadSize + NETWORK_HEADER_SIZE_MAX);
+		packet->Clear(true);
+		packet->refCount = 1;
+		return packet;
+	}
+
+	VOID IOCPServer::FreePacket(SerializedBuffer *packet)
+	{
+		if (InterlockedDecrement(&packet->refCount) == 0)
+		{
+			packetPool->Free(packet);
+		}
+	}
+
+	BOOL IOCPServer::SetSessionCipher(DWORD64 sessionID, const SessionCipher::Key *key)
+	{
+		// 세션을 얻어옵니다
+		Session *session = AcquireSession(sessionID);
+		if (session == nullptr) return false;
+
+		BOOL initializeResult = session->Cipher.Initialize(key);
+
+		// 세션을 반환합니다
+		ReturnSession(session);
+		return initializeResult;
+	}
+
 	VOID IOCPServer::DisconnectSession(DWORD64 sessionID)
 	{
 		// 세션을 얻어옵니다
@@ -86,7 +307,12 @@ namespace azely
 		if (session == nullptr) return;
 
 		// 세션과 연결된 소켓의 IO를 중단합니다
+#ifdef _WIN32
 		CancelIoEx((HANDLE)session->socket, nullptr);
+#else
+		// epoll 에서는 소켓을 shutdown 하여 WorkerThread가 수신 종료를 감지하도록 합니다
+		shutdown(session->socket, SHUT_RDWR);
+#endif
 
 		// 세션을 반환합니다
 		ReturnSession(session);
@@ -121,6 +347,71 @@ namespace azely
 		{
 			serverSettings.workerThreadRunning = systemInfo.dwNumberOfProcessors;
 		}
+		// 만일 acceptPostCount 개수가 0이라면 64로 설정합니다
+		if (serverSettings.acceptPostCount == 0)
+		{
+			serverSettings.acceptPostCount = 64;
+		}
+		// 만일 shardCount 개수가 0이라면 1로 설정합니다
+		if (serverSettings.shardCount <= 0)
+		{
+			serverSettings.shardCount = 1;
+		}
+
+		// 만일 timeoutTick 이 0이라면 10으로 설정합니다
+		if (serverSettings.timeoutTick <= 0)
+		{
+			serverSettings.timeoutTick = 10;
+		}
+
+		// 만일 logicThreadCount 가 0이라면 1로, LOGIC_THREAD_MAX 보다 크다면 LOGIC_THREAD_MAX로 설정합니다
+		if (serverSettings.logicThreadCount <= 0)
+		{
+			serverSettings.logicThreadCount = 1;
+		}
+		if (serverSettings.logicThreadCount > LOGIC_THREAD_MAX)
+		{
+			serverSettings.logicThreadCount = LOGIC_THREAD_MAX;
+		}
+
+		// 만일 sendQueueMode 가 범위를 벗어난다면 0으로 설정합니다
+		if (serverSettings.sendQueueMode < RingBuffer::SYNC_LOCK || serverSettings.sendQueueMode > RingBuffer::SYNC_MPSC)
+		{
+			serverSettings.sendQueueMode = RingBuffer::SYNC_LOCK;
+		}
+
+		// 만일 messageSizeMax 가 0이라면 8192로, NETWORK_MESSAGE_SIZE_LIMIT 보다 크다면 NETWORK_MESSAGE_SIZE_LIMIT로 설정합니다
+		if (serverSettings.messageSizeMax <= 0)
+		{
+			serverSettings.messageSizeMax = 8192;
+		}
+		if (serverSettings.messageSizeMax > NETWORK_MESSAGE_SIZE_LIMIT)
+		{
+			serverSettings.messageSizeMax = NETWORK_MESSAGE_SIZE_LIMIT;
+		}
+		// 만일 messageSizeMax 크기의 메시지가 송신 링버퍼에 들어가지 않는다면 sendZeroCopy 를 켭니다
+		if (serverSettings.messageSizeMax + NETWORK_HEADER_SIZE_MAX > RingBuffer::BUFFER_SIZE_DEFAULT - 1)
+		{
+			serverSettings.sendZeroCopy = 1;
+		}
+
+#ifdef _WIN32
+		// Windows 에서는 IOCP 만 사용하므로 ioBackend 를 0으로 설정합니다
+		serverSettings.ioBackend = IO_BACKEND_EPOLL;
+#else
+		// 만일 ioBackend 가 범위를 벗어난다면 0으로 설정합니다
+		if (serverSettings.ioBackend < IO_BACKEND_EPOLL || serverSettings.ioBackend > IO_BACKEND_URING_FIXED)
+		{
+			serverSettings.ioBackend = IO_BACKEND_EPOLL;
+		}
+		// 만일 multishot 수신인데 세션 테이블 슬롯이 버퍼 그룹 ID(16비트)로 나타낼 수 있는 개수보다 많다면 2로 설정합니다
+		if (serverSettings.ioBackend == IO_BACKEND_URING_MULTISHOT && serverSettings.sessionCountMax + serverSettings.acceptPostCount > 65536)
+		{
+			serverSettings.ioBackend = IO_BACKEND_URING_FIXED;
+		}
+		// 만일 커널이 지원하지 않는다면 사용할 수 있는 백엔드로 낮춥니다
+		serverSettings.ioBackend = ProbeUringBackend(serverSettings.ioBackend);
+#endif
 
 		// 설정 정보를 출력합니다
 		wcout << "setting :: listenAddress : " << serverSettings.listenAddress << endl;
@@ -132,6 +423,16 @@ namespace azely
 		wcout << "setting :: workerThreadRunning : " << serverSettings.workerThreadRunning << endl;
 		wcout << "setting :: sessionCountMax : " << serverSettings.sessionCountMax << endl;
 		wcout << "setting :: sessionTimeout : " << serverSettings.sessionTimeout << endl;
+		wcout << "setting :: acceptPostCount : " << serverSettings.acceptPostCount << endl;
+		wcout << "setting :: shardCount : " << serverSettings.shardCount << endl;
+		wcout << "setting :: timeoutTick : " << serverSettings.timeoutTick << endl;
+		wcout << "setting :: logicThreadCount : " << serverSettings.logicThreadCount << endl;
+		wcout << "setting :: inlineDispatch : " << serverSettings.inlineDispatch << endl;
+		wcout << "setting :: ringBufferMirrored : " << serverSettings.ringBufferMirrored << endl;
+		wcout << "setting :: sendQueueMode : " << serverSettings.sendQueueMode << endl;
+		wcout << "setting :: sendZeroCopy : " << serverSettings.sendZeroCopy << endl;
+		wcout << "setting :: messageSizeMax : " << serverSettings.messageSizeMax << endl;
+		wcout << "setting :: ioBackend : " << serverSettings.ioBackend << endl;
 
 		return true;
 	}
@@ -146,10 +447,13 @@ namespace azely
 		}
 
 		// 메모리 풀과 메시지 큐를 준비합니다
-		sessionPool = new MemoryPool<Session>(false, serverSettings.sessionCountMax);
-		packetPool = new MemoryPool<SerializedBuffer>(false);
-		messagePool = new MemoryPool<NetworkMessage>(false);
-		currentQueue = messageQueue.CreateQueue();
+		// 세션 테이블은 최대 세션 개수에 AcceptEx로 미리 할당해두는 세션 개수를 더한 크기로 만들며, alignas(64) 멤버를 가지므로 캐시라인 정렬된 메모리에 생성합니다
+		sessionTable = new (_aligned_malloc(sizeof(SessionTable), alignof(SessionTable))) SessionTable(serverSettings.sessionCountMax + serverSettings.acceptPostCount, serverSettings.shardCount,
+			serverSettings.ringBufferMirrored != 0, static_cast<RingBuffer::SyncMode>(serverSettings.sendQueueMode));
+		timerWheel = new TimerWheel(sessionTable->GetCapacity(), serverSettings.timeoutTick, timeGetTime());
+		groupTable = new SessionGroupTable(sessionTable->GetCapacity());
+		packetPool = new PacketPool();
+		messagePool = new MemoryPoolTLS<NetworkMessage>(false);
 
 		// WSA Startup
 		WSADATA wsa;
@@ -159,55 +463,153 @@ namespace azely
 			return false;
 		}
 
-		// IO Completion Port를 생성합니다
-		handleIOCP = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, serverSettings.workerThreadRunning);
-		if (handleIOCP == NULL || handleIOCP == INVALID_HANDLE_VALUE)
+		// 샤드를 준비합니다
+		// 샤드는 alignas(64) 멤버를 가지므로 캐시라인 정렬된 메모리에 생성합니다
+		shards = static_cast<ServerShard *>(_aligned_malloc(sizeof(ServerShard) * serverSettings.shardCount, alignof(ServerShard)));
+		for (int i = 0; i < serverSettings.shardCount; i++)
 		{
-			EXCEPTION(EXCEPTION_IOCP_CREATION);
-			return false;
+			new (&shards[i]) ServerShard();
+			shards[i].server = this;
+			shards[i].shardIndex = i;
+			if (!ReadyShard(&shards[i])) return false;
 		}
 
-		// IOCP Worker Thread를 생성합니다
-		handleWorkers = new HANDLE[serverSettings.workerThreadTotal];
-		for (int i = 0; i < serverSettings.workerThreadTotal; i++)
+		// Packet, Timeout Thread를 생성합니다
+		// LogicThread도 alignas(64) 멤버를 가지므로 캐시라인 정렬된 메모리에 생성합니다
+		logicThreads = static_cast<LogicThread *>(_aligned_malloc(sizeof(LogicThread) * serverSettings.logicThreadCount, alignof(LogicThread)));
+		for (int i = 0; i < serverSettings.logicThreadCount; i++)
 		{
-			handleWorkers[i] = (HANDLE)_beginthreadex(nullptr, 0, WorkerThreadProc, this, 0, nullptr);
-			if (handleWorkers == NULL || handleWorkers == INVALID_HANDLE_VALUE)
+			new (&logicThreads[i]) LogicThread();
+		}
+		for (int i = 0; i < serverSettings.logicThreadCount; i++)
+		{
+			LogicThread *logicThread = &logicThreads[i];
+			logicThread->server = this;
+			logicThread->threadIndex = i;
+			logicThread->handleThread = (HANDLE)_beginthreadex(nullptr, 0, PacketThreadProc, logicThread, 0, nullptr);
+			if (logicThread->handleThread == NULL || logicThread->handleThread == INVALID_HANDLE_VALUE)
 			{
 				EXCEPTION(EXCEPTION_THREAD_CREATION);
 				return false;
 			}
 		}
 
-		// Accept, Packet, Timeout Thread를 생성합니다
-		handleAccept = (HANDLE)_beginthreadex(nullptr, 0, AcceptThreadProc, this, 0, nullptr);
-		if (handleAccept == NULL || handleAccept == INVALID_HANDLE_VALUE)
+		handleTimeout = (HANDLE)_beginthreadex(nullptr, 0, TimeCheckThreadProc, this, 0, nullptr);
+		if (handleTimeout == NULL || handleTimeout == INVALID_HANDLE_VALUE)
 		{
 			EXCEPTION(EXCEPTION_THREAD_CREATION);
 			return false;
 		}
 
-		handleLogic = (HANDLE)_beginthreadex(nullptr, 0, PacketThreadProc, this, 0, nullptr);
-		if (handleLogic == NULL || handleLogic == INVALID_HANDLE_VALUE)
+		// 서버의 상태를 준비로 변경합니다
+		serverStatus = STATUS_READY;
+		return true;
+	}
+
+	BOOL IOCPServer::ReadyShard(ServerShard *shard)
+	{
+		// 샤드별 WorkerThread 개수는 전체 개수를 샤드 개수로 나눈 값이며, 최소 1개입니다
+		INT32 workerTotal = serverSettings.workerThreadTotal / serverSettings.shardCount;
+		INT32 workerRunning = serverSettings.workerThreadRunning / serverSettings.shardCount;
+		if (workerTotal < 1) workerTotal = 1;
+		if (workerRunning < 1) workerRunning = 1;
+
+#ifdef _WIN32
+		// IO Completion Port를 생성합니다
+		shard->handleIOCP = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, workerRunning);
+		if (shard->handleIOCP == NULL || shard->handleIOCP == INVALID_HANDLE_VALUE)
 		{
-			EXCEPTION(EXCEPTION_THREAD_CREATION);
+			EXCEPTION(EXCEPTION_IOCP_CREATION);
 			return false;
 		}
-
-		handleTimeout = (HANDLE)_beginthreadex(nullptr, 0, TimeCheckThreadProc, this, 0, nullptr);
-		if (handleTimeout == NULL || handleTimeout == INVALID_HANDLE_VALUE)
+#else
+		// PostQueuedCompletionStatus를 대신할 통지 큐의 eventfd를 생성합니다
+		// 통지 자체는 샤드의 통지 큐에 담기므로 eventfd는 깨우는 용도로만 쓰며, 어느 쪽도 막히지 않도록 논블로킹으로 만듭니다
+		shard->handleNotify = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (shard->handleNotify == -1)
 		{
-			EXCEPTION(EXCEPTION_THREAD_CREATION);
+			EXCEPTION(EXCEPTION_IOCP_CREATION, errno);
 			return false;
 		}
 
+		// io_uring 백엔드라면 WorkerThread마다 링을 하나씩 만듭니다
+		if (serverSettings.ioBackend != IO_BACKEND_EPOLL)
+		{
+			if (!ReadyUring(shard, workerTotal)) return false;
+		} else
+		{
+			// epoll 인스턴스를 생성합니다
+			shard->handleEpoll = epoll_create1(EPOLL_CLOEXEC);
+			if (shard->handleEpoll == -1)
+			{
+				EXCEPTION(EXCEPTION_IOCP_CREATION, errno);
+				return false;
+			}
+
+			// 통지 eventfd는 completionKey 0 으로 등록합니다
+			epoll_event notifyEvent;
+			notifyEvent.events = EPOLLIN;
+			notifyEvent.data.u64 = 0;
+			if (epoll_ctl(shard->handleEpoll, EPOLL_CTL_ADD, shard->handleNotify, &notifyEvent) == -1)
+			{
+				EXCEPTION(EXCEPTION_IOCP_CREATION, errno);
+				return false;
+			}
+		}
+#endif
+
+		// IOCP Worker Thread를 생성합니다
+		shard->workerCount = workerTotal;
+		shard->handleWorkers = new HANDLE[workerTotal];
+		for (int i = 0; i < workerTotal; i++)
+		{
+#ifdef _WIN32
+			shard->handleWorkers[i] = (HANDLE)_beginthreadex(nullptr, 0, WorkerThreadProc, shard, 0, nullptr);
+#else
+			// io_uring 백엔드라면 WorkerThread마다 자기 링을 넘깁니다
+			if (serverSettings.ioBackend != IO_BACKEND_EPOLL)
+			{
+				shard->handleWorkers[i] = (HANDLE)_beginthreadex(nullptr, 0, UringWorkerThreadProc, &shard->rings[i], 0, nullptr);
+			} else
+			{
+				shard->handleWorkers[i] = (HANDLE)_beginthreadex(nullptr, 0, WorkerThreadProc, shard, 0, nullptr);
+			}
+#endif
+			if (shard->handleWorkers[i] == NULL || shard->handleWorkers[i] == INVALID_HANDLE_VALUE)
+			{
+				EXCEPTION(EXCEPTION_THREAD_CREATION);
+				return false;
+			}
+		}
+
+#ifdef _WIN32
+		// Windows 에는 커널이 접속을 나눠주는 SO_REUSEPORT가 없으므로, 첫번째 샤드만 listenSocket을 가지고
+		// 수락된 세션을 샤드에 돌아가며 배정합니다
+		if (shard->shardIndex != 0) return true;
+#endif
+
 		// listenSocket을 생성합니다
-		listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		SOCKET listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 		if (listenSocket == INVALID_SOCKET)
 		{
 			EXCEPTION(EXCEPTION_SOCKET_CREATE);
 			return false;
 		}
+		shard->listenSocket = listenSocket;
+
+#ifndef _WIN32
+		// 샤드가 여러개라면 SO_REUSEPORT로 같은 주소에 샤드별 listenSocket을 바인딩하여, 커널이 접속을 샤드에 나눠주도록 합니다
+		if (serverSettings.shardCount > 1)
+		{
+			int reusePort = 1;
+			int reusePortResult = setsockopt(listenSocket, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<PCSTR>(&reusePort), sizeof(reusePort));
+			if (reusePortResult == SOCKET_ERROR)
+			{
+				EXCEPTION(EXCEPTION_SOCKET_OPTION, WSAGetLastError());
+				return false;
+			}
+		}
+#endif
 
 		// LINGER 설정을 onoff 1, linger 0으로 설정합니다.
 		// 이는 서버에서 클라이언트 연결 종료시 4way handshake 절차에 들어가지 않도록 하기 위함입니다.
@@ -222,12 +624,18 @@ namespace azely
 		}
 
 		// 송신 버퍼 크기를 지정한 크기로 설정합니다
-		DWORD sendBufferSize = serverSettings.sendBufferSize;
-		int bufferResult = setsockopt(listenSocket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<PCSTR>(&sendBufferSize), sizeof(sendBufferSize));
-		if (bufferResult == SOCKET_ERROR)
+		// Linux 에서 0 은 커널 최소 크기를 의미하므로, 0 이라면 커널 자동 조정에 맡깁니다
+#ifndef _WIN32
+		if (serverSettings.sendBufferSize > 0)
+#endif
 		{
-			EXCEPTION(EXCEPTION_SOCKET_OPTION);
-			return false;
+			DWORD sendBufferSize = serverSettings.sendBufferSize;
+			int bufferResult = setsockopt(listenSocket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<PCSTR>(&sendBufferSize), sizeof(sendBufferSize));
+			if (bufferResult == SOCKET_ERROR)
+			{
+				EXCEPTION(EXCEPTION_SOCKET_OPTION);
+				return false;
+			}
 		}
 
 		// 만일 nodelay 설정이 1이라면 nodelay를 설정하여 Nagle 알고리즘을 비활성화합니다
@@ -249,15 +657,13 @@ namespace azely
 		WSAStringToAddressW(serverSettings.listenAddress, AF_INET, 0, reinterpret_cast<LPSOCKADDR>(&bindAddress), &bindAddressLength);
 		WSAHtons(listenSocket, serverSettings.listenPort, &bindAddress.sin_port);
 		bindAddress.sin_family = AF_INET;
-		int bindResult = bind(listenSocket, reinterpret_cast<PSOCKADDR>(&bindAddress), sizeof(SOCKADDR_IN));
+		int bindResult = ::bind(listenSocket, reinterpret_cast<PSOCKADDR>(&bindAddress), sizeof(SOCKADDR_IN));
 		if (bindResult == SOCKET_ERROR)
 		{
 			EXCEPTION(EXCEPTION_SOCKET_BIND, WSAGetLastError());
 			return false;
 		}
 
-		// 서버의 상태를 준비로 변경합니다
-		serverStatus = STATUS_READY;
 		return true;
 	}
 
@@ -270,19 +676,80 @@ namespace azely
 			return false;
 		}
 
-		// listenSocket이 유효하지 않다면 리턴합니다
-		if (listenSocket == INVALID_SOCKET)
+		for (int i = 0; i < serverSettings.shardCount; i++)
 		{
-			EXCEPTION(EXCEPTION_SOCKET_INVALID);
-			return false;
-		}
+			ServerShard *shard = &shards[i];
+			SOCKET listenSocket = shard->listenSocket;
 
-		// listen을 시작합니다
-		int listenResult = listen(listenSocket, SOMAXCONN_HINT(serverSettings.backlogSize));
-		if (listenResult == SOCKET_ERROR)
-		{
-			EXCEPTION(EXCEPTION_SOCKET_LISTEN);
-			return false;
+#ifdef _WIN32
+			// listenSocket은 첫번째 샤드만 가집니다
+			if (shard->shardIndex != 0) continue;
+#endif
+
+			// listenSocket이 유효하지 않다면 리턴합니다
+			if (listenSocket == INVALID_SOCKET)
+			{
+				EXCEPTION(EXCEPTION_SOCKET_INVALID);
+				return false;
+			}
+
+			// listen을 시작합니다
+			int listenResult = listen(listenSocket, SOMAXCONN_HINT(serverSettings.backlogSize));
+			if (listenResult == SOCKET_ERROR)
+			{
+				EXCEPTION(EXCEPTION_SOCKET_LISTEN);
+				return false;
+			}
+
+#ifdef _WIN32
+			// AcceptEx, GetAcceptExSockaddrs 함수 포인터를 얻어옵니다
+			GUID acceptExGuid = WSAID_ACCEPTEX;
+			GUID getAcceptExSockaddrsGuid = WSAID_GETACCEPTEXSOCKADDRS;
+			DWORD ioctlBytes = 0;
+			int acceptExResult = WSAIoctl(listenSocket, SIO_GET_EXTENSION_FUNCTION_POINTER, &acceptExGuid, sizeof(acceptExGuid), &fnAcceptEx, sizeof(fnAcceptEx), &ioctlBytes, nullptr, nullptr);
+			int getAcceptExSockaddrsResult = WSAIoctl(listenSocket, SIO_GET_EXTENSION_FUNCTION_POINTER, &getAcceptExSockaddrsGuid, sizeof(getAcceptExSockaddrsGuid), &fnGetAcceptExSockaddrs, sizeof(fnGetAcceptExSockaddrs), &ioctlBytes, nullptr, nullptr);
+			if (acceptExResult == SOCKET_ERROR || getAcceptExSockaddrsResult == SOCKET_ERROR)
+			{
+				EXCEPTION(EXCEPTION_SOCKET_OPTION, WSAGetLastError());
+				return false;
+			}
+
+			// listenSocket을 IOCP에 등록하여 접속 완료 통지를 WorkerThread가 받도록 합니다
+			if (CreateIoCompletionPort((HANDLE)listenSocket, shard->handleIOCP, ACCEPT_COMPLETION_KEY, 0) == NULL)
+			{
+				EXCEPTION(EXCEPTION_IOCP, GetLastError());
+				return false;
+			}
+
+			// 설정한 개수만큼 AcceptEx를 미리 걸어둡니다
+			for (int j = 0; j < serverSettings.acceptPostCount; j++)
+			{
+				AcceptPost();
+			}
+#else
+			// io_uring 백엔드라면 샤드의 첫 링에 multishot accept를 걸어, 그 링의 WorkerThread가 수락 완료를 묶어서 처리하도록 합니다
+			if (serverSettings.ioBackend != IO_BACKEND_EPOLL)
+			{
+				ArmAcceptUring(&shard->rings[0]);
+				continue;
+			}
+
+			// listenSocket을 논블로킹으로 epoll에 등록하여, 접속 준비 통지를 받은 WorkerThread가 접속을 묶어서 수락하도록 합니다
+			int listenFlags = fcntl(listenSocket, F_GETFL, 0);
+			if (listenFlags == -1 || fcntl(listenSocket, F_SETFL, listenFlags | O_NONBLOCK) == -1)
+			{
+				EXCEPTION(EXCEPTION_SOCKET_OPTION, errno);
+				return false;
+			}
+			epoll_event listenEvent;
+			listenEvent.events = EPOLLIN | EPOLLET;
+			listenEvent.data.u64 = ACCEPT_COMPLETION_KEY;
+			if (epoll_ctl(shard->handleEpoll, EPOLL_CTL_ADD, (int)listenSocket, &listenEvent) == -1)
+			{
+				EXCEPTION(EXCEPTION_IOCP, errno);
+				return false;
+			}
+#endif
 		}
 
 		// 서버 running start time을 기록합니다
@@ -294,19 +761,82 @@ namespace azely
 
 	VOID IOCPServer::StopServer()
 	{
-		// 서버의 상태를 정지로 변경합니다
+		// 서버의 상태를 정지로 변경하고, 메시지를 기다리며 잠든 PacketThread를 깨웁니다
 		serverStatus = STATUS_STOP;
+		for (int i = 0; i < serverSettings.logicThreadCount; i++)
+		{
+			logicThreads[i].messageQueue.Close();
+		}
 
 		WaitForSingleObject(handleTimeout, INFINITE);
-		WaitForSingleObject(handleLogic, INFINITE);
+		for (int i = 0; i < serverSettings.logicThreadCount; i++)
+		{
+			WaitForSingleObject(logicThreads[i].handleThread, INFINITE);
+		}
 
-		listenSocket = INVALID_SOCKET;
-		WaitForSingleObject(handleAccept, INFINITE);
+		// listenSocket을 닫아 걸어둔 accept 요청을 모두 취소합니다
+		for (int i = 0; i < serverSettings.shardCount; i++)
+		{
+			ServerShard *shard = &shards[i];
+			SOCKET closingSocket = shard->listenSocket;
+			if (closingSocket == INVALID_SOCKET) continue;
+			shard->listenSocket = INVALID_SOCKET;
+#ifndef _WIN32
+			// io_uring 에 걸어둔 accept 는 소켓을 닫기만 해서는 깨어나지 않으므로 shutdown 으로 끝냅니다
+			if (serverSettings.ioBackend != IO_BACKEND_EPOLL)
+			{
+				shutdown(closingSocket, SHUT_RDWR);
+			} else
+			{
+				epoll_ctl(shard->handleEpoll, EPOLL_CTL_DEL, (int)closingSocket, nullptr);
+			}
+#endif
+			closesocket(closingSocket);
+		}
 
-		WaitForMultipleObjects(serverSettings.workerThreadTotal, handleWorkers, true, INFINITE);
+#ifdef _WIN32
+		// 취소된 AcceptEx의 완료 통지가 모두 처리되어 세션이 세션 테이블로 반환될 때까지 대기합니다
+		while (acceptPendingCount != 0)
+		{
+			Sleep(1);
+		}
+#endif
 
-		CloseHandle(handleIOCP);
-		delete handleWorkers;
+		// 각 샤드의 WorkerThread에게 종료를 알리고, 종료를 기다립니다
+		for (int i = 0; i < serverSettings.shardCount; i++)
+		{
+			ServerShard *shard = &shards[i];
+#ifdef _WIN32
+			PostQueuedCompletionStatus(shard->handleIOCP, 0, (ULONG_PTR)0xffffffff, nullptr);
+#else
+			PostNotify(shard, 0xffffffff);
+#endif
+			WaitForMultipleObjects(shard->workerCount, shard->handleWorkers, true, INFINITE);
+
+#ifdef _WIN32
+			CloseHandle(shard->handleIOCP);
+#else
+			if (serverSettings.ioBackend != IO_BACKEND_EPOLL)
+			{
+				ReleaseUring(shard);
+			} else
+			{
+				close(shard->handleEpoll);
+			}
+			close(shard->handleNotify);
+			shard->notifyQueue.clear();
+#endif
+			delete[] shard->handleWorkers;
+			shard->~ServerShard();
+		}
+		_aligned_free(shards);
+		shards = nullptr;
+		for (int i = 0; i < serverSettings.logicThreadCount; i++)
+		{
+			logicThreads[i].~LogicThread();
+		}
+		_aligned_free(logicThreads);
+		logicThreads = nullptr;
 		WSACleanup();
 
 		// 서버의 상태를 릴리즈됨으로 변경합니다
@@ -320,58 +850,128 @@ namespace azely
 		session->RecvRingBuffer.MoveWriteBuffer(byteTransferred);
 
 		// 타임아웃 처리를 위해 세션의 TimeoutTime을 현재 시간으로 갱신합니다
+		// 타이머 휠은 걸어둔 만료 시점에 TimeoutTime을 다시 확인하므로 휠을 건드리지 않습니다
 		session->TimeoutTime = timeGetTime() + serverSettings.sessionTimeout;
 
-		// 받은 네트워크 데이터에서 메시지를 가능한 만큼 뽑아내어 처리합니다
-		while (true)
+		// 받은 네트워크 데이터에서 메시지를 가능한 만큼 뽑아내어 처리하거나, 모아 두었다가 세션의 PacketThread에 한 번에 넘깁니다
+		LogicThread *logicThread = GetLogicThread(session->sessionID);
+		RingBuffer &recvRingBuffer = session->RecvRingBuffer;
+		static thread_local SerializedBuffer inlinePacket;
+		static thread_local NetworkFrame frames[RECV_FRAME_BATCH_MAX];
+		static thread_local vector<NetworkMessage *> recvMessages;
+		recvMessages.clear();
+		LONG recvCount = 0;
+		BOOL isFrameCorrupted = false;
+
+		while (!isFrameCorrupted)
 		{
-			// 패킷 풀에서 패킷을 할당합니다
-			AcquireSRWLockExclusive(&packetPoolSRW);
-			SerializedBuffer *serializedBuffer = packetPool->Alloc();
-			ReleaseSRWLockExclusive(&packetPoolSRW);
-
-			// 패킷을 초기화합니다
-			serializedBuffer->Clear(false);
+			// 수신 링버퍼의 끊기지 않은 구간을 한 번 훑어, 완성된 메시지들의 위치를 한꺼번에 찾습니다
+			INT32 scannedSize = 0;
+			INT32 frameCount = 0;
+			if (session->RecvLargePacket == nullptr)
+			{
+				frameCount = DecodeNetworkFrames(reinterpret_cast<const UCHAR *>(recvRingBuffer.GetReadBuffer()), recvRingBuffer.GetSizeDirectDequeueAble(),
+					static_cast<UINT32>(serverSettings.messageSizeMax), frames, RECV_FRAME_BATCH_MAX, &scannedSize);
+			}
 
-			// 세션의 RecvRingBuffer에서 완성된 메시지를 읽어오기를 시도합니다
-			NetworkHeader networkHeader;
-			bool packetCompleted = GetPacketCompleted(session, serializedBuffer, &networkHeader);
-			if (packetCompleted)
+			// 찾지 못했다면 링버퍼 끝에서 끊긴 메시지, 모으던 큰 메시지, 잘못된 헤더 중 하나이므로 한 메시지씩 처리합니다
+			if (frameCount == 0)
 			{
-				InterlockedIncrement(&this->recvMessagePerSecondCounter);
+				if (serverSettings.inlineDispatch && DispatchPacketView(session))
+				{
+					recvCount++;
+					continue;
+				}
 
-				// 메시지 풀에서 메시지를 할당합니다
-				NetworkMessage *newMessage = nullptr;
-				AcquireSRWLockExclusive(&messagePoolSRW);
-				newMessage = messagePool->Alloc();
-				ReleaseSRWLockExclusive(&messagePoolSRW);
-				newMessage->sessionID = session->sessionID;
-				newMessage->packet = serializedBuffer;
+				inlinePacket.Clear(false);
+				SerializedBuffer *completedPacket = GetPacketCompleted(session, serverSettings.inlineDispatch ? &inlinePacket : nullptr);
+				if (completedPacket == nullptr) break;
+				recvCount++;
 
-				// 메시지 큐에 메시지를 넣습니다
-				messageQueue.Enqueue(newMessage);
-			} else
+				NetworkMessage *recvMessage = DispatchRecvPacket(session, completedPacket, &inlinePacket);
+				if (recvMessage != nullptr) recvMessages.push_back(recvMessage);
+				continue;
+			}
+
+			// 찾은 메시지들을 링버퍼 안에서 바로 처리하거나 패킷에 복사하고, 다 처리한 뒤에 읽기 위치를 한 번에 이동시킵니다
+			const UCHAR *scanBuffer = reinterpret_cast<const UCHAR *>(recvRingBuffer.GetReadBuffer());
+			for (INT32 i = 0; i < frameCount; i++)
 			{
-				// 패킷 풀에 패킷을 반환합니다
-				AcquireSRWLockExclusive(&packetPoolSRW);
-				packetPool->Free(serializedBuffer);
-				ReleaseSRWLockExclusive(&packetPoolSRW);
+				const NetworkFrame *frame = &frames[i];
+				const UCHAR *payload = scanBuffer + frame->offset;
+
+#ifndef _SIMPLE_HEADER
+				// 체크섬을 검증합니다
+				if (NETWORK_CHECKSUM(payload, frame->length) != frame->checksum)
+				{
+					isFrameCorrupted = true;
+					break;
+				}
+#endif
+
+				// 인라인 디스패치라면 복사하지 않고 뷰로 먼저 넘겨봅니다
+				if (serverSettings.inlineDispatch && !session->Cipher.IsEnabled())
+				{
+					PacketView view(payload, frame->length);
+					if (OnRecvMessage(session->sessionID, view))
+					{
+						recvCount++;
+						continue;
+					}
+				}
+
+				// 인라인 버퍼에 들어가지 않거나 PacketThread로 넘길 메시지는 크기에 맞는 등급의 패킷에 복사합니다
+				SerializedBuffer *packet = &inlinePacket;
+				if (!serverSettings.inlineDispatch || frame->length > inlinePacket.GetBufferSizeTotal())
+				{
+					packet = packetPool->Alloc(frame->length);
+				}
+				packet->Clear(false);
+				packet->PutData(const_cast<PUCHAR>(payload), frame->length);
+
+				// 암호화된 세션이라면 복호화합니다
+				if (session->Cipher.IsEnabled() && !OpenPacket(session, packet))
+				{
+					if (packet != &inlinePacket) packetPool->Free(packet);
+					isFrameCorrupted = true;
+					break;
+				}
+				recvCount++;
+
+				NetworkMessage *recvMessage = DispatchRecvPacket(session, packet, &inlinePacket);
+				if (recvMessage != nullptr) recvMessages.push_back(recvMessage);
 			}
+			recvRingBuffer.MoveReadBuffer(scannedSize);
+		}
+
+		// 체크섬이나 인증에 실패한 메시지가 있었다면 세션을 종료합니다
+		if (isFrameCorrupted) DisconnectSession(session->sessionID);
 
-			// 세션의 RecvRingBuffer에서 완성된 메시지를 읽어오는데 실패했다면 루프를 탈출합니다
-			if (!packetCompleted) break;
+		// 통계와 PacketThread로 넘길 메시지들을 한 번에 반영합니다
+		if (recvCount > 0) InterlockedExchangeAdd(&this->recvMessagePerSecondCounter, recvCount);
+		if (!recvMessages.empty())
+		{
+			INT32 recvMessageCount = static_cast<INT32>(recvMessages.size());
+			logicThread->messageQueue.EnqueueBatch(recvMessages.data(), recvMessageCount);
+			InterlockedExchangeAdd(&logicThread->queueDepth, recvMessageCount);
 		}
 
+#ifdef _WIN32
 		// 읽기가 완료되었으니, 다시 WSARecv 호출을 통해 클라이언트의 데이터를 받아옵니다
 		RecvPost(session);
+#endif
 	}
 
 	VOID IOCPServer::SendProc(Session *session, DWORD byteTransferred)
 	{
-		// 송신 링버퍼를 잠그고, 송신 링버퍼의 ReadBuffer를 byteTransferred만큼 이동시킵니다
-		session->SendRingBuffer.LockSRWExclusive();
-		session->SendRingBuffer.MoveReadBuffer(byteTransferred);
-		session->SendRingBuffer.UnlockSRWExclusive();
+		// 송신 링버퍼의 ReadBuffer, 혹은 보내는 중인 패킷들을 byteTransferred만큼 정리합니다
+		if (serverSettings.sendZeroCopy)
+		{
+			CompleteSendGather(session, byteTransferred);
+		} else
+		{
+			session->SendRingBuffer.Consume(byteTransferred);
+		}
 
 		InterlockedExchange(&session->ioFlag, false);
 
@@ -379,6 +979,68 @@ namespace azely
 		this->SendPost(session);
 	}
 
+	INT32 IOCPServer::LoadSendGather(Session *session)
+	{
+		// 송신 큐에서 꺼낼 수 있는 만큼 꺼내 보내는 중인 패킷들 뒤에 붙입니다
+		while (session->SendGatherCount < SESSION_SEND_GATHER_MAX)
+		{
+			NetworkMessage *sendMessage = session->SendQueue.Dequeue();
+			if (sendMessage == nullptr) break;
+			session->SendGather[session->SendGatherCount++] = sendMessage;
+		}
+
+		INT32 sendSize = -session->SendGatherOffset;
+		for (int i = 0; i < session->SendGatherCount; i++)
+		{
+			sendSize += session->SendGather[i]->packet->GetBufferSizeUsed();
+		}
+		return sendSize;
+	}
+
+	VOID IOCPServer::CompleteSendGather(Session *session, INT32 sentSize)
+	{
+		// 다 보낸 패킷들을 반환하고, 일부만 보낸 패킷은 보낸 크기를 기록해둡니다
+		int sentCount = 0;
+		sentSize += session->SendGatherOffset;
+		while (sentCount < session->SendGatherCount)
+		{
+			NetworkMessage *sendMessage = session->SendGather[sentCount];
+			INT32 packetSize = sendMessage->packet->GetBufferSizeUsed();
+			if (sentSize < packetSize) break;
+			sentSize -= packetSize;
+			FreePacket(sendMessage->packet);
+			messagePool->Free(sendMessage);
+			sentCount++;
+		}
+		session->SendGatherOffset = sentSize;
+
+		// 남은 패킷들을 앞으로 당깁니다
+		session->SendGatherCount -= sentCount;
+		if (sentCount > 0 && session->SendGatherCount > 0)
+		{
+			memmove(session->SendGather, session->SendGather + sentCount, sizeof(NetworkMessage *) * session->SendGatherCount);
+		}
+	}
+
+	VOID IOCPServer::ClearSendGather(Session *session)
+	{
+		for (int i = 0; i < session->SendGatherCount; i++)
+		{
+			FreePacket(session->SendGather[i]->packet);
+			messagePool->Free(session->SendGather[i]);
+		}
+		session->SendGatherCount = 0;
+		session->SendGatherOffset = 0;
+
+		NetworkMessage *sendMessage;
+		while ((sendMessage = session->SendQueue.Dequeue()) != nullptr)
+		{
+			FreePacket(sendMessage->packet);
+			messagePool->Free(sendMessage);
+		}
+	}
+
+#ifdef _WIN32
 	VOID IOCPServer::RecvPost(Session *session)
 	{
 		// WSABUF 구조체를 수신 링버퍼의 WriteBuffer와 BeginBuffer를 이용하여 초기화합니다
@@ -396,9 +1058,9 @@ namespace azely
 		// IO Count를 증가시킵니다
 		InterlockedIncrement(&session->ioCount);
 
-		// WSARecv를 호출합니다
+		// WSARecv를 호출합니다 (미러 모드이거나 경계에 걸리지 않는다면 버퍼 하나만 넘깁니다)
 		DWORD flag = 0;
-		int recvResult = WSARecv(session->socket, wsabuf, 2, nullptr, &flag, &session->RecvOverlapped.overlapped, nullptr);
+		int recvResult = WSARecv(session->socket, wsabuf, wsabuf[1].len > 0 ? 2 : 1, nullptr, &flag, &session->RecvOverlapped.overlapped, nullptr);
 		if (recvResult == SOCKET_ERROR)
 		{
 			int errorCode = WSAGetLastError();
@@ -423,16 +1085,39 @@ namespace azely
 		// 만일 Send IO가 이미 진행중이라면 함수를 빠져나갑니다
 		if (InterlockedExchange(&session->ioFlag, true) == true) return;
 
-		// 송신 링버퍼의 보낼 버퍼 크기를 얻어옵니다
-		int sendRingBufferSize = 0;
-		session->SendRingBuffer.LockSRWShared();
-		sendRingBufferSize = session->SendRingBuffer.GetSizeUsed();
-		session->SendRingBuffer.UnlockSRWShared();
+		// WSABUF 구조체를 송신 링버퍼의 보낼 구간, 혹은 송신 큐에서 꺼낸 패킷들로 초기화합니다
+		WSABUF wsabuf[SESSION_SEND_GATHER_MAX];
+		DWORD wsabufCount = 0;
+		int sendSize = 0;
+		if (serverSettings.sendZeroCopy)
+		{
+			sendSize = LoadSendGather(session);
+			for (int i = 0; i < session->SendGatherCount; i++)
+			{
+				SerializedBuffer *packet = session->SendGather[i]->packet;
+				INT32 sentOffset = i == 0 ? session->SendGatherOffset : 0;
+				wsabuf[i].buf = (PCHAR)packet->GetBufferRead() + sentOffset;
+				wsabuf[i].len = packet->GetBufferSizeUsed() - sentOffset;
+			}
+			wsabufCount = session->SendGatherCount;
+		} else
+		{
+			RingBuffer::Reservation readable;
+			sendSize = session->SendRingBuffer.LoadReadable(&readable);
+			wsabuf[0].buf = readable.first;
+			wsabuf[0].len = readable.firstSize;
+			wsabuf[1].buf = readable.second;
+			wsabuf[1].len = readable.secondSize;
+			// 미러 모드이거나 경계에 걸리지 않는다면 버퍼 하나만 넘깁니다
+			wsabufCount = readable.secondSize > 0 ? 2 : 1;
+		}
 
 		// 보낼 데이터가 없다면 함수를 빠져나갑니다
-		if (sendRingBufferSize == 0)
+		// 송신 큐에 넣는 도중이라 꺼내지 못한 패킷이 있다면, 플래그를 내린 뒤 다시 시도합니다
+		if (sendSize == 0)
 		{
 			InterlockedExchange(&session->ioFlag, false);
+			if (serverSettings.sendZeroCopy && !session->SendQueue.IsEmpty()) SendPost(session);
 			return;
 		}
 
@@ -440,19 +1125,11 @@ namespace azely
 		ZeroMemory(&session->SendOverlapped.overlapped, sizeof(OVERLAPPED));
 		session->SendOverlapped.type = OVERLAPPED_EXPAND::TYPE_SEND;
 
-		// WSABUF 구조체를 송신 링버퍼의 ReadBuffer와 BeginBuffer를 이용하여 초기화합니다
-		WSABUF wsabuf[2];
-		wsabuf[0].buf = session->SendRingBuffer.GetReadBuffer();
-		wsabuf[0].len = session->SendRingBuffer.GetSizeDirectDequeueAble();
-		wsabuf[1].buf = session->SendRingBuffer.GetBufferBegin();
-		wsabuf[1].len = session->SendRingBuffer.GetSizeUsed() - session->SendRingBuffer.GetSizeDirectDequeueAble();
-		if (wsabuf[1].len > session->SendRingBuffer.GetSizeTotal()) wsabuf[1].len = 0;
-
 		// IO Count를 증가시킵니다
 		InterlockedIncrement(&session->ioCount);
 
 		// WSASend를 호출합니다
-		int sendResult = WSASend(session->socket, wsabuf, 2, nullptr, 0, &session->SendOverlapped.overlapped, nullptr);
+		int sendResult = WSASend(session->socket, wsabuf, wsabufCount, nullptr, 0, &session->SendOverlapped.overlapped, nullptr);
 		if (sendResult == SOCKET_ERROR)
 		{
 			int errorCode = WSAGetLastError();
@@ -472,170 +1149,438 @@ namespace azely
 		}
 	}
 
-	BOOL IOCPServer::GetAccept(SOCKET *acceptedSocket, sockaddr_in *acceptedAddress)
+	VOID IOCPServer::AcceptPost()
 	{
-		int clientAddressLength = sizeof(*acceptedAddress);
+		// 서버 종료시 취소된 요청이 모두 정리되기를 기다릴 수 있도록, 대기중인 요청 개수를 먼저 증가시킵니다
+		InterlockedIncrement(&acceptPendingCount);
 
-		// accept를 호출합니다
-		SOCKET clientSocket = accept(listenSocket, reinterpret_cast<PSOCKADDR>(acceptedAddress), &clientAddressLength);
-		if (clientSocket == INVALID_SOCKET)
+		while (true)
 		{
-			// accept가 실패한 경우, errorCode가 WSAENOTSOCK, WSAEINVAL, WSAEINTR이라면 예외를 발생시킵니다
+			// listenSocket이 닫혔다면 서버 종료중이므로 더 이상 요청하지 않습니다
+			SOCKET listeningSocket = shards[0].listenSocket;
+			if (listeningSocket == INVALID_SOCKET) break;
+
+			// 접속을 받을 소켓을 미리 생성합니다
+			SOCKET acceptSocket = WSASocketW(AF_INET, SOCK_STREAM, IPPROTO_TCP, nullptr, 0, WSA_FLAG_OVERLAPPED);
+			if (acceptSocket == INVALID_SOCKET)
+			{
+				EXCEPTION(EXCEPTION_SOCKET_CREATE, WSAGetLastError());
+				break;
+			}
+
+			// 세션 테이블에서 샤드를 돌아가며 세션을 미리 할당하여, 접속 완료 통지를 이 세션과 연결합니다
+			Session *session = sessionTable->Alloc(InterlockedIncrement(&acceptShardNext) % serverSettings.shardCount);
+			if (session == nullptr)
+			{
+				EXCEPTION(EXCEPTION_SESSION_CREATE);
+				closesocket(acceptSocket);
+				break;
+			}
+			session->socket = acceptSocket;
+
+			// OVERLAPPED_EXPAND 구조체를 type과 함께 초기화합니다.
+			ZeroMemory(&session->AcceptOverlapped.overlapped, sizeof(OVERLAPPED));
+			session->AcceptOverlapped.type = OVERLAPPED_EXPAND::TYPE_ACCEPT;
+
+			// AcceptEx를 호출합니다, 접속과 함께 데이터를 받지 않도록 수신 길이는 0으로 지정합니다
+			DWORD byteReceived = 0;
+			if (fnAcceptEx(listeningSocket, acceptSocket, session->AcceptAddressBuffer, 0, SESSION_ACCEPT_ADDRESS_LENGTH, SESSION_ACCEPT_ADDRESS_LENGTH, &byteReceived, &session->AcceptOverlapped.overlapped))
+			{
+				return;
+			}
 			int errorCode = WSAGetLastError();
-			if (errorCode == WSAENOTSOCK || errorCode == WSAEINVAL || errorCode == WSAEINTR)
+			if (errorCode == ERROR_IO_PENDING)
 			{
-				// IOCP에게 종료를 알립니다
-				ULONG_PTR completionKey = (ULONG_PTR) 0xffffffff;
-				DWORD byteTransferred = 0;
-				PostQueuedCompletionStatus(handleIOCP, byteTransferred, completionKey, nullptr);
-				return false;
+				return;
 			}
-			EXCEPTION(EXCEPTION_SOCKET_ACCEPT);
-		}
 
-		// acceptedSocket에 accept된 소켓을 대입합니다
-		*acceptedSocket = clientSocket;
+			// IOCP 완료통지가 오지 않을 것이므로, 소켓을 닫고 세션을 반환합니다
+			closesocket(acceptSocket);
+			sessionTable->Free(session);
 
-		return true;
+			// 접속 요청한 클라이언트가 먼저 연결을 끊은 경우라면 다시 요청합니다
+			if (errorCode == WSAECONNRESET) continue;
+
+			// AcceptEx가 실패한 경우, listenSocket이 닫힌 경우(WSAENOTSOCK, WSAEINVAL)가 아니라면 예외를 발생시킵니다
+			if (errorCode != WSAENOTSOCK && errorCode != WSAEINVAL)
+			{
+				EXCEPTION(EXCEPTION_SOCKET_ACCEPT, errorCode);
+			}
+			break;
+		}
+
+		InterlockedDecrement(&acceptPendingCount);
 	}
 
-	BOOL IOCPServer::GetPacketCompleted(Session *session, SerializedBuffer *serializedBuffer, NetworkHeader *header)
+	BOOL IOCPServer::AcceptProc(Session *session, BOOL ioResult)
 	{
-		// 수신 링버퍼의 사용중인 버퍼 크기가 헤더 크기보다 작다면 false를 반환합니다
-		if (session->RecvRingBuffer.GetSizeUsed() < NETWORK_HEADER_SIZE) return false;
+		SOCKET acceptSocket = session->socket;
 
-		// 수신 링버퍼로부터 헤더를 피크합니다
-		int headerPeekedSize = 0;
-		bool headerPeekResult = session->RecvRingBuffer.Peek(reinterpret_cast<PCHAR>(header), NETWORK_HEADER_SIZE, &headerPeekedSize, false);
-		if (!headerPeekResult || headerPeekedSize != NETWORK_HEADER_SIZE)
+		// 걸어둔 AcceptEx 개수가 유지되도록, 완료된 요청을 정리하기 전에 다음 AcceptEx를 먼저 걸어둡니다
+		AcceptPost();
+		InterlockedDecrement(&acceptPendingCount);
+
+		// 수락된 소켓이 listenSocket의 속성을 이어받도록 합니다
+		SOCKET listeningSocket = shards[0].listenSocket;
+		if (ioResult)
 		{
-			EXCEPTION(EXCEPTION_BUFFER_ERROR);
-			return false;
+			ioResult = setsockopt(acceptSocket, SOL_SOCKET, SO_UPDATE_ACCEPT_CONTEXT, reinterpret_cast<PCSTR>(&listeningSocket), sizeof(listeningSocket)) != SOCKET_ERROR;
 		}
-		
-		// 헤더의 secureCode가 NETWORK_SECURE_CODE와 다르다면 세션을 종료합니다
-		if (header->secureCode != NETWORK_SECURE_CODE)
+
+		// 접속이 실패했거나 취소되었다면 소켓을 닫고 세션을 반환합니다
+		if (!ioResult)
 		{
-			DisconnectSession(session->sessionID);
+			closesocket(acceptSocket);
+			sessionTable->Free(session);
 			return false;
 		}
 
-		// 수신 링버퍼의 사용중인 버퍼 크기가 헤더 + 페이로드 크기보다 작다면 false를 반환합니다
-		if (session->RecvRingBuffer.GetSizeUsed() < NETWORK_HEADER_SIZE + header->length)
+		// AcceptEx가 기록한 클라이언트 주소를 얻어옵니다
+		PSOCKADDR localAddress = nullptr;
+		PSOCKADDR remoteAddress = nullptr;
+		INT localAddressLength = 0;
+		INT remoteAddressLength = 0;
+		fnGetAcceptExSockaddrs(session->AcceptAddressBuffer, 0, SESSION_ACCEPT_ADDRESS_LENGTH, SESSION_ACCEPT_ADDRESS_LENGTH, &localAddress, &localAddressLength, &remoteAddress, &remoteAddressLength);
+		SOCKADDR_IN clientAddress;
+		ZeroMemory(&clientAddress, sizeof(SOCKADDR_IN));
+		memcpy(&clientAddress, remoteAddress, min(remoteAddressLength, (INT)sizeof(SOCKADDR_IN)));
+
+		// 접속 허용 여부를 확인하고 세션을 생성합니다
+		return AcceptSession(session, acceptSocket, &clientAddress);
+	}
+#endif
+
+	BOOL IOCPServer::OnRecvMessageInline(DWORD64 sessionID, SerializedBuffer *message)
+	{
+		OnRecvMessage(sessionID, message);
+		return true;
+	}
+
+	BOOL IOCPServer::OnRecvMessage(DWORD64 /*sessionID*/, PacketView & /*message*/)
+	{
+		return false;
+	}
+
+	VOID IOCPServer::OnRecvMessageBatch(const NetworkMessage *messages, INT32 messageCount)
+	{
+		for (INT32 i = 0; i < messageCount; i++)
 		{
-			return false;
+			OnRecvMessage(messages[i].sessionID, messages[i].packet);
 		}
+	}
 
-		// 헤더의 페이로드 길이가 버퍼 크기보다 크다면 세션을 종료합니다
-		if (session->RecvRingBuffer.GetSizeTotal() < NETWORK_HEADER_SIZE + header->length)
+	NetworkMessage *IOCPServer::DispatchRecvPacket(Session *session, SerializedBuffer *packet, SerializedBuffer *inlinePacket)
+	{
+		if (serverSettings.inlineDispatch)
 		{
-			DisconnectSession(session->sessionID);
-			return false;
+			INT32 payloadSize = packet->GetBufferSizeUsed();
+			if (OnRecvMessageInline(session->sessionID, packet))
+			{
+				// 따로 할당한 메시지는 처리가 끝났으니 반환합니다
+				if (packet != inlinePacket) packetPool->Free(packet);
+				return nullptr;
+			}
+
+			// 처리하지 않은 메시지는 읽은 위치를 되돌려 PacketThread에 넘기며, 인라인 버퍼라면 크기에 맞는 패킷으로 복사합니다
+			if (packet == inlinePacket)
+			{
+				packet = packetPool->Alloc(payloadSize);
+				packet->Clear(false);
+				packet->PutData(inlinePacket->GetBufferWrite() - payloadSize, payloadSize);
+			} else
+			{
+				packet->read = packet->write - payloadSize;
+			}
 		}
 
-		// 수신 링버퍼에서 헤더 크기만큼 읽기 인덱스를 이동시킵니다
-		bool headerMoveResult = session->RecvRingBuffer.MoveReadBuffer(headerPeekedSize);
-		if (!headerMoveResult)
+		// 메시지 풀에서 메시지를 할당합니다
+		NetworkMessage *newMessage = messagePool->Alloc();
+		newMessage->sessionID = session->sessionID;
+		newMessage->packet = packet;
+		return newMessage;
+	}
+
+	BOOL IOCPServer::DispatchPacketView(Session *session)
+	{
+		// 암호화된 세션이나 모으던 큰 메시지가 있다면 링버퍼 안의 데이터를 그대로 넘길 수 없습니다
+		if (session->RecvLargePacket != nullptr || session->Cipher.IsEnabled()) return false;
+
+		RingBuffer &recvRingBuffer = session->RecvRingBuffer;
+		int usedSize = recvRingBuffer.GetSizeUsed();
+		if (usedSize < NETWORK_HEADER_SIZE_MIN) return false;
+
+		// 수신 링버퍼로부터 헤더가 될 수 있는 만큼 피크하여 헤더를 해석합니다
+		UCHAR headerBuffer[NETWORK_HEADER_SIZE_MAX];
+		int headerPeekSize = usedSize < NETWORK_HEADER_SIZE_MAX ? usedSize : NETWORK_HEADER_SIZE_MAX;
+		int headerPeekedSize = 0;
+		if (!recvRingBuffer.Peek(reinterpret_cast<PCHAR>(headerBuffer), headerPeekSize, &headerPeekedSize, false)) return false;
+
+		// 헤더가 잘못되었거나 메시지가 다 오지 않았다면 GetPacketCompleted에 맡깁니다
+		NetworkHeader header;
+		INT32 headerSize = DecodeNetworkHeader(headerBuffer, headerPeekedSize, &header);
+		if (headerSize <= 0 || header.length > static_cast<UINT32>(serverSettings.messageSizeMax)) return false;
+		INT32 frameSize = headerSize + static_cast<INT32>(header.length);
+		if (usedSize < frameSize) return false;
+
+		// 메시지가 링버퍼 안에서 끊기지 않았다면 직접 가리키고, 끊겼다면 WorkerThread마다 둔 버퍼에 복사합니다
+		const UCHAR *payload;
+		if (recvRingBuffer.GetSizeDirectDequeueAble() >= frameSize)
 		{
-			EXCEPTION(EXCEPTION_BUFFER_ERROR);
-			return false;
+			payload = reinterpret_cast<const UCHAR *>(recvRingBuffer.GetReadBuffer()) + headerSize;
+		} else
+		{
+			static thread_local vector<UCHAR> wrappedFrame;
+			wrappedFrame.resize(frameSize);
+			int framePeekedSize = 0;
+			if (!recvRingBuffer.Peek(reinterpret_cast<PCHAR>(wrappedFrame.data()), frameSize, &framePeekedSize, false)) return false;
+			payload = wrappedFrame.data() + headerSize;
 		}
 
-		// 패킷 버퍼에 헤더를 인큐합니다
-#ifdef _SIMPLE_HEADER
-		*serializedBuffer << header->secureCode << header->length;
-#else
-		*serializedBuffer << header->secureCode << header->length << header->checksum;
+#ifndef _SIMPLE_HEADER
+		// 체크섬이 틀렸다면 GetPacketCompleted에서 다시 검증하여 세션을 종료합니다
+		if (NETWORK_CHECKSUM(payload, header.length) != header.checksum) return false;
 #endif
 
-		// 수신 링버퍼로부터 페이로드를 피크합니다
-		int bodyPeekedSize = 0;
-		bool bodyPeekResult = session->RecvRingBuffer.Peek((PCHAR)serializedBuffer->GetBufferWrite(), header->length, &bodyPeekedSize, false);
-		if (!bodyPeekResult || bodyPeekedSize != header->length)
+		PacketView view(payload, static_cast<INT32>(header.length));
+		if (!OnRecvMessage(session->sessionID, view)) return false;
+
+		// 처리가 끝났으니 링버퍼의 읽기 위치를 메시지만큼 이동시킵니다
+		recvRingBuffer.MoveReadBuffer(frameSize);
+		return true;
+	}
+
+	SerializedBuffer *IOCPServer::GetPacketCompleted(Session *session, SerializedBuffer *serializedBuffer)
+	{
+		// 모으던 큰 메시지가 없다면 새 메시지의 헤더를 확인합니다
+		if (session->RecvLargePacket == nullptr)
 		{
-			EXCEPTION(EXCEPTION_BUFFER_ERROR);
-			return false;
+			// 수신 링버퍼의 사용중인 버퍼 크기가 최소 헤더 크기보다 작다면 nullptr를 반환합니다
+			int usedSize = session->RecvRingBuffer.GetSizeUsed();
+			if (usedSize < NETWORK_HEADER_SIZE_MIN) return nullptr;
+
+			// 수신 링버퍼로부터 헤더가 될 수 있는 만큼 피크하여 헤더를 해석합니다
+			UCHAR headerBuffer[NETWORK_HEADER_SIZE_MAX];
+			int headerPeekSize = usedSize < NETWORK_HEADER_SIZE_MAX ? usedSize : NETWORK_HEADER_SIZE_MAX;
+			int headerPeekedSize = 0;
+			bool headerPeekResult = session->RecvRingBuffer.Peek(reinterpret_cast<PCHAR>(headerBuffer), headerPeekSize, &headerPeekedSize, false);
+			if (!headerPeekResult || headerPeekedSize != headerPeekSize)
+			{
+				EXCEPTION(EXCEPTION_BUFFER_ERROR);
+				return nullptr;
+			}
+
+			// 헤더가 아직 다 오지 않았다면 nullptr를 반환합니다
+			NetworkHeader header;
+			INT32 headerSize = DecodeNetworkHeader(headerBuffer, headerPeekedSize, &header);
+			if (headerSize == 0) return nullptr;
+
+			// 헤더의 secureCode나 길이 필드가 잘못되었거나, 페이로드 길이가 messageSizeMax보다 크다면 페이로드를 받기 전에 세션을 종료합니다
+			if (headerSize < 0 || header.length > static_cast<UINT32>(serverSettings.messageSizeMax))
+			{
+				DisconnectSession(session->sessionID);
+				return nullptr;
+			}
+
+			// 패킷 버퍼(없다면 기본 패킷 크기)에 들어가지 않는 큰 메시지라면, 헤더를 소비하고 크기에 맞는 패킷을 할당하여 모으기 시작합니다
+			INT32 packetSizeFree = serializedBuffer != nullptr ? serializedBuffer->GetBufferSizeFree() : SerializedBuffer::BUFFER_SIZE_DEFAULT;
+			if (header.length > static_cast<UINT32>(packetSizeFree))
+			{
+				session->RecvRingBuffer.MoveReadBuffer(headerSize);
+				session->RecvLargePacket = packetPool->Alloc(header.length);
+				session->RecvLargePacket->Clear(false);
+				session->RecvLargeHeader = header;
+				session->RecvLargeRemain = header.length;
+			} else
+			{
+				// 수신 링버퍼의 사용중인 버퍼 크기가 헤더 + 페이로드 크기보다 작다면 nullptr를 반환합니다
+				if (usedSize < headerSize + static_cast<INT32>(header.length)) return nullptr;
+
+				// 패킷 버퍼가 없다면 페이로드 크기에 맞는 등급의 패킷을 할당합니다
+				SerializedBuffer *packet = serializedBuffer;
+				if (packet == nullptr)
+				{
+					packet = packetPool->Alloc(header.length);
+					packet->Clear(false);
+				}
+
+				// 수신 링버퍼에서 헤더를 건너뛰고, 페이로드를 패킷 버퍼로 디큐합니다
+				session->RecvRingBuffer.MoveReadBuffer(headerSize);
+				int bodyDequeuedSize = 0;
+				bool bodyDequeueResult = session->RecvRingBuffer.Dequeue((PCHAR)packet->GetBufferWrite(), static_cast<INT32>(header.length), &bodyDequeuedSize, false);
+				if (!bodyDequeueResult || bodyDequeuedSize != static_cast<INT32>(header.length))
+				{
+					EXCEPTION(EXCEPTION_BUFFER_ERROR);
+					if (packet != serializedBuffer) packetPool->Free(packet);
+					return nullptr;
+				}
+
+				// 패킷 버퍼의 쓰기 인덱스를 페이로드 크기만큼 이동시킵니다
+				int sbBodyMovedSize = 0;
+				bool sbBodyMoveResult = packet->MoveWritePointer(bodyDequeuedSize, &sbBodyMovedSize);
+				if (!sbBodyMoveResult || sbBodyMovedSize != bodyDequeuedSize)
+				{
+					EXCEPTION(EXCEPTION_BUFFER_ERROR);
+					if (packet != serializedBuffer) packetPool->Free(packet);
+					return nullptr;
+				}
+
+#ifndef _SIMPLE_HEADER
+				// 체크섬을 검증합니다
+				if (!packet->VerifyChecksum(header.checksum))
+				{
+					if (packet != serializedBuffer) packetPool->Free(packet);
+					DisconnectSession(session->sessionID);
+					return nullptr;
+				}
+#endif
+
+				// 암호화된 세션이라면 복호화하며, 인증에 실패했다면 세션을 종료합니다
+				if (session->Cipher.IsEnabled() && !OpenPacket(session, packet))
+				{
+					if (packet != serializedBuffer) packetPool->Free(packet);
+					DisconnectSession(session->sessionID);
+					return nullptr;
+				}
+
+				return packet;
+			}
 		}
 
-		// 패킷 버퍼의 쓰기 인덱스를 페이로드 크기만큼 이동시킵니다
-		int sbHeadMovedSize = 0;
-		bool sbHeadMoveResult = serializedBuffer->MoveWritePointer(bodyPeekedSize, &sbHeadMovedSize);
-		if (!sbHeadMoveResult || sbHeadMovedSize != bodyPeekedSize)
+		// 모으던 큰 메시지에 수신 링버퍼의 데이터를 받은 만큼 옮깁니다
+		SerializedBuffer *largePacket = session->RecvLargePacket;
+		int largeDequeuedSize = 0;
+		session->RecvRingBuffer.Dequeue((PCHAR)largePacket->GetBufferWrite(), session->RecvLargeRemain, &largeDequeuedSize, true);
+		if (largeDequeuedSize > 0)
 		{
-			EXCEPTION(EXCEPTION_BUFFER_ERROR);
-			return false;
+			int largeMovedSize = 0;
+			largePacket->MoveWritePointer(largeDequeuedSize, &largeMovedSize);
+			session->RecvLargeRemain -= largeDequeuedSize;
 		}
 
+		// 아직 다 받지 못했다면 nullptr를 반환합니다
+		if (session->RecvLargeRemain > 0) return nullptr;
+		session->RecvLargePacket = nullptr;
+
 #ifndef _SIMPLE_HEADER
 		// 체크섬을 검증합니다
-		if (!serializedBuffer->VerifyChecksum(header->checksum))
+		if (!largePacket->VerifyChecksum(session->RecvLargeHeader.checksum))
 		{
+			packetPool->Free(largePacket);
 			DisconnectSession(session->sessionID);
-			return false;
+			return nullptr;
 		}
 #endif
 
-		// 수신 링버퍼에서 페이로드 크기만큼 읽기 인덱스를 이동시킵니다
-		bool bodyMoveResult = session->RecvRingBuffer.MoveReadBuffer(bodyPeekedSize);
-		if (!bodyMoveResult)
+		// 암호화된 세션이라면 복호화하며, 인증에 실패했다면 세션을 종료합니다
+		if (session->Cipher.IsEnabled() && !OpenPacket(session, largePacket))
 		{
-			EXCEPTION(EXCEPTION_BUFFER_ERROR);
-			return false;
+			packetPool->Free(largePacket);
+			DisconnectSession(session->sessionID);
+			return nullptr;
 		}
 
-		// 패킷 버퍼의 읽기 인덱스를 페이로드 크기만큼 이동시킵니다
-		int sbBodyMovedSize = 0;
-		bool sbBodyMoveResult = serializedBuffer->MoveReadPointer(NETWORK_HEADER_SIZE, &sbBodyMovedSize);
-		if (!sbBodyMoveResult || sbBodyMovedSize != NETWORK_HEADER_SIZE)
+		return largePacket;
+	}
+
+	BOOL IOCPServer::OpenPacket(Session *session, SerializedBuffer *packet)
+	{
+		// 인증 태그보다 짧은 메시지는 인증에 실패한 것으로 봅니다
+		INT32 sealedSize = packet->GetBufferSizeUsed() - SessionCipher::TAG_SIZE;
+		if (sealedSize < 0) return false;
+
+		// 페이로드를 제자리에서 복호화하고, 쓰기 위치를 인증 태그 앞으로 되돌립니다
+		if (!session->Cipher.Open(packet->read, sealedSize, packet->read + sealedSize)) return false;
+		packet->write -= SessionCipher::TAG_SIZE;
+		return true;
+	}
+
+	BOOL IOCPServer::AcceptSession(Session *session, SOCKET socket, SOCKADDR_IN *socketAddress)
+	{
+		// 접속한 소켓의 주소를 세션에 한 번만 가공해두고, 접속 요청과 접속 완료 통지에 함께 사용합니다
+		WSANtohl(socket, socketAddress->sin_addr.s_addr, &session->socketAddressIP);
+		WSANtohs(socket, socketAddress->sin_port, &session->socketAddressPort);
+		ZeroMemory(session->socketAddressString, SESSION_ADDRESS_WCHAR_LENGTH * sizeof(WCHAR));
+		DWORD stringSize = SESSION_ADDRESS_WCHAR_LENGTH;
+		WSAAddressToStringW(reinterpret_cast<LPSOCKADDR>(socketAddress), sizeof(SOCKADDR_IN), 0, session->socketAddressString, &stringSize);
+
+		// 접속을 요청하는 소켓의 주소를 알려주어 허용 여부를 판단하고, 허용되었다면 세션을 생성합니다
+		BOOL isAccepted = OnSessionConnectionRequest(session->socketAddressIP, session->socketAddressPort, session->socketAddressString);
+		if (isAccepted && CreateSession(session, socket) == nullptr)
+		{
+			EXCEPTION(EXCEPTION_SESSION_CREATE);
+			isAccepted = false;
+		}
+
+		// 세션을 생성하지 않았다면 소켓을 닫고 세션을 세션 테이블에 반환합니다
+		if (!isAccepted)
 		{
-			EXCEPTION(EXCEPTION_BUFFER_ERROR);
+			closesocket(socket);
+			sessionTable->Free(session);
 			return false;
 		}
 
 		return true;
 	}
 
-	Session *IOCPServer::CreateSession(SOCKET socket, DWORD64 sessionID, SOCKADDR_IN socketAddress)
+	VOID IOCPServer::ConnectSessions(Session **sessions, INT32 sessionCount)
 	{
-		// 세션 풀의 사용중인 세션 개수가 서버 설정의 최대 세션 개수보다 크다면 nullptr을 반환합니다
-		int sessionCount = 0;
-		AcquireSRWLockShared(&sessionMapSRW);
-		sessionCount = sessionMap.size();
-		ReleaseSRWLockShared(&sessionMapSRW);
-		if (sessionCount > serverSettings.sessionCountMax)
+		for (int i = 0; i < sessionCount; i++)
 		{
-			return nullptr;
+			Session *session = sessions[i];
+
+			// 접속한 클라이언트의 세션 생성을 OnSessionConnected로 알립니다
+			OnSessionConnected(session->sessionID, session->socketAddressIP, session->socketAddressPort, session->socketAddressString);
+
+			// 새로운 세션에 수신을 요청합니다
+			RecvPost(session);
+
+			// 세션의 IO Count를 감소시키고, 만일 IO Count가 0이라면 세션을 종료합니다
+			if (InterlockedDecrement(&session->ioCount) == 0)
+			{
+				RemoveSession(session);
+			}
 		}
 
-		// 세션 풀에서 세션을 할당합니다
-		AcquireSRWLockExclusive(&sessionPoolSRW);
-		Session *session = sessionPool->Alloc();
-		ReleaseSRWLockExclusive(&sessionPoolSRW);
+		// 세션 생성 통계를 증가시킵니다
+		InterlockedExchangeAdd(&sessionAccepted, sessionCount);
+		InterlockedExchangeAdd(&acceptPerSecondCounter, sessionCount);
+		InterlockedIncrement(&acceptBatchPerSecondCounter);
+	}
 
-		// 세션을 초기화합니다
-		WSANtohl(socket, socketAddress.sin_addr.S_un.S_addr, &session->socketAddressIP);
-		WSANtohs(socket, socketAddress.sin_port, &session->socketAddressPort);
-		ZeroMemory(session->socketAddressString, SESSION_ADDRESS_WCHAR_LENGTH * sizeof(WCHAR));
-		DWORD stringSize = 0;
-		WSAAddressToStringW(reinterpret_cast<LPSOCKADDR>(&socketAddress), sizeof(socketAddress), 0, session->socketAddressString, &stringSize);
+	Session *IOCPServer::CreateSession(Session *session, SOCKET socket)
+	{
+		// 사용중인 세션 개수가 서버 설정의 최대 세션 개수보다 크다면 nullptr을 반환합니다
+		if (this->sessionCount > (DWORD64)serverSettings.sessionCountMax)
+		{
+			return nullptr;
+		}
+
+		// 세션을 초기화합니다 (세션 ID는 세션 테이블에서, 주소는 AcceptSession에서 채워져 있습니다)
 		session->RecvOverlapped.type = OVERLAPPED_EXPAND::TYPE_RECV;
 		session->SendOverlapped.type = OVERLAPPED_EXPAND::TYPE_SEND;
+#ifndef _WIN32
+		session->RecvOverlapped.readiness = 0;
+		session->SendOverlapped.readiness = 0;
+#endif
 		session->TimeoutTime = timeGetTime() + serverSettings.sessionTimeout;
 		session->RecvRingBuffer.Clear();
 		session->SendRingBuffer.Clear();
-		session->sessionID = sessionID;
 
+		// IO Count 맨 앞 비트를 내려 세션을 유효하게 합니다
 		InterlockedIncrement(&session->ioCount);
 		InterlockedAnd((PLONG)&session->ioCount, 0x7fffffff);
 		InterlockedExchange((PULONG64)&session->socket, socket);
 		InterlockedExchange(&session->ioFlag, false);
 		InterlockedIncrement(&this->sessionCount);
-		CreateIoCompletionPort((HANDLE)socket, handleIOCP, session->sessionID, 0);
+#ifdef _WIN32
+		CreateIoCompletionPort((HANDLE)socket, GetShard(session->sessionID)->handleIOCP, session->sessionID, 0);
+#endif
 
-		// 세션을 세션 맵에 추가합니다
-		AcquireSRWLockExclusive(&sessionMapSRW);
-		sessionMap.emplace(session->sessionID, session);
-		ReleaseSRWLockExclusive(&sessionMapSRW);
+		// 세션의 슬롯을 타이머 휠에 겁니다
+		// 이전 세대의 세션으로 이미 걸려있다면, 그 만료 시점에 유효해진 이 세션의 TimeoutTime으로 다시 걸립니다
+		AcquireSRWLockExclusive(&timerWheelSRW);
+		timerWheel->Schedule(sessionTable->GetSlotIndex(session->sessionID), session->TimeoutTime);
+		ReleaseSRWLockExclusive(&timerWheelSRW);
 
 		return session;
 	}
@@ -653,28 +1598,42 @@ namespace azely
 		DWORD64 sessionID = session->sessionID;
 		closesocket(session->socket);
 
-		// 세션의 송신 링버퍼를 초기화합니다
+		// 세션의 송신 링버퍼와 송신 큐를 초기화합니다
 		session->SendRingBuffer.LockSRWExclusive();
 		session->SendRingBuffer.Clear();
 		session->SendRingBuffer.UnlockSRWExclusive();
+		ClearSendGather(session);
+
+		// 모으던 큰 메시지가 있다면 반환합니다
+		if (session->RecvLargePacket != nullptr)
+		{
+			packetPool->Free(session->RecvLargePacket);
+			session->RecvLargePacket = nullptr;
+			session->RecvLargeRemain = 0;
+		}
+
+		// 세션의 메시지 암호화를 끄고 키를 지웁니다
+		session->Cipher.Release();
+
+		// 세션이 들어가 있던 모든 그룹에서 뺍니다
+		AcquireSRWLockExclusive(&groupTableSRW);
+		groupTable->LeaveAll(sessionID);
+		ReleaseSRWLockExclusive(&groupTableSRW);
 
 		InterlockedExchange(&session->ioFlag, false);
 		InterlockedDecrement(&this->sessionCount);
 		InterlockedIncrement(&sessionReleased);
 
-		// 세션을 세션 맵에서 제거합니다
-		AcquireSRWLockExclusive(&sessionMapSRW);
-		auto sessionFoundIterator = sessionMap.find(session->sessionID);
-		if (sessionFoundIterator != sessionMap.end()) sessionMap.erase(sessionFoundIterator);
-		ReleaseSRWLockExclusive(&sessionMapSRW);
-
-		// 세션을 세션 풀에 반환합니다
-		AcquireSRWLockExclusive(&sessionPoolSRW);
-		sessionPool->Free(session);
-		ReleaseSRWLockExclusive(&sessionPoolSRW);
+		// 세션을 세션 테이블에 반환합니다
+		ServerShard *shard = GetShard(sessionID);
+		sessionTable->Free(session);
 
 		// IOCP에 세션 제거를 알립니다
-		PostQueuedCompletionStatus(handleIOCP, 0, sessionID, (LPOVERLAPPED)0xffffffff);
+#ifdef _WIN32
+		PostQueuedCompletionStatus(shard->handleIOCP, 0, sessionID, (LPOVERLAPPED)0xffffffff);
+#else
+		PostNotify(shard, sessionID);
+#endif
 	}
 
 	Session *IOCPServer::AcquireSession(DWORD64 sessionID)
@@ -687,14 +1646,19 @@ namespace azely
 			return nullptr;
 		}
 
-		if (session->sessionID != sessionID)
+		// 세션의 IO Count 맨 앞 비트가 1이라면 세션이 유효하지 않습니다
+		if ((InterlockedIncrement(&session->ioCount) & 0x80000000) != 0)
 		{
-			EXCEPTION(EXCEPTION_SESSION_CORRUPTED);
+			if (InterlockedDecrement(&session->ioCount) == 0)
+			{
+				RemoveSession(session);
+			}
 			return nullptr;
 		}
 
-		// 세션의 IO Count 맨 앞 비트가 1이라면 세션이 유효하지 않습니다
-		if ((InterlockedIncrement(&session->ioCount) & 0x80000000) != 0)
+		// 찾은 뒤 IO Count를 올리기 전에 슬롯이 정리되어 재사용되었을 수 있으므로, 세대까지 포함한 세션 ID를 다시 확인합니다
+		// IO Count를 올린 뒤에는 슬롯이 정리되지 않습니다
+		if (session->sessionID != sessionID)
 		{
 			if (InterlockedDecrement(&session->ioCount) == 0)
 			{
@@ -717,14 +1681,8 @@ namespace azely
 
 	Session *IOCPServer::FindSession(DWORD64 sessionID)
 	{
-		// 세션을 찾습니다
-		Session *session = nullptr;
-		AcquireSRWLockShared(&sessionMapSRW);
-		auto sessionFoundIterator = sessionMap.find(sessionID);
-		if (sessionFoundIterator != sessionMap.end()) session = sessionFoundIterator->second;
-		ReleaseSRWLockShared(&sessionMapSRW);
-
-		return session;
+		// 세션 테이블에서 잠금 없이 슬롯과 세대로 세션을 찾습니다
+		return sessionTable->Find(sessionID);
 	}
 
 	BOOL IOCPServer::GetServerMonitoringInfo(ServerMonitoringInfo *serverMonitoringInfo)
@@ -738,224 +1696,240 @@ namespace azely
 		serverMonitoringInfo->recvMessagePerSecond = InterlockedExchange(&this->recvMessagePerSecondCounter, 0);
 		serverMonitoringInfo->sendMessagePerSecond = InterlockedExchange(&this->sendMessagePerSecondCounter, 0);
 		serverMonitoringInfo->acceptPerSecond = InterlockedExchange(&this->acceptPerSecondCounter, 0);
-		serverMonitoringInfo->framePerSecondAccept = InterlockedExchange(&this->framePerSecondAcceptCounter, 0);
-		serverMonitoringInfo->framePerSecondPacket = InterlockedExchange(&this->framePerSecondPacketCounter, 0);
+		serverMonitoringInfo->acceptBatchPerSecond = InterlockedExchange(&this->acceptBatchPerSecondCounter, 0);
+		serverMonitoringInfo->framePerSecondPacket = 0;
+		serverMonitoringInfo->logicThreadCount = serverSettings.logicThreadCount;
+		for (int i = 0; i < serverSettings.logicThreadCount; i++)
+		{
+			// 넣는 쪽은 메시지를 넣은 뒤에 큐 길이를 올리므로, 잠시 음수로 보일 수 있어 0으로 맞춥니다
+			LONG queueDepth = logicThreads[i].queueDepth;
+			serverMonitoringInfo->logicQueueDepth[i] = queueDepth < 0 ? 0 : queueDepth;
+			serverMonitoringInfo->logicFramePerSecond[i] = InterlockedExchange(&logicThreads[i].framePerSecondCounter, 0);
+			serverMonitoringInfo->framePerSecondPacket += serverMonitoringInfo->logicFramePerSecond[i];
+		}
 		serverMonitoringInfo->messagePoolSize = messagePool->GetCountPool();
 		serverMonitoringInfo->messagePoolUsed = messagePool->GetCountUse();
-		serverMonitoringInfo->sessionPoolSize = sessionPool->GetCountPool();
-		serverMonitoringInfo->sessionPoolUsed = sessionPool->GetCountUse();
+		serverMonitoringInfo->sessionPoolSize = sessionTable->GetCapacity();
+		serverMonitoringInfo->sessionPoolUsed = sessionTable->GetCountUse();
 		serverMonitoringInfo->packetPoolSize = packetPool->GetCountPool();
 		serverMonitoringInfo->packetPoolUsed = packetPool->GetCountUse();
 
 		return true;
 	}
 	
+#ifdef _WIN32
 	UINT WINAPI	IOCPServer::WorkerThread(PVOID param)
 	{
+		ServerShard *shard = (ServerShard *)param;
+		OVERLAPPED_ENTRY entries[COMPLETION_ENTRY_MAX];
+		Session *acceptedSessions[COMPLETION_ENTRY_MAX];
+		INT32 acceptedCount = 0;
+		ULONG entryCount = 0;
 		DWORD byteTransferred = 0;
 		ULONG_PTR completionKey = 0;
 		OVERLAPPED *overlapped = nullptr;
 		OVERLAPPED_EXPAND *overlappedExpand = nullptr;
 		DWORD64 sessionID = 0;
 		Session *session = nullptr;
-		INT32 gqcsResult = 0;
+		BOOL ioResult = false;
+		BOOL isFinished = false;
 
-		while (true)
+		while (!isFinished)
 		{
-			// GetQueuedCompletionStatus를 호출하기 전 인자를 초기화합니다
-			byteTransferred = 0;
-			completionKey = 0;
-			overlapped = nullptr;
-			overlappedExpand = nullptr;
-			session = nullptr;
-
-			// IOCP 완료 통지를 대기합니다
-			gqcsResult = GetQueuedCompletionStatus(handleIOCP, &byteTransferred, &completionKey, &overlapped, INFINITE);
-			if (overlapped == nullptr)
-			{
-				// 만일 completionKey가 0xffffffff라면 IOCP 종료를 의미합니다
-				if (completionKey == 0xffffffff)
-				{
-					ULONG_PTR finishKey = 0xffffffff;
-					DWORD finishTransferred = 0;
-					PostQueuedCompletionStatus(handleIOCP, finishTransferred, finishKey, nullptr);
-					return 0;
-				}
-				if (completionKey == 0)
-				{
-					int errorCode = WSAGetLastError();
-					EXCEPTION(EXCEPTION_IOCP, errorCode);
-				} else
-				{
-					EXCEPTION(EXCEPTION_IOCP);
-				}
-				continue;
-			}
-			// 만일 overlapped가 0xffffffff라면 세션 종료를 의미합니다
-			if (overlapped == (LPOVERLAPPED)0xffffffff)
+			// IOCP 완료 통지를 한 번의 호출로 최대 COMPLETION_ENTRY_MAX개까지 대기합니다
+			entryCount = 0;
+			if (!GetQueuedCompletionStatusEx(shard->handleIOCP, entries, COMPLETION_ENTRY_MAX, &entryCount, INFINITE, false))
 			{
-				OnSessionDisconnected(completionKey);
+				int errorCode = GetLastError();
+				EXCEPTION(EXCEPTION_IOCP, errorCode);
 				continue;
 			}
 
-			overlappedExpand = (OVERLAPPED_EXPAND *)overlapped;
-
-			// IOCP 완료 통지를 받은 세션을 찾습니다
-			sessionID = completionKey;
-			session = FindSession(sessionID);
-
-			if (session == nullptr)
+			for (ULONG i = 0; i < entryCount; i++)
 			{
-				EXCEPTION(EXCEPTION_SESSION_NOT_FOUND);
-				continue;
-			}
+				byteTransferred = entries[i].dwNumberOfBytesTransferred;
+				completionKey = entries[i].lpCompletionKey;
+				overlapped = entries[i].lpOverlapped;
 
-			// GetQueuedCompletionStatus 함수의 결과가 True이고, 바이트 전송량이 0이 아니라면 성공적으로 IOCP 완료 통지를 받았습니다
-			if (gqcsResult != 0 && byteTransferred != 0)
-			{
-				// IOCP 완료 통지를 받은 작업의 종류에 따라 처리합니다
-				switch (overlappedExpand->type)
+				if (overlapped == nullptr)
 				{
-					case OVERLAPPED_EXPAND::TYPE_RECV:
+					// 만일 completionKey가 0xffffffff라면 IOCP 종료를 의미합니다
+					// 함께 꺼낸 완료 통지는 모두 처리한 뒤 종료합니다
+					if (completionKey == 0xffffffff)
 					{
-						RecvProc(session, byteTransferred);
+						ULONG_PTR finishKey = 0xffffffff;
+						DWORD finishTransferred = 0;
+						PostQueuedCompletionStatus(shard->handleIOCP, finishTransferred, finishKey, nullptr);
+						isFinished = true;
+						continue;
 					}
-					break;
-					case OVERLAPPED_EXPAND::TYPE_SEND:
-					{
-						SendProc(session, byteTransferred);
-					}
-					break;
+					EXCEPTION(EXCEPTION_IOCP);
+					continue;
+				}
+				// 만일 overlapped가 0xffffffff라면 세션 종료를 의미합니다
+				if (overlapped == (LPOVERLAPPED)0xffffffff)
+				{
+					OnSessionDisconnected(completionKey);
+					continue;
 				}
-			}
-
-			// 세션의 IO Count를 감소시키고, 만일 IO Count가 0이라면 세션을 종료합니다
-			if (InterlockedDecrement(&session->ioCount) == 0)
-			{
-				RemoveSession(session);
-			}
-
-		}
 
-		return -1;
-	}
+				overlappedExpand = (OVERLAPPED_EXPAND *)overlapped;
 
-	UINT WINAPI IOCPServer::AcceptThread(PVOID param)
-	{
-		DWORD64 sessionID = 0;
-		SOCKET clientSocket;
-		SOCKADDR_IN clientAddress;
+				// listenSocket의 완료 통지라면 AcceptEx를 걸어두었던 세션의 접속을 처리하고, 수신 시작은 묶어서 처리합니다
+				if (completionKey == ACCEPT_COMPLETION_KEY)
+				{
+					session = CONTAINING_RECORD(overlappedExpand, Session, AcceptOverlapped);
+					if (AcceptProc(session, static_cast<LONG>(overlapped->Internal) >= 0))
+					{
+						acceptedSessions[acceptedCount++] = session;
+					}
+					continue;
+				}
 
-		while (true)
-		{
-			clientSocket = INVALID_SOCKET;
+				// IOCP 완료 통지를 받은 세션을 찾습니다
+				sessionID = completionKey;
+				session = FindSession(sessionID);
 
-			// 클라이언트의 접속을 대기합니다
-			// 만일 GetAccept 함수가 false를 반환하면 스레드를 종료합니다
-			if (!GetAccept(&clientSocket, &clientAddress)) return 0;
+				if (session == nullptr)
+				{
+					EXCEPTION(EXCEPTION_SESSION_NOT_FOUND);
+					continue;
+				}
 
-			// 접속한 소켓의 주소를 가공합니다
-			WCHAR clientAddressString[SESSION_ADDRESS_WCHAR_LENGTH];
-			ZeroMemory(clientAddressString, SESSION_ADDRESS_WCHAR_LENGTH * sizeof(WCHAR));
-			DWORD clientAddressLength = 0;
-			WSAAddressToStringW(reinterpret_cast<LPSOCKADDR>(&clientAddress), sizeof(clientAddress), 0, clientAddressString, &clientAddressLength);
-			DWORD clientAddressIP;
-			WSANtohl(clientSocket, clientAddress.sin_addr.S_un.S_addr, &clientAddressIP);
-			USHORT clientAddressPort;
-			WSANtohs(clientSocket, clientAddress.sin_port, &clientAddressPort);
+				// 각 IO의 성공 여부는 OVERLAPPED의 Internal에 NTSTATUS로 담겨 있습니다 (음수라면 실패)
+				ioResult = static_cast<LONG>(overlapped->Internal) >= 0;
 
-			// 접속을 요청하는 소켓의 주소를 알려주어 허용 여부를 판단합니다
-			if (!OnSessionConnectionRequest(clientAddressIP, clientAddressPort, clientAddressString))
-			{
-				closesocket(clientSocket);
-				continue;
-			}
+				// IO가 성공했고, 바이트 전송량이 0이 아니라면 성공적으로 IOCP 완료 통지를 받았습니다
+				if (ioResult && byteTransferred != 0)
+				{
+					// IOCP 완료 통지를 받은 작업의 종류에 따라 처리합니다
+					switch (overlappedExpand->type)
+					{
+						case OVERLAPPED_EXPAND::TYPE_RECV:
+						{
+							RecvProc(session, byteTransferred);
+						}
+						break;
+						case OVERLAPPED_EXPAND::TYPE_SEND:
+						{
+							SendProc(session, byteTransferred);
+						}
+						break;
+					}
+				}
 
-			// 접속한 클라이언트의 세션을 생성합니다
-			Session *session = CreateSession(clientSocket, ++sessionNextID, clientAddress);
-			if (session == nullptr)
-			{
-				EXCEPTION(EXCEPTION_SESSION_CREATE);
-				closesocket(clientSocket);
-				continue;
+				// 세션의 IO Count를 감소시키고, 만일 IO Count가 0이라면 세션을 종료합니다
+				if (InterlockedDecrement(&session->ioCount) == 0)
+				{
+					RemoveSession(session);
+				}
 			}
 
-			// 접속한 클라이언트의 세션 생성을 OnSessionConnected로 알립니다
-			OnSessionConnected(session->sessionID, session->socketAddressIP, session->socketAddressPort, session->socketAddressString);
-
-			// 새로운 세션에 WSARecv를 요청합니다
-			RecvPost(session);
-
-			// 세션의 IO Count를 감소시키고, 만일 IO Count가 0이라면 세션을 종료합니다
-			if (InterlockedDecrement(&session->ioCount) == 0)
+			// 이번에 꺼낸 완료 통지에서 수락된 세션들을 알리고 수신을 시작시킵니다
+			if (acceptedCount > 0)
 			{
-				RemoveSession(session);
+				ConnectSessions(acceptedSessions, acceptedCount);
+				acceptedCount = 0;
 			}
-
-			// 세션 생성 통계를 증가시킵니다
-			InterlockedIncrement(&sessionAccepted);
-			InterlockedIncrement(&acceptPerSecondCounter);
 		}
 
-		return -1;
+		return 0;
 	}
+#endif
 
 	UINT WINAPI IOCPServer::PacketThread(PVOID param)
 	{
+		LogicThread *logicThread = (LogicThread *)param;
+
 		// 서버 상태가 STOP이 아닌 동안 반복합니다
 		while (serverStatus != STATUS_STOP)
 		{
-			// 패킷 큐를 교체합니다
-			messageQueue.SwapQueue(currentQueue);
-
-			// 패킷 큐에 들어있는 패킷을 처리합니다
-			while (!currentQueue->empty())
+			// 메시지 큐에 들어있는 메시지를 꺼낼 수 있는 만큼 LOGIC_MESSAGE_BATCH_MAX개씩 모아 처리합니다
+			NetworkMessage messages[LOGIC_MESSAGE_BATCH_MAX];
+			NetworkMessage *messageNodes[LOGIC_MESSAGE_BATCH_MAX];
+			SerializedBuffer *messagePackets[LOGIC_MESSAGE_BATCH_MAX];
+			LONG messageCount = 0;
+			INT32 batchCount;
+			do
 			{
-				// 메시지를 꺼내 OnRecvMessage를 호출합니다
-				NetworkMessage *message = currentQueue->front();
-				currentQueue->pop();
-				OnRecvMessage(message->sessionID, message->packet);
+				// 메시지를 꺼내 연속된 배열에 옮겨 담습니다
+				batchCount = 0;
+				NetworkMessage *message;
+				while (batchCount < LOGIC_MESSAGE_BATCH_MAX && (message = logicThread->messageQueue.Dequeue()) != nullptr)
+				{
+					messages[batchCount].sessionID = message->sessionID;
+					messages[batchCount].packet = message->packet;
+					messages[batchCount].next = nullptr;
+					messageNodes[batchCount] = message;
+					messagePackets[batchCount] = message->packet;
+					batchCount++;
+				}
+				if (batchCount == 0) break;
+				messageCount += batchCount;
 
-				// 메시지에 사용된 패킷과 메시지를 반환합니다
-				AcquireSRWLockExclusive(&packetPoolSRW);
-				packetPool->Free(message->packet);
-				ReleaseSRWLockExclusive(&packetPoolSRW);
-				AcquireSRWLockExclusive(&messagePoolSRW);
-				messagePool->Free(message);
-				ReleaseSRWLockExclusive(&messagePoolSRW);
-				//wcout << "Dequeued" << endl;
+				// 큐 노드는 옮겨 담았으니 먼저 반환하고, OnRecvMessageBatch가 끝나면 패킷을 한 번에 반환합니다
+				messagePool->FreeBulk(messageNodes, batchCount);
+				OnRecvMessageBatch(messages, batchCount);
+				packetPool->FreeBulk(messagePackets, batchCount);
+			} while (batchCount == LOGIC_MESSAGE_BATCH_MAX);
+
+			// 큐 길이와 프레임 통계를 갱신합니다
+			if (messageCount > 0)
+			{
+				InterlockedExchangeAdd(&logicThread->queueDepth, -messageCount);
+				InterlockedIncrement(&logicThread->framePerSecondCounter);
 			}
+
+			// 메시지 큐가 비었다면 새 메시지가 들어올 때까지 잠듭니다
+			logicThread->messageQueue.Wait();
 		}
 
 		return 0;
 	}
 
-	UINT WINAPI	IOCPServer::TimeCheckThread(PVOID param)
+	UINT WINAPI	IOCPServer::TimeCheckThread(PVOID /*param*/)
 	{
 		DWORD currentTime = 0;
+		DWORD *expiredSlots = new DWORD[sessionTable->GetCapacity()];
+		DWORD64 *timeoutSessionIDs = new DWORD64[sessionTable->GetCapacity()];
 
 		// 서버 상태가 STOP이 아닌 동안 반복합니다
 		while (serverStatus != STATUS_STOP)
 		{
-			// 2초마다 세션의 타임아웃을 체크합니다
-			Sleep(2000);
+			// 한 틱마다 타이머 휠을 진행시킵니다
+			Sleep(serverSettings.timeoutTick);
 			currentTime = timeGetTime();
-			// 세션 맵에 잠금을 걸고 세션의 타임아웃을 체크합니다
-			AcquireSRWLockShared(&sessionMapSRW);
-			auto sessionIterator = sessionMap.begin();
-			Session *session;
-			while (sessionIterator != sessionMap.end())
-			{
-				session = sessionIterator->second;
-				++sessionIterator;
-				// 세션의 IO Count 맨 앞 비트가 1이거나, 세션의 타임아웃 시간이 아직 되지 않았다면 다음 세션으로 넘어갑니다
+			INT32 timeoutCount = 0;
+
+			AcquireSRWLockExclusive(&timerWheelSRW);
+			INT32 expiredCount = timerWheel->Advance(currentTime, expiredSlots);
+			for (int i = 0; i < expiredCount; i++)
+			{
+				Session *session = sessionTable->At(expiredSlots[i]);
+				// 세션의 IO Count 맨 앞 비트가 1이라면 이미 제거된 세션이므로 휠에서 뺀 채로 둡니다
+				// 슬롯이 재사용되면 CreateSession에서 다시 걸립니다
 				if ((session->ioCount & 0x80000000) != 0) continue;
-				if (currentTime < session->TimeoutTime) continue;
-				OnSessionTimeout(session->sessionID);
+				// 그동안 수신이 있어 TimeoutTime이 늘어났다면 늘어난 시간으로 다시 겁니다
+				if ((INT32)(currentTime - session->TimeoutTime) < 0)
+				{
+					timerWheel->Schedule(expiredSlots[i], session->TimeoutTime);
+					continue;
+				}
+				// 타임아웃된 세션은 연결이 해제되지 않을 경우를 대비해 타임아웃 시간 뒤로 다시 겁니다
+				timerWheel->Schedule(expiredSlots[i], currentTime + serverSettings.sessionTimeout);
+				timeoutSessionIDs[timeoutCount++] = session->sessionID;
+			}
+			ReleaseSRWLockExclusive(&timerWheelSRW);
+
+			// 잠금을 풀고 타임아웃을 통지합니다
+			for (int i = 0; i < timeoutCount; i++)
+			{
+				OnSessionTimeout(timeoutSessionIDs[i]);
 			}
-			ReleaseSRWLockShared(&sessionMapSRW);
 		}
 
+		delete[] expiredSlots;
+		delete[] timeoutSessionIDs;
 		return 0;
 	}
 
@@ -4,9 +4,33 @@
 #include "IOCPServerSettings.h"
 
 #include "SerializedBuffer.h"
-#include "MemoryPool.h"
+#include "PacketView.h"
+#include "MessageDispatcher.h"
+#include "PacketSchema.h"
+#include "MemoryPoolTLS.h"
+#include "PacketPool.h"
 #include "MessageQueue.h"
 #include "Session.h"
+#include "SessionTable.h"
+#include "SessionGroupTable.h"
+#include "TimerWheel.h"
+
+// listenSocket의 접속 통지에 사용하는 completionKey (세션 ID는 상위 32비트 세대가 0이 아니므로 겹치지 않습니다)
+#define ACCEPT_COMPLETION_KEY 1
+
+// ioBackend 설정값 (Linux)
+#define IO_BACKEND_EPOLL 0
+#define IO_BACKEND_URING_MULTISHOT 1
+#define IO_BACKEND_URING_FIXED 2
+
+// PacketThread의 최대 개수
+#define LOGIC_THREAD_MAX 64
+
+// RecvProc에서 수신 링버퍼를 한 번 훑을 때 찾는 최대 메시지 개수
+#define RECV_FRAME_BATCH_MAX 256
+
+// PacketThread가 메시지 큐에서 한 번에 꺼내 OnRecvMessageBatch로 넘기는 최대 메시지 개수
+#define LOGIC_MESSAGE_BATCH_MAX 256
 
 namespace azely
 {
@@ -33,6 +57,7 @@ namespace azely
 			EXCEPTION_SESSION_NOT_FOUND,
 			EXCEPTION_SESSION_CORRUPTED,
 			EXCEPTION_SESSION_CREATE,
+			EXCEPTION_SESSION_CIPHER,
 
 			//----------------------------------
 			// Networking Errors
@@ -54,11 +79,7 @@ namespace azely
 			EXCEPTION_STATE_NOT_READY,
 		};
 
-		struct NetworkMessage
-		{
-			DWORD64				sessionID;
-			SerializedBuffer	*packet;
-		};
+		typedef azely::NetworkMessage NetworkMessage;
 
 						IOCPServer();
 		virtual			~IOCPServer();
@@ -70,12 +91,88 @@ namespace azely
 		 */
 		VOID			SendPacket(DWORD64 sessionID, SerializedBuffer *serializedBuffer);
 
+		/**
+		 * \brief 패킷 풀에서 할당한 메시지를 복사하지 않고 보내기를 요청합니다
+		 * \details sendZeroCopy 설정이 켜져 있다면 메시지의 참조 카운트를 올려 세션의 송신 큐에 넣고, 송신이 끝나면 참조를 내립니다
+		 * 꺼져 있다면 송신 링버퍼에 복사합니다 / 같은 메시지를 여러 세션에 보낼 수 있으며, 호출한 쪽은 다 보낸 뒤에 FreePacket을 호출해야 합니다
+		 * 네트워크 헤더는 처음 보낼 때 한 번만 채우므로, 보내기 시작한 뒤에는 메시지를 수정하면 안 됩니다
+		 * \param sessionID 보낼 세션의 ID
+		 * \param packet 보낼 메시지 (AllocPacket으로 할당한 메시지)
+		 */
+		VOID			SendPacketPooled(DWORD64 sessionID, SerializedBuffer *packet);
+
+		/**
+		 * \brief 패킷 풀에서 할당한 하나의 메시지를 여러 세션에 보내기를 요청합니다
+		 * \details 네트워크 헤더는 한 번만 채우며, sendZeroCopy 설정이 켜져 있다면 모든 세션의 송신 큐에 같은 메시지를 참조로 넣습니다
+		 * 꺼져 있다면 세션마다 송신 링버퍼에 복사합니다 / 호출한 쪽은 다 보낸 뒤에 FreePacket을 호출해야 합니다
+		 * \param sessionIDs 보낼 세션 ID 배열 (연결이 끊긴 세션은 건너뜁니다)
+		 * \param sessionCount 세션 ID 개수
+		 * \param packet 보낼 메시지 (AllocPacket으로 할당한 메시지)
+		 */
+		VOID			SendPacketMulti(const DWORD64 *sessionIDs, INT32 sessionCount, SerializedBuffer *packet);
+
+		/**
+		 * \brief 세션을 그룹(방, 채널)에 넣습니다
+		 * \details 그룹은 처음 들어올 때 만들어지고 마지막 멤버가 나가면 지워지며, 세션이 정리될 때 들어가 있던 모든 그룹에서 자동으로 빠집니다
+		 * \param groupID 그룹 ID
+		 * \param sessionID 넣을 세션의 ID
+		 * \return 세션이 유효하지 않거나 이미 들어가 있다면 false
+		 */
+		BOOL			JoinGroup(DWORD64 groupID, DWORD64 sessionID);
+
+		/**
+		 * \brief 세션을 그룹에서 뺍니다
+		 * \param groupID 그룹 ID
+		 * \param sessionID 뺄 세션의 ID
+		 * \return 들어가 있지 않았다면 false
+		 */
+		BOOL			LeaveGroup(DWORD64 groupID, DWORD64 sessionID);
+
+		/**
+		 * \brief 패킷 풀에서 할당한 메시지를 그룹의 모든 멤버에게 보내기를 요청합니다
+		 * \details 멤버 배열을 복사한 뒤 SendPacketMulti로 보내며, 호출한 쪽은 다 보낸 뒤에 FreePacket을 호출해야 합니다
+		 * \param groupID 그룹 ID
+		 * \param packet 보낼 메시지 (AllocPacket으로 할당한 메시지)
+		 */
+		VOID			SendPacketGroup(DWORD64 groupID, SerializedBuffer *packet);
+
+		/**
+		 * \brief 패킷 풀에서 보낼 메시지를 할당합니다
+		 * \return Clear(true)로 네트워크 헤더 공간이 난, 참조 카운트가 1인 메시지
+		 */
+		SerializedBuffer	*AllocPacket();
+
+		/**
+		 * \brief 페이로드 크기에 맞추어 보낼 메시지를 할당합니다
+		 * \details 패킷 풀에서 페이로드와 네트워크 헤더가 들어가는 가장 작은 크기 등급의 메시지를 할당하며, 가장 큰 등급보다 큰 메시지는 따로 할당합니다
+		 * \param payloadSize 담을 페이로드 크기 (네트워크 헤더 제외, messageSizeMax 이하)
+		 * \return Clear(true)로 네트워크 헤더 공간이 난, 참조 카운트가 1인 메시지
+		 */
+		SerializedBuffer	*AllocPacket(INT32 payloadSize);
+
+		/**
+		 * \brief AllocPacket으로 할당한 메시지의 참조 카운트를 내리고, 0이 되면 반환합니다
+		 * \param packet 반환할 메시지
+		 */
+		VOID			FreePacket(SerializedBuffer *packet);
+
 		/**
 		 * \brief 지정한 세션의 연결을 끊습니다
 		 * \param sessionID 연결을 끊을 세션의 ID
 		 */
 		VOID			DisconnectSession(DWORD64 sessionID);
 
+		/**
+		 * \brief 세션의 메시지 암호화를 켭니다
+		 * \details 이후 세션과 주고받는 모든 메시지의 페이로드는 AEAD로 암호화되고 16바이트 인증 태그가 붙으며, 인증에 실패한 메시지를 받으면 세션을 종료합니다
+		 * 수신을 시작하기 전이어야 하므로 OnSessionConnected 안에서, 그 세션에 메시지를 보내기 전에 호출해야 합니다
+		 * 암호화된 세션에는 SendPacketMulti로 보내더라도 세션마다 암호화한 메시지를 따로 만들어 보냅니다
+		 * \param sessionID 암호화할 세션의 ID
+		 * \param key 키 재료 (호출이 끝나면 지워도 됩니다)
+		 * \return 세션이 유효하지 않거나 지원하지 않는 알고리즘이라면 false
+		 */
+		BOOL			SetSessionCipher(DWORD64 sessionID, const SessionCipher::Key *key);
+
 	protected:
 		/**
 		 * \brief 서버를 설정값으로 초기화합니다
@@ -102,23 +199,123 @@ namespace azely
 		VOID			StopServer();
 
 	private:
+		struct ServerShard;
+
+#ifndef _WIN32
+		/**
+		 * \brief io_uring 백엔드에서 WorkerThread 하나가 가지는 제출 큐와 완료 큐
+		 * \details 링을 가진 WorkerThread는 요청을 모아 두었다가 완료를 기다릴 때 함께 제출하고, 다른 스레드는 잠금을 잡고 넣은 뒤 바로 제출합니다
+		 * 세션은 슬롯 번호로 정해지는 링 하나에서만 수신하므로, 수신 완료는 항상 같은 WorkerThread가 처리합니다
+		 */
+		struct UringRing
+		{
+			UringRing() : shard(nullptr), ringIndex(0), handleRing(-1), sqHead(nullptr), sqTail(nullptr), sqArray(nullptr), sqMask(0), sqEntries(0), sqes(nullptr),
+				cqHead(nullptr), cqTail(nullptr), cqMask(0), cqes(nullptr), mapRing(MAP_FAILED), mapRingSize(0), mapSqesSize(0), isFixedBufferRegistered(false), isAcceptArmed(false)
+			{
+				InitializeSRWLock(&submitSRW);
+			}
+
+			ServerShard								*shard;
+			INT32									ringIndex;
+			INT32									handleRing;
+			SRWLOCK									submitSRW;
+			UINT32									*sqHead;
+			UINT32									*sqTail;
+			UINT32									*sqArray;
+			UINT32									sqMask;
+			UINT32									sqEntries;
+			io_uring_sqe							*sqes;
+			UINT32									*cqHead;
+			UINT32									*cqTail;
+			UINT32									cqMask;
+			io_uring_cqe							*cqes;
+			PVOID									mapRing;
+			size_t									mapRingSize;
+			size_t									mapSqesSize;
+			// 링이 맡은 슬롯들의 수신 링버퍼를 고정 버퍼로 등록했는지 여부 (ioBackend 2)
+			BOOL									isFixedBufferRegistered;
+			// 샤드의 첫 링에 multishot accept가 걸려 있는지 여부
+			BOOL									isAcceptArmed;
+		};
+#endif
+
+		/**
+		 * \brief 완료 통지 핸들, listenSocket, WorkerThread를 묶은 단위
+		 * \details 세션 테이블의 슬롯 번호를 샤드 개수로 나눈 나머지가 세션의 소속 샤드이며, 빈 슬롯도 샤드별로 관리합니다
+		 */
+		struct ServerShard
+		{
+			ServerShard() : server(nullptr), shardIndex(0),
+#ifdef _WIN32
+				handleIOCP(INVALID_HANDLE_VALUE),
+#else
+				handleEpoll(-1), handleNotify(-1), rings(nullptr), ringCount(0), acceptReadiness(0),
+#endif
+				listenSocket(INVALID_SOCKET), handleWorkers(nullptr), workerCount(0)
+			{
+#ifndef _WIN32
+				InitializeSRWLock(&notifySRW);
+#endif
+			}
+
+			IOCPServer								*server;
+			INT32									shardIndex;
+#ifdef _WIN32
+			HANDLE									handleIOCP;
+#else
+			INT32									handleEpoll;
+			// PostQueuedCompletionStatus를 대신할 통지 큐와, 통지가 들어왔음을 WorkerThread에 알리는 eventfd
+			INT32									handleNotify;
+			SRWLOCK									notifySRW;
+			vector<DWORD64>							notifyQueue;
+			// io_uring 백엔드에서 WorkerThread마다 하나씩 두는 링
+			UringRing								*rings;
+			INT32									ringCount;
+			alignas(64) DWORD						acceptReadiness;
+#endif
+			SOCKET									listenSocket;
+			HANDLE									*handleWorkers;
+			INT32									workerCount;
+		};
+
+		/**
+		 * \brief PacketThread 하나와 그 스레드가 꺼내는 메시지 큐를 묶은 단위
+		 * \details 세션 ID의 해시로 소속 PacketThread가 정해지므로, 한 세션의 메시지는 순서대로 처리됩니다
+		 */
+		struct LogicThread
+		{
+			LogicThread() : server(nullptr), threadIndex(0), handleThread(INVALID_HANDLE_VALUE), queueDepth(0), framePerSecondCounter(0)
+			{
+
+			}
+
+			IOCPServer								*server;
+			INT32									threadIndex;
+			HANDLE									handleThread;
+			MessageQueue<NetworkMessage>			messageQueue;
+			alignas(64) volatile LONG				queueDepth;
+			alignas(64) volatile DWORD64			framePerSecondCounter;
+		};
+
 		/**
 		 * \brief WorkerThread를 실행시킵니다
-		 * \param param IOCPServer instance
+		 * \param param 스레드가 속한 ServerShard
 		 * \return IOCPServer::WorkerThread() 의 반환값
 		 */
 		friend UINT WINAPI		WorkerThreadProc(PVOID param);
 
+#ifndef _WIN32
 		/**
-		 * \brief AcceptThread를 실행시킵니다
-		 * \param param IOCPServer instance
-		 * \return IOCPServer::AcceptThreaD() 의 반환값
+		 * \brief io_uring 백엔드의 WorkerThread를 실행시킵니다
+		 * \param param 스레드가 맡은 UringRing
+		 * \return IOCPServer::UringWorkerThread() 의 반환값
 		 */
-		friend UINT WINAPI		AcceptThreadProc(PVOID param);
+		friend UINT WINAPI		UringWorkerThreadProc(PVOID param);
+#endif
 
 		/**
 		 * \brief PacketThread를 실행시킵니다
-		 * \param param IOCPServer instance
+		 * \param param 스레드의 LogicThread
 		 * \return IOCPServere::PacketThread() 의 반환값
 		 */
 		friend UINT WINAPI		PacketThreadProc(PVOID param);
@@ -132,27 +329,32 @@ namespace azely
 
 		/**
 		 * \brief IOCP WorkerThread
-		 * \param param IOCPServer instance
+		 * \param param 스레드가 속한 ServerShard
 		 * \return 0 if successful, otherwise error code
 		 */
 		UINT WINAPI				WorkerThread(PVOID param);
 
+#ifndef _WIN32
 		/**
-		 * \brief Accept만 담당하는 Thread
-		 * \param param IOCPServer instance
+		 * \brief io_uring WorkerThread
+		 * \details 모아둔 요청을 제출하며 완료를 기다리고, 깨어나면 쌓인 완료를 한 번에 거둡니다
+		 * \param param 스레드가 맡은 UringRing
 		 * \return 0 if successful, otherwise error code
 		 */
-		UINT WINAPI				AcceptThread(PVOID param);
+		UINT WINAPI				UringWorkerThread(PVOID param);
+#endif
 
 		/**
 		 * \brief 수신한 메시지에 맞는 처리를 하는 Thread
-		 * \param param IOCPServer instance
+		 * \details 자기 메시지 큐를 비울 때까지 처리한 뒤 잠들며, 이 한 번을 한 프레임으로 셉니다
+		 * \param param 스레드의 LogicThread
 		 * \return 0 if successful, otherwise error code
 		 */
 		UINT WINAPI				PacketThread(PVOID param);
 
 		/**
 		 * \brief timeout을 체크하는 Thread
+		 * \details 한 틱마다 타이머 휠을 진행시켜, 만료 시점이 된 세션만 확인합니다
 		 * \param param IOCPServer instance
 		 * \return 0 if successful, otherwise error code
 		 */
@@ -163,11 +365,46 @@ namespace azely
 		//----------------------------------------------------
 		/**
 		 * \brief 메시지가 수신되었을 때 Call 되는 함수
+		 * \details logicThreadCount가 2 이상이라면 여러 PacketThread에서 동시에 호출됩니다 (같은 세션은 항상 같은 스레드에서 호출됩니다)
 		 * \param sessionID 세션 ID
 		 * \param message 수신한 메시지
 		 */
 		virtual VOID	OnRecvMessage(DWORD64 sessionID, SerializedBuffer *message) = 0;
 
+		/**
+		 * \brief inlineDispatch 설정이 켜져 있을 때, 메시지를 수신한 WorkerThread에서 바로 Call 되는 함수
+		 * \details message는 WorkerThread마다 하나씩 재사용하는 버퍼이므로, 함수가 반환된 뒤에는 사용할 수 없습니다
+		 * false를 반환하면 메시지를 패킷 풀로 복사하여 PacketThread의 OnRecvMessage로 넘깁니다 (읽은 위치는 되돌려집니다)
+		 * 메시지 종류마다 처리할 스레드를 고를 수 있지만, 같은 세션에서 두 경로로 나뉜 메시지끼리는 순서가 보장되지 않습니다
+		 * 기본 구현은 OnRecvMessage를 그대로 호출합니다
+		 * \param sessionID 세션 ID
+		 * \param message 수신한 메시지
+		 * \return WorkerThread에서 처리했다면 true, PacketThread로 넘기려면 false
+		 */
+		virtual BOOL	OnRecvMessageInline(DWORD64 sessionID, SerializedBuffer *message);
+
+		/**
+		 * \brief inlineDispatch 설정이 켜져 있을 때, 메시지를 수신 링버퍼에서 복사하지 않고 WorkerThread에서 먼저 Call 되는 함수
+		 * \details message는 수신 링버퍼(끊긴 메시지라면 WorkerThread의 버퍼)를 가리키며, 링버퍼의 읽기 위치는 함수가 반환된 뒤에 이동하므로 그 뒤에는 사용할 수 없습니다
+		 * false를 반환하면 메시지는 링버퍼에 그대로 남아 OnRecvMessageInline으로 넘어갑니다
+		 * 수신 링버퍼에 다 도착한 messageSizeMax 이하의 메시지는 크기와 상관없이 넘어오며, 암호화된 세션의 메시지와 다 도착하기 전에 패킷으로 따로 모으기 시작한 큰 메시지는 이 함수를 거치지 않습니다
+		 * 기본 구현은 false를 반환합니다
+		 * \param sessionID 세션 ID
+		 * \param message 수신한 메시지의 뷰
+		 * \return 처리했다면 true, OnRecvMessageInline으로 넘기려면 false
+		 */
+		virtual BOOL	OnRecvMessage(DWORD64 sessionID, PacketView &message);
+
+		/**
+		 * \brief PacketThread가 메시지 큐에서 한 번에 꺼낸 메시지들을 넘길 때 Call 되는 함수
+		 * \details 최대 LOGIC_MESSAGE_BATCH_MAX개의 메시지가 받은 순서대로 연속된 배열에 담겨 넘어옵니다
+		 * 메시지의 패킷은 함수가 반환된 뒤 한 번에 패킷 풀로 반환되므로, 그 뒤에는 사용할 수 없습니다
+		 * 기본 구현은 메시지마다 OnRecvMessage를 호출합니다
+		 * \param messages 메시지 배열
+		 * \param messageCount 메시지 개수
+		 */
+		virtual VOID	OnRecvMessageBatch(const NetworkMessage *messages, INT32 messageCount);
+
 		/**
 		 * \brief 접속을 허용하는지 여부를 결정하는 함수
 		 * \param addressIP 접속을 요청하는 IP
@@ -230,6 +467,181 @@ namespace azely
 		 */
 		void			SendPost(Session *session);
 
+		/**
+		 * \brief sendZeroCopy 설정에서 세션의 송신 큐로부터 보낼 패킷들을 꺼내 SendGather를 채웁니다
+		 * \param session 보낼 세션 (ioFlag를 든 스레드에서만 호출해야 합니다)
+		 * \return SendGather에 담긴 보낼 크기
+		 */
+		INT32			LoadSendGather(Session *session);
+
+		/**
+		 * \brief sendZeroCopy 설정에서 메시지의 참조 하나를 넘겨받아 세션의 송신 큐에 넣습니다
+		 * \param session 보낼 세션
+		 * \param packet 보낼 메시지 (참조 카운트를 미리 올려둔 상태)
+		 */
+		VOID			EnqueueSendMessage(Session *session, SerializedBuffer *packet);
+
+		/**
+		 * \brief 암호화된 세션에 메시지를 암호화하여 보냅니다
+		 * \details 세션마다 암호문이 다르므로, 메시지의 페이로드를 세션 전용 패킷에 암호화해 넣고 송신 링버퍼나 송신 큐에 넣습니다
+		 * \param session 보낼 세션
+		 * \param packet 보낼 메시지 (Clear(true)로 네트워크 공간이 난 상태, 참조는 넘기지 않습니다)
+		 */
+		VOID			SendPacketSealed(Session *session, SerializedBuffer *packet);
+
+		/**
+		 * \brief sendZeroCopy 설정에서 보낸 크기만큼 SendGather의 패킷들을 반환합니다
+		 * \param session 보낸 세션
+		 * \param sentSize 보낸 크기
+		 */
+		VOID			CompleteSendGather(Session *session, INT32 sentSize);
+
+		/**
+		 * \brief sendZeroCopy 설정에서 세션의 SendGather와 송신 큐에 남은 패킷들을 모두 반환합니다
+		 * \param session 정리할 세션
+		 */
+		VOID			ClearSendGather(Session *session);
+
+#ifdef _WIN32
+		/**
+		 * \brief 세션 테이블에서 세션을 미리 할당하여 AcceptEx를 요청하는 함수
+		 */
+		void			AcceptPost();
+
+		/**
+		 * \brief AcceptEx 후 IOCP를 통해 접속 완료처리가 되었을 때 이를 처리하는 함수
+		 * \param session AcceptEx를 걸어두었던 세션
+		 * \param ioResult 접속 성공 여부
+		 * \return 세션 생성 여부
+		 */
+		BOOL			AcceptProc(Session *session, BOOL ioResult);
+#else
+		/**
+		 * \brief epoll 접속 준비 통지를 받았을 때 대기중인 접속을 묶어서 수락하는 함수
+		 * \param shard 통지를 받은 샤드
+		 */
+		void			AcceptReady(ServerShard *shard);
+
+		/**
+		 * \brief epoll 수신 준비 통지를 받았을 때 소켓에서 읽을 수 있는 만큼 읽어 처리하는 함수
+		 * \param session 통지를 받은 세션
+		 * \param events 통지받은 epoll 이벤트
+		 */
+		void			RecvReady(Session *session, DWORD events);
+
+		/**
+		 * \brief epoll 송신 준비 통지를 받았을 때 멈춰있던 송신을 재개하는 함수
+		 * \param session 통지를 받은 세션
+		 */
+		void			SendReady(Session *session);
+
+		/**
+		 * \brief 샤드의 통지 큐를 통해 WorkerThread 에 값을 전달합니다 (PostQueuedCompletionStatus 대응)
+		 * \details 통지는 큐에 넣고 eventfd로 WorkerThread를 깨우기만 하므로, 통지가 얼마나 쌓여도 호출한 스레드가 막히지 않습니다
+		 * \param shard 통지를 받을 샤드
+		 * \param notifyKey 세션 ID, 혹은 종료를 의미하는 0xffffffff
+		 */
+		void			PostNotify(ServerShard *shard, DWORD64 notifyKey);
+
+		/**
+		 * \brief 송신 링버퍼의 보낼 구간, 혹은 송신 큐에서 꺼낸 패킷들로 iovec 배열을 채웁니다
+		 * \param session 보낼 세션 (ioFlag를 든 스레드에서만 호출해야 합니다)
+		 * \param iov [out] SESSION_SEND_GATHER_MAX개의 iovec 배열
+		 * \param outVectorCount [out] 채운 iovec 개수
+		 * \return 보낼 크기
+		 */
+		INT32			LoadSendVector(Session *session, iovec *iov, size_t *outVectorCount);
+
+		/**
+		 * \brief 커널이 지원하는 만큼 ioBackend 설정을 낮춥니다
+		 * \param ioBackend 요청한 ioBackend
+		 * \return 사용할 수 있는 ioBackend
+		 */
+		static INT32	ProbeUringBackend(INT32 ioBackend);
+
+		/**
+		 * \brief 샤드의 WorkerThread 개수만큼 io_uring 링을 만들고, 통지 eventfd의 준비 통지를 걸어둡니다
+		 * \details ioBackend 2라면 링마다 맡은 슬롯들의 수신 링버퍼를 고정 버퍼로 등록합니다
+		 * \param shard 준비할 샤드
+		 * \param ringCount 만들 링 개수
+		 * \return 성공 여부
+		 */
+		BOOL			ReadyUring(ServerShard *shard, INT32 ringCount);
+
+		/**
+		 * \brief 샤드의 io_uring 링을 닫고, 슬롯에 빌려주었던 버퍼 링을 반환합니다 / WorkerThread가 종료된 뒤에 호출되어야 합니다
+		 * \param shard 정리할 샤드
+		 */
+		void			ReleaseUring(ServerShard *shard);
+
+		/**
+		 * \brief 요청 하나를 링의 제출 큐에 넣습니다
+		 * \details 링을 가진 WorkerThread라면 다음 대기 때 모아서 제출하고, 다른 스레드라면 바로 제출합니다
+		 * \param ring 넣을 링
+		 * \param sqe 넣을 요청
+		 */
+		void			SubmitUring(UringRing *ring, const io_uring_sqe *sqe);
+
+		/**
+		 * \brief 샤드의 listenSocket에 multishot accept를 겁니다
+		 * \param ring 샤드의 첫 링
+		 */
+		void			ArmAcceptUring(UringRing *ring);
+
+		/**
+		 * \brief 세션에 수신 요청(multishot 수신, 고정 버퍼 읽기, 혹은 일반 수신)을 겁니다
+		 * \param session 수신할 세션 (IO Count를 하나 잡아둔 상태)
+		 */
+		void			ArmRecvUring(Session *session);
+
+		/**
+		 * \brief io_uring 백엔드의 RecvPost / 세션마다 한 번 호출되며, 수신이 끝날 때까지 IO Count를 하나 잡아둡니다
+		 * \param session Recv 할 세션
+		 */
+		void			RecvPostUring(Session *session);
+
+		/**
+		 * \brief io_uring 백엔드의 SendPost / ioFlag를 든 채로 sendmsg 요청을 넣습니다
+		 * \param session Send 할 세션
+		 */
+		void			SendPostUring(Session *session);
+
+		/**
+		 * \brief multishot 수신에서 수신 링버퍼의 빈 구간을 슬롯의 버퍼 링에 빌려줍니다
+		 * \details 빌려준 구간이 아직 읽지 않은 데이터를 덮지 않는 만큼만 쓰기 위치부터 이어서 빌려주므로, 커널은 수신 링버퍼의 쓰기 위치에 바로 씁니다
+		 * \param session 대상 세션 (슬롯의 링을 가진 WorkerThread, 혹은 수신을 걸기 전에만 호출해야 합니다)
+		 */
+		void			ProvideUringRecv(Session *session);
+
+		/**
+		 * \brief io_uring 수신 완료를 처리합니다
+		 * \param session 받은 세션
+		 * \param result 완료 결과 (받은 크기, 혹은 -errno)
+		 * \param flags 완료 플래그
+		 */
+		void			RecvCompleteUring(Session *session, INT32 result, UINT32 flags);
+
+		/**
+		 * \brief io_uring 송신 완료를 처리합니다
+		 * \param session 보낸 세션
+		 * \param result 완료 결과 (보낸 크기, 혹은 -errno)
+		 */
+		void			SendCompleteUring(Session *session, INT32 result);
+
+		/**
+		 * \brief 세션이 수신하는 링을 반환합니다
+		 * \details 슬롯 번호는 샤드 개수 간격으로 할당되므로, 샤드 개수로 나눈 뒤 링 개수로 나눈 나머지로 고릅니다
+		 * \param session 대상 세션
+		 * \return 세션의 링
+		 */
+		UringRing		*GetUringRing(Session *session)
+		{
+			ServerShard *shard = GetShard(session->sessionID);
+			DWORD slotIndex = sessionTable->GetSlotIndex(session->sessionID);
+			return &shard->rings[(slotIndex / serverSettings.shardCount) % shard->ringCount];
+		}
+#endif
+
 		/**
 		 * \brief 예기치 못한 오류가 발생하였을때 이를 처리하는 함수
 		 * \param function 오류가 발생한 함수 이름
@@ -240,30 +652,66 @@ namespace azely
 		void			HandleException(PCWSTR function, INT32 line, IOCPServerException exception, INT32 errorOS = 0);
 
 		/**
-		 * \brief accept를 호출하여 연결을 수립 시도하는 함수
-		 * \param acceptedSocket [out] accept된 소켓
-		 * \param acceptedAddress [out] accept된 클라이언트 주소
-		 * \return accept 성공여부
+		 * \brief 수락된 소켓의 접속 허용 여부를 묻고, 허용되었다면 세션을 생성하는 함수
+		 * \details 실패한 경우 소켓을 닫고 세션을 세션 테이블에 반환합니다
+		 * \param session 접속에 사용할 세션 (세션 테이블에서 할당된 상태)
+		 * \param socket 수락된 소켓
+		 * \param socketAddress 수락된 클라이언트 주소
+		 * \return 세션 생성 여부
 		 */
-		BOOL			GetAccept(SOCKET *acceptedSocket, sockaddr_in *acceptedAddress);
+		BOOL			AcceptSession(Session *session, SOCKET socket, SOCKADDR_IN *socketAddress);
+
+		/**
+		 * \brief 세션 생성이 끝난 세션들을 알리고 수신을 시작시키는 함수
+		 * \param sessions 생성된 세션 배열
+		 * \param sessionCount 생성된 세션 개수
+		 */
+		void			ConnectSessions(Session **sessions, INT32 sessionCount);
 
 		/**
 		 * \brief 수신 버퍼에서 메시지를 추출해내는 함수
+		 * \details serializedBuffer가 nullptr라면 메시지가 다 도착한 뒤에 페이로드 크기에 맞는 등급의 패킷을 패킷 풀에서 할당합니다
+		 * 기본 패킷 크기에 들어가지 않는 큰 메시지는 헤더만 보고 크기에 맞는 패킷을 할당해 세션의 RecvLargePacket에 모으며, 다 모였을 때 그 패킷을 반환합니다
+		 * messageSizeMax보다 큰 메시지는 헤더만 보고 세션을 종료하며, 암호화된 세션이라면 메시지를 제자리에서 복호화하여 반환합니다
+		 * \param session 대상 세션
+		 * \param serializedBuffer [out] 추출된 메시지를 담을 버퍼 (컨텐츠부), nullptr라면 패킷 풀에서 할당합니다
+		 * \return 추출된 메시지 (serializedBuffer, 혹은 패킷 풀에 반환해야 하는 패킷), 완성된 메시지가 없다면 nullptr
+		 */
+		SerializedBuffer	*GetPacketCompleted(Session *session, SerializedBuffer *serializedBuffer);
+
+		/**
+		 * \brief 수신 링버퍼의 맨 앞 메시지를 PacketView로 만들어 OnRecvMessage(DWORD64, PacketView &)에 넘깁니다
+		 * \details 처리되었다면 그 뒤에 링버퍼의 읽기 위치를 메시지만큼 이동시키며, 메시지가 다 오지 않았거나 헤더가 잘못되었다면 링버퍼를 건드리지 않고 GetPacketCompleted에 맡깁니다
+		 * \param session 대상 세션
+		 * \return 메시지가 처리되었는지 여부
+		 */
+		BOOL			DispatchPacketView(Session *session);
+
+		/**
+		 * \brief 완성된 메시지를 inlineDispatch 설정에 맞게 처리하고, PacketThread로 넘길 메시지 노드를 리턴합니다
 		 * \param session 대상 세션
-		 * \param serializedBuffer [out] 추출된 메시지 (컨텐츠부)
-		 * \param header [out] 추출된 메시지 헤더
-		 * \return 패킷이 추출되었는지 여부
+		 * \param packet 완성된 메시지
+		 * \param inlinePacket WorkerThread의 인라인 버퍼 (packet이 이 버퍼라면 PacketThread로 넘길 때 패킷 풀로 복사합니다)
+		 * \return PacketThread로 넘길 메시지 노드, WorkerThread에서 처리했다면 nullptr
 		 */
-		BOOL			GetPacketCompleted(Session *session, SerializedBuffer *serializedBuffer, NetworkHeader *header);
+		NetworkMessage	*DispatchRecvPacket(Session *session, SerializedBuffer *packet, SerializedBuffer *inlinePacket);
+
+		/**
+		 * \brief 암호화된 세션에서 받은 메시지를 제자리에서 복호화하고, 인증 태그를 떼어냅니다
+		 * \param session 대상 세션
+		 * \param packet 받은 메시지 (페이로드 뒤에 인증 태그가 붙은 상태)
+		 * \return 인증 성공 여부
+		 */
+		BOOL			OpenPacket(Session *session, SerializedBuffer *packet);
+
 
 		/**
 		 * \brief 세션을 새로 만듭니다
+		 * \param session 초기화할 세션 (세션 테이블에서 할당되어 주소가 채워진 상태)
 		 * \param socket 세션의 소켓
-		 * \param sessionID 세션의 아이디
-		 * \param socketAddress 세션의 소켓 주소
 		 * \return 생성된 세션 포인터
 		 */
-		Session			*CreateSession(SOCKET socket, DWORD64 sessionID, SOCKADDR_IN socketAddress);
+		Session			*CreateSession(Session *session, SOCKET socket);
 
 		/**
 		 * \brief 세션을 정리합니다
@@ -285,7 +733,36 @@ namespace azely
 		void			ReturnSession(Session *session);
 
 		/**
-		 * \brief 세션 맵에서 세션을 찾습니다
+		 * \brief 세션 ID가 속한 샤드를 반환합니다
+		 * \param sessionID 세션 ID
+		 * \return 세션이 속한 샤드
+		 */
+		ServerShard		*GetShard(DWORD64 sessionID)
+		{
+			return &shards[sessionTable->GetShardIndex(sessionID)];
+		}
+
+		/**
+		 * \brief 세션 ID의 메시지를 처리할 PacketThread를 반환합니다
+		 * \details 슬롯 번호는 샤드 개수 간격으로 할당되므로, 곱셈 해시로 섞은 뒤 나누어 샤드와 무관하게 고르게 배정합니다
+		 * \param sessionID 세션 ID
+		 * \return 세션의 메시지를 처리할 LogicThread
+		 */
+		LogicThread		*GetLogicThread(DWORD64 sessionID)
+		{
+			DWORD slotHash = sessionTable->GetSlotIndex(sessionID) * 2654435761u;
+			return &logicThreads[(slotHash >> 16) % serverSettings.logicThreadCount];
+		}
+
+		/**
+		 * \brief 샤드를 준비시킵니다 / 완료 통지 핸들과 WorkerThread, listenSocket을 생성합니다
+		 * \param shard 준비할 샤드
+		 * \return 성공 여부
+		 */
+		BOOL			ReadyShard(ServerShard *shard);
+
+		/**
+		 * \brief 세션 테이블에서 세션을 찾습니다
 		 * \param sessionID 찾을 세션 ID
 		 * \return 찾은 세션 포인터
 		 */
@@ -307,30 +784,28 @@ namespace azely
 
 		ServerStatus								serverStatus;
 
-		MemoryPool<Session>							*sessionPool;
-		SRWLOCK										sessionPoolSRW;
-		MemoryPool<SerializedBuffer>				*packetPool;
-		SRWLOCK										packetPoolSRW;
-		MemoryPool<NetworkMessage>					*messagePool;
-		SRWLOCK										messagePoolSRW;
+		SessionTable								*sessionTable;
+		TimerWheel									*timerWheel;
+		SRWLOCK										timerWheelSRW;
+		SessionGroupTable							*groupTable;
+		SRWLOCK										groupTableSRW;
+		PacketPool									*packetPool;
+		MemoryPoolTLS<NetworkMessage>				*messagePool;
 
-		MessageQueue<NetworkMessage *>				messageQueue;
-		MessageQueue<NetworkMessage *>::QueueType	currentQueue;
 
-		unordered_map<DWORD64, Session*>			sessionMap;
-		SRWLOCK										sessionMapSRW;
+		ServerShard									*shards;
+		LogicThread									*logicThreads;
 
 		IOCPServerSettings::Settings				serverSettings;
 
-		HANDLE										handleIOCP;
-		HANDLE										*handleWorkers;
-		HANDLE										handleAccept;
-		HANDLE										handleLogic;
+#ifdef _WIN32
+		LPFN_ACCEPTEX								fnAcceptEx;
+		LPFN_GETACCEPTEXSOCKADDRS					fnGetAcceptExSockaddrs;
+		alignas(64) volatile DWORD64				acceptPendingCount;
+		alignas(64) volatile DWORD64				acceptShardNext;
+#endif
 		HANDLE										handleTimeout;
 
-		SOCKET										listenSocket;
-		DWORD64										sessionNextID;
-
 	protected:
 		/**
 		 * \brief 서버의 상태 정보를 구조체로 반환하기 위해 존재합니다
@@ -349,8 +824,11 @@ namespace azely
 			DWORD64	packetPoolUsed;
 			DWORD64	messagePoolSize;
 			DWORD64	messagePoolUsed;
-			DWORD64	framePerSecondAccept;
+			DWORD64	acceptBatchPerSecond;
 			DWORD64	framePerSecondPacket;
+			INT32	logicThreadCount;
+			DWORD64	logicQueueDepth[LOGIC_THREAD_MAX];
+			DWORD64	logicFramePerSecond[LOGIC_THREAD_MAX];
 		};
 
 		DWORD64										timeBegin;
@@ -360,8 +838,7 @@ namespace azely
 		alignas(64)	volatile DWORD64				acceptPerSecondCounter;
 		alignas(64) volatile DWORD64				sessionAccepted;
 		alignas(64) volatile DWORD64				sessionReleased;
-		alignas(64) volatile DWORD64				framePerSecondAcceptCounter;
-		alignas(64) volatile DWORD64				framePerSecondPacketCounter;
+		alignas(64) volatile DWORD64				acceptBatchPerSecondCounter;
 
 		/**
 		 * \brief 서버의 상태를 가져옵니다
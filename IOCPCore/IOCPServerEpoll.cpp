@@ -0,0 +1,422 @@
+﻿#include "IOCPServer.h"
+
+//----------------------------------------------------------
+// Linux epoll 백엔드
+// IOCP 의 WorkerThread, RecvPost, SendPost, AcceptPost 를 epoll 엣지 트리거로 대응합니다
+// 세션, 링버퍼, IO Count 규칙과 컨텐츠 콜백은 IOCP 백엔드와 동일합니다
+//----------------------------------------------------------
+#ifndef _WIN32
+
+#define EXCEPTION(CODE, ...) do {HandleException(__FUNCTIONW__, __LINE__, CODE, ##__VA_ARGS__);} while(0)
+
+#define EPOLL_EVENT_MAX 128
+#define EPOLL_NOTIFY_KEY 0
+#define EPOLL_READINESS_CLOSED 0x80000000
+#define EPOLL_READINESS_HANGUP 0x40000000
+#define EPOLL_READINESS_COUNT 0x3fffffff
+#define EPOLL_ACCEPT_BATCH_MAX 256
+
+namespace azely
+{
+
+	VOID IOCPServer::RecvPost(Session *session)
+	{
+		// io_uring 백엔드라면 그쪽에서 수신을 겁니다
+		if (serverSettings.ioBackend != IO_BACKEND_EPOLL)
+		{
+			RecvPostUring(session);
+			return;
+		}
+
+		// epoll 에서는 소켓을 한 번 등록해두면 수신 준비 통지가 계속 오므로, 세션당 한 번만 호출됩니다
+		// 등록되어 있는 동안은 IOCP의 대기중인 WSARecv처럼 IO Count를 하나 잡아둡니다
+		InterlockedIncrement(&session->ioCount);
+
+		// 세션 ID를 completionKey처럼 사용하여 소켓을 엣지 트리거로 등록합니다
+		epoll_event sessionEvent;
+		sessionEvent.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+		sessionEvent.data.u64 = session->sessionID;
+		if (epoll_ctl(GetShard(session->sessionID)->handleEpoll, EPOLL_CTL_ADD, (int)session->socket, &sessionEvent) == -1)
+		{
+			EXCEPTION(EXCEPTION_SOCKET_RECV, errno);
+			// 수신 통지가 오지 않을 것이므로, ioCount를 감소시키고 0이라면 세션을 정리합니다
+			if (InterlockedDecrement(&session->ioCount) == 0)
+			{
+				RemoveSession(session);
+			}
+		}
+	}
+
+	VOID IOCPServer::RecvReady(Session *session, DWORD events)
+	{
+		// 상대가 연결을 닫았다는 통지라면, 끝까지 읽어 0바이트 수신을 확인할 수 있도록 표시해둡니다
+		if (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+		{
+			InterlockedOr(&session->RecvOverlapped.readiness, EPOLL_READINESS_HANGUP);
+		}
+
+		// 다른 WorkerThread가 이미 수신 중이라면 통지 횟수만 남기고 빠져나갑니다
+		// 수신 중인 스레드는 빠져나가기 전에 통지 횟수가 바뀌었는지 확인하여 다시 읽습니다
+		DWORD readinessObserved = InterlockedIncrement(&session->RecvOverlapped.readiness);
+		if ((readinessObserved & EPOLL_READINESS_CLOSED) || (readinessObserved & EPOLL_READINESS_COUNT) != 1) return;
+
+		while (true)
+		{
+			// iovec 구조체를 수신 링버퍼의 WriteBuffer와 BeginBuffer를 이용하여 초기화합니다
+			iovec iov[2];
+			iov[0].iov_base = session->RecvRingBuffer.GetWriteBuffer();
+			iov[0].iov_len = session->RecvRingBuffer.GetSizeDirectEnqueueAble();
+			iov[1].iov_base = session->RecvRingBuffer.GetBufferBegin();
+			iov[1].iov_len = session->RecvRingBuffer.GetSizeFree() - session->RecvRingBuffer.GetSizeDirectEnqueueAble();
+			if (iov[1].iov_len > (size_t)session->RecvRingBuffer.GetSizeTotal()) iov[1].iov_len = 0;
+
+			size_t recvRequested = iov[0].iov_len + iov[1].iov_len;
+
+			ssize_t recvResult = readv((int)session->socket, iov, 2);
+			if (recvResult > 0)
+			{
+				RecvProc(session, (DWORD)recvResult);
+
+				// 요청보다 적게 읽었다면 소켓 수신 버퍼를 모두 비운 것이므로, EAGAIN을 확인하기 위한 readv를 생략합니다
+				// 연결 종료 통지를 받은 경우에는 0바이트 수신을 확인해야 하므로 생략하지 않습니다
+				if ((size_t)recvResult < recvRequested && !(readinessObserved & EPOLL_READINESS_HANGUP))
+				{
+					if (InterlockedCompareExchange(&session->RecvOverlapped.readiness, 0, readinessObserved) == readinessObserved) return;
+					readinessObserved = session->RecvOverlapped.readiness;
+				}
+				continue;
+			}
+
+			int errorCode = recvResult == -1 ? errno : 0;
+			if (errorCode == EINTR) continue;
+			if (errorCode == EAGAIN || errorCode == EWOULDBLOCK)
+			{
+				// 읽는 동안 새로운 통지가 없었다면 수신을 마칩니다
+				if (InterlockedCompareExchange(&session->RecvOverlapped.readiness, 0, readinessObserved) == readinessObserved) return;
+				readinessObserved = session->RecvOverlapped.readiness;
+				continue;
+			}
+
+			// 연결이 끊겼거나 수신이 실패한 경우, errorCode가 ECONNRESET, EHOSTDOWN이 아니라면 예외를 발생시킵니다
+			if (errorCode != 0 && errorCode != ECONNRESET && errorCode != EHOSTDOWN)
+			{
+				EXCEPTION(EXCEPTION_SOCKET_RECV, errorCode);
+			}
+
+			// 더 이상 수신 통지를 처리하지 않도록 표시하고, 등록할 때 잡아둔 IO Count를 감소시킵니다
+			InterlockedExchange(&session->RecvOverlapped.readiness, EPOLL_READINESS_CLOSED);
+			if (InterlockedDecrement(&session->ioCount) == 0)
+			{
+				RemoveSession(session);
+			}
+			return;
+		}
+	}
+
+	INT32 IOCPServer::LoadSendVector(Session *session, iovec *iov, size_t *outVectorCount)
+	{
+		// sendZeroCopy 설정이라면 송신 큐에서 꺼낸 패킷들을, 아니라면 송신 링버퍼의 보낼 구간을 담습니다
+		if (serverSettings.sendZeroCopy)
+		{
+			INT32 sendSize = LoadSendGather(session);
+			for (int i = 0; i < session->SendGatherCount; i++)
+			{
+				SerializedBuffer *packet = session->SendGather[i]->packet;
+				INT32 sentOffset = i == 0 ? session->SendGatherOffset : 0;
+				iov[i].iov_base = packet->GetBufferRead() + sentOffset;
+				iov[i].iov_len = packet->GetBufferSizeUsed() - sentOffset;
+			}
+			*outVectorCount = session->SendGatherCount;
+			return sendSize;
+		}
+
+		RingBuffer::Reservation readable;
+		INT32 sendSize = session->SendRingBuffer.LoadReadable(&readable);
+		iov[0].iov_base = readable.first;
+		iov[0].iov_len = readable.firstSize;
+		iov[1].iov_base = readable.second;
+		iov[1].iov_len = readable.secondSize;
+		*outVectorCount = readable.secondSize > 0 ? 2 : 1;
+		return sendSize;
+	}
+
+	VOID IOCPServer::SendPost(Session *session)
+	{
+		// io_uring 백엔드라면 그쪽에서 송신을 요청합니다
+		if (serverSettings.ioBackend != IO_BACKEND_EPOLL)
+		{
+			SendPostUring(session);
+			return;
+		}
+
+		while (true)
+		{
+			// 만일 Send IO가 이미 진행중이라면 함수를 빠져나갑니다
+			if (InterlockedExchange(&session->ioFlag, true) == true) return;
+
+			// iovec 구조체를 송신 링버퍼의 보낼 구간, 혹은 송신 큐에서 꺼낸 패킷들로 초기화합니다
+			iovec iov[SESSION_SEND_GATHER_MAX];
+			size_t iovCount = 0;
+			int sendSize = LoadSendVector(session, iov, &iovCount);
+
+			// 보낼 데이터가 없다면 함수를 빠져나갑니다
+			// 플래그를 내리는 사이에 다른 스레드가 넣은 데이터가 있다면 다시 시도합니다
+			if (sendSize == 0)
+			{
+				InterlockedExchange(&session->ioFlag, false);
+				if (serverSettings.sendZeroCopy)
+				{
+					if (session->SendQueue.IsEmpty()) return;
+				} else
+				{
+					RingBuffer::Reservation readable;
+					if (session->SendRingBuffer.LoadReadable(&readable) == 0) return;
+				}
+				continue;
+			}
+
+			// 연결이 끊긴 소켓에 보내더라도 SIGPIPE가 발생하지 않도록 sendmsg를 사용합니다
+			msghdr message;
+			ZeroMemory(&message, sizeof(message));
+			message.msg_iov = iov;
+			message.msg_iovlen = iovCount;
+			ssize_t sendResult = sendmsg((int)session->socket, &message, MSG_NOSIGNAL);
+			if (sendResult > 0)
+			{
+				// 송신 링버퍼의 ReadBuffer, 혹은 보내는 중인 패킷들을 보낸 만큼 정리합니다
+				if (serverSettings.sendZeroCopy)
+				{
+					CompleteSendGather(session, (INT32)sendResult);
+				} else
+				{
+					session->SendRingBuffer.Consume((int)sendResult);
+				}
+
+				// 추가적으로 송신할 데이터가 있다면 이어서 송신합니다
+				InterlockedExchange(&session->ioFlag, false);
+				continue;
+			}
+
+			int errorCode = sendResult == -1 ? errno : 0;
+			if (errorCode == EINTR)
+			{
+				InterlockedExchange(&session->ioFlag, false);
+				continue;
+			}
+			if (errorCode == EAGAIN || errorCode == EWOULDBLOCK)
+			{
+				// 소켓 송신 버퍼가 가득 찼으므로, ioFlag를 든 채로 송신 준비 통지를 기다립니다
+				InterlockedExchange(&session->SendOverlapped.readiness, 1);
+
+				// 표시하기 전에 이미 쓰기 가능해졌다면 통지를 놓쳤을 수 있으므로 직접 확인합니다
+				pollfd writable;
+				writable.fd = (int)session->socket;
+				writable.events = POLLOUT;
+				writable.revents = 0;
+				if (poll(&writable, 1, 0) > 0 && InterlockedExchange(&session->SendOverlapped.readiness, 0) == 1)
+				{
+					InterlockedExchange(&session->ioFlag, false);
+					continue;
+				}
+				return;
+			}
+
+			// 송신이 실패한 경우, errorCode가 ECONNRESET, EPIPE가 아니라면 예외를 발생시킵니다
+			// IOCP와 같이 ioFlag를 내리지 않으며, 세션 정리는 수신 쪽에서 연결 종료를 감지하여 처리합니다
+			if (errorCode != ECONNRESET && errorCode != EPIPE)
+			{
+				EXCEPTION(EXCEPTION_SOCKET_SEND, errorCode);
+			}
+			return;
+		}
+	}
+
+	VOID IOCPServer::SendReady(Session *session)
+	{
+		// 송신 버퍼가 가득 차 멈춰있던 세션이 아니라면 무시합니다
+		if (InterlockedExchange(&session->SendOverlapped.readiness, 0) != 1) return;
+
+		// ioFlag를 넘겨받아 송신을 재개합니다
+		InterlockedExchange(&session->ioFlag, false);
+		SendPost(session);
+	}
+
+	VOID IOCPServer::PostNotify(ServerShard *shard, DWORD64 notifyKey)
+	{
+		// 통지를 큐에 넣은 뒤 eventfd 카운터를 올려 WorkerThread를 깨웁니다
+		// 논블로킹 eventfd는 카운터가 넘칠 때만 EAGAIN이 나며, 그때도 이미 깨울 통지가 남아 있으므로 무시합니다
+		AcquireSRWLockExclusive(&shard->notifySRW);
+		shard->notifyQueue.push_back(notifyKey);
+		ReleaseSRWLockExclusive(&shard->notifySRW);
+
+		UINT64 wakeCount = 1;
+		if (write(shard->handleNotify, &wakeCount, sizeof(wakeCount)) != sizeof(wakeCount) && errno != EAGAIN)
+		{
+			EXCEPTION(EXCEPTION_IOCP, errno);
+		}
+	}
+
+	VOID IOCPServer::AcceptReady(ServerShard *shard)
+	{
+		// 다른 WorkerThread가 이미 수락 중이라면 통지 횟수만 남기고 빠져나갑니다
+		DWORD readinessObserved = InterlockedIncrement(&shard->acceptReadiness);
+		if (readinessObserved != 1) return;
+
+		Session *acceptedSessions[EPOLL_ACCEPT_BATCH_MAX];
+		INT32 acceptBatchSize = serverSettings.acceptPostCount < EPOLL_ACCEPT_BATCH_MAX ? serverSettings.acceptPostCount : EPOLL_ACCEPT_BATCH_MAX;
+
+		while (true)
+		{
+			INT32 acceptedCount = 0;
+			int errorCode = 0;
+
+			// 대기중인 접속을 묶음 크기만큼 수락합니다
+			while (acceptedCount < acceptBatchSize)
+			{
+				// accept를 호출합니다, 받은 소켓은 엣지 트리거로 사용하기 위해 논블로킹으로 설정합니다
+				SOCKADDR_IN clientAddress;
+				socklen_t clientAddressLength = sizeof(clientAddress);
+				int clientSocket = accept4((int)shard->listenSocket, reinterpret_cast<PSOCKADDR>(&clientAddress), &clientAddressLength, SOCK_NONBLOCK | SOCK_CLOEXEC);
+				if (clientSocket == -1)
+				{
+					// 접속 요청한 클라이언트가 먼저 연결을 끊은 경우라면 다음 접속을 수락합니다
+					errorCode = errno;
+					if (errorCode == EINTR || errorCode == ECONNABORTED) continue;
+					break;
+				}
+
+				// 세션 테이블에서 이 샤드의 세션을 할당하여 접속 허용 여부를 확인하고 세션을 생성합니다
+				Session *session = sessionTable->Alloc(shard->shardIndex);
+				if (session == nullptr)
+				{
+					EXCEPTION(EXCEPTION_SESSION_CREATE);
+					close(clientSocket);
+					continue;
+				}
+				if (AcceptSession(session, (SOCKET)clientSocket, &clientAddress))
+				{
+					acceptedSessions[acceptedCount++] = session;
+				}
+			}
+
+			// 수락된 세션들을 알리고 수신을 시작시킵니다
+			if (acceptedCount > 0)
+			{
+				ConnectSessions(acceptedSessions, acceptedCount);
+			}
+
+			// 묶음을 가득 채웠다면 이어서 수락합니다
+			if (errorCode == 0) continue;
+
+			if (errorCode == EAGAIN || errorCode == EWOULDBLOCK)
+			{
+				// 수락하는 동안 새로운 통지가 없었다면 수락을 마칩니다
+				if (InterlockedCompareExchange(&shard->acceptReadiness, 0, readinessObserved) == readinessObserved) return;
+				readinessObserved = shard->acceptReadiness;
+				continue;
+			}
+
+			// accept가 실패한 경우, errorCode가 EBADF, EINVAL, ENOTSOCK이라면 listenSocket이 닫힌 서버 종료이므로 그대로 빠져나갑니다
+			if (errorCode == EBADF || errorCode == EINVAL || errorCode == ENOTSOCK) return;
+
+			// 그 외의 실패(EMFILE 등)는 예외를 발생시키고, 다음 접속 준비 통지에서 다시 수락하도록 합니다
+			EXCEPTION(EXCEPTION_SOCKET_ACCEPT, errorCode);
+			InterlockedExchange(&shard->acceptReadiness, 0);
+			return;
+		}
+	}
+
+	UINT WINAPI	IOCPServer::WorkerThread(PVOID param)
+	{
+		ServerShard *shard = (ServerShard *)param;
+		epoll_event events[EPOLL_EVENT_MAX];
+		INT32 eventCount = 0;
+		Session *session = nullptr;
+		vector<DWORD64> notifyKeys;
+
+		while (true)
+		{
+			// epoll 준비 통지를 대기합니다
+			eventCount = epoll_wait(shard->handleEpoll, events, EPOLL_EVENT_MAX, -1);
+			if (eventCount == -1)
+			{
+				if (errno != EINTR)
+				{
+					EXCEPTION(EXCEPTION_IOCP, errno);
+				}
+				continue;
+			}
+
+			for (int i = 0; i < eventCount; i++)
+			{
+				// 통지 eventfd의 이벤트라면 통지 큐를 비우며 PostQueuedCompletionStatus로 전달된 값과 같이 처리합니다
+				// eventfd를 먼저 비우고 큐를 가져오므로, 그 사이에 들어온 통지는 다시 올라간 eventfd로 다음에 처리됩니다
+				if (events[i].data.u64 == EPOLL_NOTIFY_KEY)
+				{
+					UINT64 wakeCount;
+					if (read(shard->handleNotify, &wakeCount, sizeof(wakeCount)) == -1 && errno != EAGAIN)
+					{
+						EXCEPTION(EXCEPTION_IOCP, errno);
+					}
+
+					AcquireSRWLockExclusive(&shard->notifySRW);
+					notifyKeys.swap(shard->notifyQueue);
+					ReleaseSRWLockExclusive(&shard->notifySRW);
+
+					BOOL isShutdown = false;
+					for (size_t k = 0; k < notifyKeys.size(); k++)
+					{
+						// 만일 notifyKey가 0xffffffff라면 종료를 의미합니다
+						if (notifyKeys[k] == 0xffffffff)
+						{
+							isShutdown = true;
+							continue;
+						}
+
+						// 그 외에는 세션 종료를 의미합니다
+						OnSessionDisconnected(notifyKeys[k]);
+					}
+					notifyKeys.clear();
+
+					// 종료 통지는 다른 WorkerThread를 위해 다시 넣어둡니다
+					if (isShutdown)
+					{
+						PostNotify(shard, 0xffffffff);
+						return 0;
+					}
+					continue;
+				}
+
+				// listenSocket의 준비 통지라면 대기중인 접속을 수락합니다
+				if (events[i].data.u64 == ACCEPT_COMPLETION_KEY)
+				{
+					AcceptReady(shard);
+					continue;
+				}
+
+				// 준비 통지를 받은 세션을 얻어옵니다
+				// 엣지 트리거 통지는 세션이 정리된 후에도 늦게 도착할 수 있으므로, 찾지 못했다면 무시합니다
+				session = AcquireSession(events[i].data.u64);
+				if (session == nullptr) continue;
+
+				// 통지의 종류에 따라 처리합니다
+				if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+				{
+					RecvReady(session, events[i].events);
+				}
+				if (events[i].events & EPOLLOUT)
+				{
+					SendReady(session);
+				}
+
+				// 세션을 반환합니다
+				ReturnSession(session);
+			}
+		}
+
+		return -1;
+	}
+
+}
+
+#endif
@@ -16,6 +16,16 @@ namespace azely
 		const string workerThreadRunningKey = "workerThreadRunning";
 		const string sessionCountMaxKey = "sessionCountMax";
 		const string sessionTimeoutKey = "sessionTimeout";
+		const string acceptPostCountKey = "acceptPostCount";
+		const string shardCountKey = "shardCount";
+		const string timeoutTickKey = "timeoutTick";
+		const string logicThreadCountKey = "logicThreadCount";
+		const string inlineDispatchKey = "inlineDispatch";
+		const string ringBufferMirroredKey = "ringBufferMirrored";
+		const string sendQueueModeKey = "sendQueueMode";
+		const string sendZeroCopyKey = "sendZeroCopy";
+		const string messageSizeMaxKey = "messageSizeMax";
+		const string ioBackendKey = "ioBackend";
 
 		struct Settings
 		{
@@ -58,6 +68,73 @@ namespace azely
 			// 세션 타임아웃 설정값 (ms)
 			// Setting File Key Name : sessionTimeout
 			INT32	sessionTimeout = 30000;
+
+			// 동시에 걸어둘 비동기 accept 요청 개수 (AcceptEx)
+			// epoll 백엔드에서는 한 번의 준비 통지에서 묶어서 처리할 최대 accept 개수로 사용합니다
+			// 만일 0이라면, 64
+			// Setting File Key Name : acceptPostCount
+			INT32	acceptPostCount = 0;
+
+			// 샤드 개수 : 샤드마다 listenSocket(SO_REUSEPORT), 완료 통지 핸들, WorkerThread, 세션 테이블의 빈 슬롯을 따로 가집니다
+			// WorkerThread 개수는 샤드 개수로 나누어 배정합니다
+			// Windows 에서는 listenSocket 하나로 수락한 세션을 샤드에 돌아가며 배정합니다
+			// 만일 0이라면, 1
+			// Setting File Key Name : shardCount
+			INT32	shardCount = 1;
+
+			// 세션 타임아웃 타이머 휠의 한 틱 길이 (ms)
+			// 타임아웃은 만료 시간으로부터 최대 한 틱 늦게 통지됩니다
+			// 만일 0이라면, 10
+			// Setting File Key Name : timeoutTick
+			INT32	timeoutTick = 10;
+
+			// OnRecvMessage를 호출하는 PacketThread 개수
+			// 메시지는 세션 ID의 해시로 PacketThread를 골라 넣으므로, 한 세션의 메시지는 항상 같은 스레드에서 순서대로 처리됩니다
+			// 만일 0이라면, 1 (최대 LOGIC_THREAD_MAX)
+			// Setting File Key Name : logicThreadCount
+			INT32	logicThreadCount = 1;
+
+			// 인라인 디스패치 설정값
+			// 만일 1이라면, 수신한 WorkerThread에서 먼저 OnRecvMessage(DWORD64, PacketView &)로 링버퍼 안의 메시지를 복사 없이 넘깁니다
+			// 거기서 false를 반환하면 패킷에 복사하여 OnRecvMessageInline을 호출하고, 여기서도 false를 반환한 메시지만 메시지 큐를 거쳐 PacketThread로 넘어갑니다
+			// Setting File Key Name : inlineDispatch
+			INT32	inlineDispatch = 0;
+
+			// 링버퍼 미러 모드 설정값
+			// 만일 1이라면, 세션의 송수신 링버퍼를 같은 메모리를 두 번 이어 매핑한 버퍼로 만들어 경계에서 메시지가 나뉘지 않게 합니다
+			// 링버퍼 크기는 할당 단위로 올림되므로 (Windows 64KB), 세션마다 사용하는 메모리가 늘어납니다
+			// Setting File Key Name : ringBufferMirrored
+			INT32	ringBufferMirrored = 0;
+
+			// 세션 송신 링버퍼의 동기화 방식
+			// 0이라면 SRW 락, 1이라면 SPSC lock-free, 2라면 MPSC lock-free
+			// SPSC는 한 세션에 대한 SendPacket 호출이 한 스레드에서만 일어날 때만 사용할 수 있습니다 (예: inlineDispatch 없이 PacketThread에서만 송신)
+			// MPSC는 송신하는 스레드끼리 서로를 기다리지 않아, 스레드 수가 코어 수보다 많아도 처리량이 유지됩니다 (Benchmark/RingBufferBench.cpp)
+			// MPSC는 세션마다 커밋 슬롯(RingBuffer::MPSC_SLOT_COUNT * 8 바이트)을 더 사용합니다
+			// 만일 범위를 벗어난다면, 0
+			// Setting File Key Name : sendQueueMode
+			INT32	sendQueueMode = 0;
+
+			// 제로 카피 송신 설정값
+			// 만일 1이라면, 보낼 메시지를 송신 링버퍼에 복사하지 않고 세션의 송신 큐에 참조로 넣은 뒤 여러 개를 모아 한 번에 송신합니다
+			// 세션마다 송신 링버퍼 크기의 송신 제한이 없어지며, SendPacketPooled로 보내는 메시지는 복사되지 않습니다
+			// Setting File Key Name : sendZeroCopy
+			INT32	sendZeroCopy = 0;
+
+			// 주고받을 수 있는 메시지 페이로드의 최대 크기 (byte)
+			// 이보다 큰 메시지를 보내는 세션은 헤더만 보고 종료합니다 / 수신 링버퍼보다 큰 메시지는 크기에 맞는 패킷을 따로 할당하여 모읍니다
+			// 송신 링버퍼에 들어가지 않는 크기라면, sendZeroCopy를 켭니다
+			// 만일 0이라면, 8192 (최대 NETWORK_MESSAGE_SIZE_LIMIT)
+			// Setting File Key Name : messageSizeMax
+			INT32	messageSizeMax = 8192;
+
+			// Linux 입출력 백엔드 설정값 (Windows에서는 무시하고 IOCP를 사용합니다)
+			// 0이라면 epoll, 1이라면 io_uring multishot 수신, 2라면 io_uring 고정 버퍼 수신 (세션의 수신 링버퍼를 커널에 등록해 둡니다)
+			// io_uring은 WorkerThread마다 링을 하나씩 두어, 요청을 모아 한 번의 io_uring_enter로 제출하고 완료를 여러 개씩 거둡니다
+			// 1은 세션 테이블 슬롯이 65536개 이하이고 커널이 부분 소비 버퍼 링을 지원할 때만 사용할 수 있으며, 아니라면 2로 바꿉니다
+			// 만일 범위를 벗어난다면, 혹은 io_uring을 만들 수 없는 커널이라면, 0
+			// Setting File Key Name : ioBackend
+			INT32	ioBackend = 0;
 		};
 
 	}
@@ -0,0 +1,639 @@
+﻿#include "IOCPServer.h"
+
+//----------------------------------------------------------
+// Linux io_uring 백엔드 (ioBackend 1, 2)
+// liburing 없이 io_uring_setup, io_uring_enter, io_uring_register 시스템 콜과 mmap한 제출, 완료 큐를 직접 사용합니다
+// WorkerThread마다 링을 하나씩 두며, 세션은 슬롯 번호로 정해진 링에서 수신합니다
+// 세션, 링버퍼, IO Count 규칙과 컨텐츠 콜백은 IOCP, epoll 백엔드와 동일합니다 (걸어둔 요청마다 IO Count를 하나씩 잡습니다)
+//----------------------------------------------------------
+#ifndef _WIN32
+
+#define EXCEPTION(CODE, ...) do {HandleException(__FUNCTIONW__, __LINE__, CODE, ##__VA_ARGS__);} while(0)
+
+#define URING_SUBMIT_ENTRIES 1024
+#define URING_COMPLETE_ENTRIES 16384
+#define URING_ACCEPT_BATCH_MAX 256
+
+// 완료의 user_data (세션 요청은 64바이트 정렬된 세션 주소의 하위 비트에 요청 종류를 담습니다)
+#define URING_NOTIFY_KEY 0
+#define URING_OP_RECV 2
+#define URING_OP_SEND 3
+#define URING_OP_MASK 0x3f
+
+// multishot 수신에서 슬롯마다 두는 버퍼 링의 항목 개수와, 수신 링버퍼를 나누어 빌려주는 조각 개수
+// 조각이 버퍼 끝에서 잘리더라도 빌려준 구간은 항목 10개를 넘지 않습니다
+#define URING_RECV_BUFFER_ENTRIES 16
+#define URING_RECV_CHUNK_COUNT 8
+
+// 오래된 커널 헤더에는 없는 부분 소비 버퍼 링 정의
+#ifndef IOU_PBUF_RING_INC
+#define IOU_PBUF_RING_INC 2
+#endif
+
+namespace azely
+{
+
+	/**
+	 * \brief IORING_REGISTER_PBUF_RING 인자 (헤더 버전마다 flags 필드 이름이 달라 커널 ABI 그대로 정의합니다)
+	 */
+	struct UringBufferRegister
+	{
+		UINT64	ringAddress;
+		UINT32	ringEntries;
+		USHORT	groupID;
+		USHORT	flags;
+		UINT64	reserved[3];
+	};
+
+	// 현재 스레드가 가진 링 (링을 가진 WorkerThread만 설정됩니다)
+	static thread_local PVOID currentRing = nullptr;
+
+	static int SetupUring(UINT32 entries, io_uring_params *params)
+	{
+		return (int)syscall(__NR_io_uring_setup, entries, params);
+	}
+
+	static int EnterUring(int handleRing, UINT32 submitCount, UINT32 waitCount, UINT32 flags)
+	{
+		return (int)syscall(__NR_io_uring_enter, handleRing, submitCount, waitCount, flags, nullptr, 0);
+	}
+
+	static int RegisterUring(int handleRing, UINT32 opcode, PVOID arg, UINT32 argCount)
+	{
+		return (int)syscall(__NR_io_uring_register, handleRing, opcode, arg, argCount);
+	}
+
+	/**
+	 * \brief 슬롯 하나의 버퍼 링으로 쓸 페이지를 할당하고, 부분 소비 버퍼 링으로 등록합니다
+	 * \return 등록한 버퍼 링, 실패했다면 nullptr
+	 */
+	static io_uring_buf_ring *RegisterRecvBufferRing(int handleRing, USHORT groupID)
+	{
+		// 버퍼 링은 페이지 경계에 있어야 합니다
+		size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+		io_uring_buf_ring *bufferRing = static_cast<io_uring_buf_ring *>(_aligned_malloc(pageSize, pageSize));
+		if (bufferRing == nullptr) return nullptr;
+		ZeroMemory(bufferRing, pageSize);
+
+		UringBufferRegister bufferRegister;
+		ZeroMemory(&bufferRegister, sizeof(bufferRegister));
+		bufferRegister.ringAddress = (UINT64)bufferRing;
+		bufferRegister.ringEntries = URING_RECV_BUFFER_ENTRIES;
+		bufferRegister.groupID = groupID;
+		bufferRegister.flags = IOU_PBUF_RING_INC;
+		if (RegisterUring(handleRing, IORING_REGISTER_PBUF_RING, &bufferRegister, 1) == -1)
+		{
+			_aligned_free(bufferRing);
+			return nullptr;
+		}
+		return bufferRing;
+	}
+
+	INT32 IOCPServer::ProbeUringBackend(INT32 ioBackend)
+	{
+		if (ioBackend == IO_BACKEND_EPOLL) return IO_BACKEND_EPOLL;
+
+		// 작은 링을 만들어 보고, 만들 수 없다면 epoll을 사용합니다
+		io_uring_params params;
+		ZeroMemory(&params, sizeof(params));
+		int handleRing = SetupUring(4, &params);
+		if (handleRing == -1) return IO_BACKEND_EPOLL;
+
+		// 제출, 완료 큐를 한 번에 매핑할 수 없는 오래된 커널도 epoll을 사용합니다
+		if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP))
+		{
+			close(handleRing);
+			return IO_BACKEND_EPOLL;
+		}
+
+		// multishot 수신은 부분 소비 버퍼 링을 등록할 수 있어야 합니다
+		if (ioBackend == IO_BACKEND_URING_MULTISHOT)
+		{
+			io_uring_buf_ring *bufferRing = RegisterRecvBufferRing(handleRing, 0);
+			if (bufferRing == nullptr)
+			{
+				ioBackend = IO_BACKEND_URING_FIXED;
+			}
+			close(handleRing);
+			_aligned_free(bufferRing);
+			return ioBackend;
+		}
+
+		close(handleRing);
+		return ioBackend;
+	}
+
+	BOOL IOCPServer::ReadyUring(ServerShard *shard, INT32 ringCount)
+	{
+		shard->rings = new UringRing[ringCount];
+		shard->ringCount = ringCount;
+
+		for (int i = 0; i < ringCount; i++)
+		{
+			UringRing *ring = &shard->rings[i];
+			ring->shard = shard;
+			ring->ringIndex = i;
+
+			// 멀티샷 요청은 한 번 제출로 완료를 여러 개 만들므로, 완료 큐를 제출 큐보다 크게 만듭니다
+			io_uring_params params;
+			ZeroMemory(&params, sizeof(params));
+			params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL;
+			params.cq_entries = URING_COMPLETE_ENTRIES;
+			ring->handleRing = SetupUring(URING_SUBMIT_ENTRIES, &params);
+			if (ring->handleRing == -1)
+			{
+				EXCEPTION(EXCEPTION_IOCP_CREATION, errno);
+				return false;
+			}
+
+			// 제출 큐와 완료 큐를 한 번에 매핑하고, 요청 배열을 따로 매핑합니다
+			size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(UINT32);
+			size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			ring->mapRingSize = sqSize > cqSize ? sqSize : cqSize;
+			ring->mapRing = mmap(nullptr, ring->mapRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->handleRing, IORING_OFF_SQ_RING);
+			ring->mapSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+			PVOID mapSqes = mmap(nullptr, ring->mapSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->handleRing, IORING_OFF_SQES);
+			if (ring->mapRing == MAP_FAILED || mapSqes == MAP_FAILED)
+			{
+				EXCEPTION(EXCEPTION_IOCP_CREATION, errno);
+				return false;
+			}
+
+			char *mapRing = static_cast<char *>(ring->mapRing);
+			ring->sqHead = reinterpret_cast<UINT32 *>(mapRing + params.sq_off.head);
+			ring->sqTail = reinterpret_cast<UINT32 *>(mapRing + params.sq_off.tail);
+			ring->sqArray = reinterpret_cast<UINT32 *>(mapRing + params.sq_off.array);
+			ring->sqMask = *reinterpret_cast<UINT32 *>(mapRing + params.sq_off.ring_mask);
+			ring->sqEntries = params.sq_entries;
+			ring->sqes = static_cast<io_uring_sqe *>(mapSqes);
+			ring->cqHead = reinterpret_cast<UINT32 *>(mapRing + params.cq_off.head);
+			ring->cqTail = reinterpret_cast<UINT32 *>(mapRing + params.cq_off.tail);
+			ring->cqMask = *reinterpret_cast<UINT32 *>(mapRing + params.cq_off.ring_mask);
+			ring->cqes = reinterpret_cast<io_uring_cqe *>(mapRing + params.cq_off.cqes);
+
+			// 고정 버퍼 읽기라면 이 링이 맡은 슬롯들의 수신 링버퍼를 슬롯 번호를 인덱스로 등록합니다
+			// 다른 링이 맡은 슬롯은 빈 항목으로 두며, 등록할 수 없다면(등록 개수 제한, 잠금 메모리 제한) 일반 수신을 사용합니다
+			if (serverSettings.ioBackend == IO_BACKEND_URING_FIXED)
+			{
+				INT32 capacity = sessionTable->GetCapacity();
+				vector<iovec> fixedBuffers(capacity);
+				for (int slot = 0; slot < capacity; slot++)
+				{
+					fixedBuffers[slot].iov_base = nullptr;
+					fixedBuffers[slot].iov_len = 0;
+					if (slot % serverSettings.shardCount != shard->shardIndex || (slot / serverSettings.shardCount) % ringCount != i) continue;
+
+					// 미러 모드의 수신 링버퍼는 같은 메모리를 두 번 이어 매핑하므로, 두 번째 매핑까지 등록합니다
+					RingBuffer &recvRingBuffer = sessionTable->At(slot)->RecvRingBuffer;
+					size_t bufferSize = recvRingBuffer.GetBufferEnd() - recvRingBuffer.GetBufferBegin();
+					fixedBuffers[slot].iov_base = recvRingBuffer.GetBufferBegin();
+					fixedBuffers[slot].iov_len = recvRingBuffer.IsMirrored() ? bufferSize * 2 : bufferSize;
+				}
+				ring->isFixedBufferRegistered = RegisterUring(ring->handleRing, IORING_REGISTER_BUFFERS, fixedBuffers.data(), capacity) == 0;
+			}
+
+			// 통지 eventfd에 multishot 준비 통지를 걸어둡니다
+			io_uring_sqe sqe;
+			ZeroMemory(&sqe, sizeof(sqe));
+			sqe.opcode = IORING_OP_POLL_ADD;
+			sqe.fd = shard->handleNotify;
+			sqe.poll32_events = POLLIN;
+			sqe.len = IORING_POLL_ADD_MULTI;
+			sqe.user_data = URING_NOTIFY_KEY;
+			SubmitUring(ring, &sqe);
+		}
+
+		return true;
+	}
+
+	VOID IOCPServer::ReleaseUring(ServerShard *shard)
+	{
+		// 링을 닫으면 남아있는 요청은 모두 취소되고, 등록한 버퍼도 풀립니다
+		for (int i = 0; i < shard->ringCount; i++)
+		{
+			UringRing *ring = &shard->rings[i];
+			if (ring->sqes != nullptr) munmap(ring->sqes, ring->mapSqesSize);
+			if (ring->mapRing != MAP_FAILED) munmap(ring->mapRing, ring->mapRingSize);
+			if (ring->handleRing != -1) close(ring->handleRing);
+		}
+		delete[] shard->rings;
+		shard->rings = nullptr;
+		shard->ringCount = 0;
+
+		// 샤드의 슬롯에 빌려주었던 버퍼 링을 반환합니다
+		for (int slot = shard->shardIndex; slot < sessionTable->GetCapacity(); slot += serverSettings.shardCount)
+		{
+			Session *session = sessionTable->At(slot);
+			if (session->RecvBufferRing == nullptr) continue;
+			_aligned_free(session->RecvBufferRing);
+			session->RecvBufferRing = nullptr;
+		}
+	}
+
+	VOID IOCPServer::SubmitUring(UringRing *ring, const io_uring_sqe *sqe)
+	{
+		AcquireSRWLockExclusive(&ring->submitSRW);
+
+		// 제출 큐가 가득 찼다면 쌓인 요청을 먼저 제출합니다
+		UINT32 sqTail = *ring->sqTail;
+		while (sqTail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) >= ring->sqEntries)
+		{
+			if (EnterUring(ring->handleRing, ring->sqEntries, 0, 0) == -1 && errno != EINTR && errno != EBUSY && errno != EAGAIN)
+			{
+				EXCEPTION(EXCEPTION_IOCP, errno);
+			}
+		}
+
+		UINT32 index = sqTail & ring->sqMask;
+		ring->sqes[index] = *sqe;
+		ring->sqArray[index] = index;
+		__atomic_store_n(ring->sqTail, sqTail + 1, __ATOMIC_RELEASE);
+
+		ReleaseSRWLockExclusive(&ring->submitSRW);
+
+		// 링을 가진 WorkerThread라면 다음 대기 때 모아서 제출하고, 다른 스레드라면 바로 제출합니다
+		if (currentRing == ring) return;
+		if (EnterUring(ring->handleRing, ring->sqEntries, 0, 0) == -1 && errno != EINTR && errno != EBUSY && errno != EAGAIN)
+		{
+			EXCEPTION(EXCEPTION_IOCP, errno);
+		}
+	}
+
+	VOID IOCPServer::ArmAcceptUring(UringRing *ring)
+	{
+		// 서버 종료로 listenSocket이 닫혔다면 걸지 않습니다
+		SOCKET listenSocket = ring->shard->listenSocket;
+		if (listenSocket == INVALID_SOCKET) return;
+
+		// 받은 소켓은 io_uring이 직접 대기하므로 블로킹으로 둡니다
+		io_uring_sqe sqe;
+		ZeroMemory(&sqe, sizeof(sqe));
+		sqe.opcode = IORING_OP_ACCEPT;
+		sqe.fd = (int)listenSocket;
+		sqe.ioprio = IORING_ACCEPT_MULTISHOT;
+		sqe.accept_flags = SOCK_CLOEXEC;
+		sqe.user_data = ACCEPT_COMPLETION_KEY;
+		ring->isAcceptArmed = true;
+		SubmitUring(ring, &sqe);
+	}
+
+	VOID IOCPServer::ArmRecvUring(Session *session)
+	{
+		UringRing *ring = GetUringRing(session);
+		io_uring_sqe sqe;
+		ZeroMemory(&sqe, sizeof(sqe));
+		sqe.fd = (int)session->socket;
+		sqe.user_data = (DWORD64)session | URING_OP_RECV;
+
+		if (serverSettings.ioBackend == IO_BACKEND_URING_MULTISHOT)
+		{
+			// 슬롯의 버퍼 링에서 빌려준 구간을 골라 받으며, 요청 하나가 연결이 끝날 때까지 계속 완료를 만듭니다
+			sqe.opcode = IORING_OP_RECV;
+			sqe.ioprio = IORING_RECV_MULTISHOT;
+			sqe.flags = IOSQE_BUFFER_SELECT;
+			sqe.buf_group = (USHORT)sessionTable->GetSlotIndex(session->sessionID);
+		} else
+		{
+			// 수신 링버퍼의 쓰기 위치부터 끊김 없이 쓸 수 있는 만큼 읽습니다
+			sqe.opcode = IORING_OP_RECV;
+			sqe.addr = (UINT64)session->RecvRingBuffer.GetWriteBuffer();
+			sqe.len = session->RecvRingBuffer.GetSizeDirectEnqueueAble();
+			if (ring->isFixedBufferRegistered)
+			{
+				sqe.opcode = IORING_OP_READ_FIXED;
+				sqe.buf_index = (USHORT)sessionTable->GetSlotIndex(session->sessionID);
+			}
+		}
+
+		SubmitUring(ring, &sqe);
+	}
+
+	VOID IOCPServer::ProvideUringRecv(Session *session)
+	{
+		RingBuffer &recvRingBuffer = session->RecvRingBuffer;
+		char *bufferBegin = recvRingBuffer.GetBufferBegin();
+		DWORD64 bufferSize = recvRingBuffer.GetBufferEnd() - bufferBegin;
+		DWORD64 chunkSize = bufferSize / URING_RECV_CHUNK_COUNT;
+		DWORD64 readSize = session->RecvWrittenSize - recvRingBuffer.GetSizeUsed();
+		io_uring_buf_ring *bufferRing = session->RecvBufferRing;
+		USHORT bufferTail = session->RecvBufferTail;
+
+		// C++ 에서는 헤더의 빈 구조체를 끼운 bufs 배열이 8바이트 밀려 선언되므로, 항목 배열은 버퍼 링의 시작 주소에서 직접 가리킵니다
+		io_uring_buf *buffers = reinterpret_cast<io_uring_buf *>(bufferRing);
+
+		while (true)
+		{
+			// 조각이 버퍼 끝을 넘지 않도록 자르며, 빌려준 구간이 아직 읽지 않은 데이터를 덮거나 링버퍼를 가득 채우지 않는 만큼만 빌려줍니다
+			DWORD64 offset = session->RecvProvidedSize % bufferSize;
+			DWORD64 provideSize = bufferSize - offset < chunkSize ? bufferSize - offset : chunkSize;
+			if (session->RecvProvidedSize + provideSize - readSize > bufferSize - 1) break;
+
+			io_uring_buf *buffer = &buffers[bufferTail & (URING_RECV_BUFFER_ENTRIES - 1)];
+			buffer->addr = (UINT64)(bufferBegin + offset);
+			buffer->len = (UINT32)provideSize;
+			buffer->bid = bufferTail & (URING_RECV_BUFFER_ENTRIES - 1);
+			bufferTail++;
+			session->RecvProvidedSize += provideSize;
+		}
+
+		if (bufferTail == session->RecvBufferTail) return;
+		session->RecvBufferTail = bufferTail;
+		__atomic_store_n(&bufferRing->tail, bufferTail, __ATOMIC_RELEASE);
+	}
+
+	VOID IOCPServer::RecvPostUring(Session *session)
+	{
+		// 수신이 끝날 때까지 IOCP의 대기중인 WSARecv처럼 IO Count를 하나 잡아둡니다
+		InterlockedIncrement(&session->ioCount);
+
+		if (serverSettings.ioBackend == IO_BACKEND_URING_MULTISHOT)
+		{
+			// 슬롯을 처음 쓴다면 슬롯 번호를 버퍼 그룹 ID로 하는 버퍼 링을 세션의 링에 등록합니다
+			if (session->RecvBufferRing == nullptr)
+			{
+				session->RecvBufferRing = RegisterRecvBufferRing(GetUringRing(session)->handleRing, (USHORT)sessionTable->GetSlotIndex(session->sessionID));
+				if (session->RecvBufferRing == nullptr)
+				{
+					EXCEPTION(EXCEPTION_SOCKET_RECV, errno);
+					if (InterlockedDecrement(&session->ioCount) == 0)
+					{
+						RemoveSession(session);
+					}
+					return;
+				}
+			}
+
+			// 이전 세션이 빌려주고 남긴 구간을 이어서 쓰도록, 수신 링버퍼의 위치를 커널이 채운 크기에 맞춥니다
+			RingBuffer &recvRingBuffer = session->RecvRingBuffer;
+			int offset = (int)(session->RecvWrittenSize % (DWORD64)(recvRingBuffer.GetBufferEnd() - recvRingBuffer.GetBufferBegin()));
+			recvRingBuffer.MoveWriteBuffer(offset);
+			recvRingBuffer.MoveReadBuffer(offset);
+			ProvideUringRecv(session);
+		}
+
+		ArmRecvUring(session);
+	}
+
+	VOID IOCPServer::RecvCompleteUring(Session *session, INT32 result, UINT32 flags)
+	{
+		BOOL isMultishot = serverSettings.ioBackend == IO_BACKEND_URING_MULTISHOT;
+		if (result > 0)
+		{
+			// multishot 수신은 커널이 쓰기 위치에 채워두었으므로, 처리한 뒤 읽어서 빈 구간을 다시 빌려줍니다
+			if (isMultishot) session->RecvWrittenSize += result;
+			RecvProc(session, (DWORD)result);
+			if (isMultishot) ProvideUringRecv(session);
+		}
+
+		// multishot 수신이 이어진다면 요청이 남아 있습니다
+		if (flags & IORING_CQE_F_MORE) return;
+
+		// 받았거나, 빌려준 구간을 다 써서 끝났지만 다시 빌려주었다면 수신을 다시 겁니다
+		BOOL isRearm = result > 0;
+		if (isMultishot) isRearm = (result > 0 || result == -ENOBUFS) && session->RecvProvidedSize > session->RecvWrittenSize;
+		if (isRearm)
+		{
+			ArmRecvUring(session);
+			return;
+		}
+
+		// 연결이 끊겼거나 수신이 실패한 경우, ECONNRESET, EHOSTDOWN이 아니라면 예외를 발생시킵니다
+		if (result < 0 && result != -ECONNRESET && result != -EHOSTDOWN && result != -ENOBUFS && result != -ECANCELED)
+		{
+			EXCEPTION(EXCEPTION_SOCKET_RECV, -result);
+		}
+
+		// 수신을 걸 때 잡아둔 IO Count를 감소시킵니다
+		if (InterlockedDecrement(&session->ioCount) == 0)
+		{
+			RemoveSession(session);
+		}
+	}
+
+	VOID IOCPServer::SendPostUring(Session *session)
+	{
+		while (true)
+		{
+			// 만일 Send IO가 이미 진행중이라면 함수를 빠져나갑니다
+			if (InterlockedExchange(&session->ioFlag, true) == true) return;
+
+			// 보내는 동안 iovec이 살아있어야 하므로 세션의 iovec 배열을 채웁니다
+			size_t iovCount = 0;
+			int sendSize = LoadSendVector(session, session->SendVector, &iovCount);
+
+			// 보낼 데이터가 없다면 함수를 빠져나갑니다
+			// 플래그를 내리는 사이에 다른 스레드가 넣은 데이터가 있다면 다시 시도합니다
+			if (sendSize == 0)
+			{
+				InterlockedExchange(&session->ioFlag, false);
+				if (serverSettings.sendZeroCopy)
+				{
+					if (session->SendQueue.IsEmpty()) return;
+				} else
+				{
+					RingBuffer::Reservation readable;
+					if (session->SendRingBuffer.LoadReadable(&readable) == 0) return;
+				}
+				continue;
+			}
+
+			// 완료될 때까지 IO Count를 하나 잡고, ioFlag를 든 채로 sendmsg 요청을 넣습니다
+			ZeroMemory(&session->SendMessage, sizeof(session->SendMessage));
+			session->SendMessage.msg_iov = session->SendVector;
+			session->SendMessage.msg_iovlen = iovCount;
+			InterlockedIncrement(&session->ioCount);
+
+			io_uring_sqe sqe;
+			ZeroMemory(&sqe, sizeof(sqe));
+			sqe.opcode = IORING_OP_SENDMSG;
+			sqe.fd = (int)session->socket;
+			sqe.addr = (UINT64)&session->SendMessage;
+			sqe.len = 1;
+			sqe.msg_flags = MSG_NOSIGNAL;
+			sqe.user_data = (DWORD64)session | URING_OP_SEND;
+			SubmitUring(GetUringRing(session), &sqe);
+			return;
+		}
+	}
+
+	VOID IOCPServer::SendCompleteUring(Session *session, INT32 result)
+	{
+		if (result > 0)
+		{
+			// 보낸 만큼 정리하고 ioFlag를 내린 뒤 이어서 송신합니다
+			SendProc(session, (DWORD)result);
+		} else if (result != 0 && result != -ECONNRESET && result != -EPIPE)
+		{
+			// 송신이 실패한 경우, ECONNRESET, EPIPE가 아니라면 예외를 발생시킵니다
+			// IOCP와 같이 ioFlag를 내리지 않으며, 세션 정리는 수신 쪽에서 연결 종료를 감지하여 처리합니다
+			EXCEPTION(EXCEPTION_SOCKET_SEND, -result);
+		}
+
+		// 송신을 요청할 때 잡아둔 IO Count를 감소시킵니다
+		if (InterlockedDecrement(&session->ioCount) == 0)
+		{
+			RemoveSession(session);
+		}
+	}
+
+	UINT WINAPI	IOCPServer::UringWorkerThread(PVOID param)
+	{
+		UringRing *ring = (UringRing *)param;
+		ServerShard *shard = ring->shard;
+		Session *acceptedSessions[URING_ACCEPT_BATCH_MAX];
+		INT32 acceptedCount = 0;
+		vector<DWORD64> notifyKeys;
+		currentRing = ring;
+
+		while (true)
+		{
+			// 모아둔 요청을 제출하며, 거둘 완료가 없다면 하나 이상 올 때까지 대기합니다
+			UINT32 cqHead = *ring->cqHead;
+			BOOL isCompletionEmpty = cqHead == __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+			UINT32 submitCount = __atomic_load_n(ring->sqTail, __ATOMIC_ACQUIRE) - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+			if (submitCount > 0 || isCompletionEmpty)
+			{
+				int enterResult = EnterUring(ring->handleRing, submitCount, isCompletionEmpty ? 1 : 0, isCompletionEmpty ? IORING_ENTER_GETEVENTS : 0);
+				if (enterResult == -1 && errno != EINTR && errno != EBUSY && errno != EAGAIN)
+				{
+					EXCEPTION(EXCEPTION_IOCP, errno);
+				}
+			}
+
+			// 깨어났을 때 쌓여있는 완료를 모두 거둡니다
+			// 처리하는 도중에 넣은 요청은 다음 대기 때 한 번에 제출됩니다
+			UINT32 cqTail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+			while (cqHead != cqTail)
+			{
+				io_uring_cqe cqe = ring->cqes[cqHead & ring->cqMask];
+				cqHead++;
+				__atomic_store_n(ring->cqHead, cqHead, __ATOMIC_RELEASE);
+
+				// 통지 eventfd의 준비 통지라면 epoll 백엔드와 같이 통지 큐를 비우며 처리합니다
+				if (cqe.user_data == URING_NOTIFY_KEY)
+				{
+					UINT64 wakeCount;
+					if (read(shard->handleNotify, &wakeCount, sizeof(wakeCount)) == -1 && errno != EAGAIN)
+					{
+						EXCEPTION(EXCEPTION_IOCP, errno);
+					}
+
+					AcquireSRWLockExclusive(&shard->notifySRW);
+					notifyKeys.swap(shard->notifyQueue);
+					ReleaseSRWLockExclusive(&shard->notifySRW);
+
+					BOOL isShutdown = false;
+					for (size_t k = 0; k < notifyKeys.size(); k++)
+					{
+						// 만일 notifyKey가 0xffffffff라면 종료를 의미합니다
+						if (notifyKeys[k] == 0xffffffff)
+						{
+							isShutdown = true;
+							continue;
+						}
+
+						// 그 외에는 세션 종료를 의미합니다
+						OnSessionDisconnected(notifyKeys[k]);
+					}
+					notifyKeys.clear();
+
+					// 종료 통지는 다른 WorkerThread를 위해 다시 넣어둡니다
+					if (isShutdown)
+					{
+						if (acceptedCount > 0) ConnectSessions(acceptedSessions, acceptedCount);
+						PostNotify(shard, 0xffffffff);
+						currentRing = nullptr;
+						return 0;
+					}
+
+					// 준비 통지가 끝났다면 다시 겁니다
+					if (!(cqe.flags & IORING_CQE_F_MORE))
+					{
+						io_uring_sqe sqe;
+						ZeroMemory(&sqe, sizeof(sqe));
+						sqe.opcode = IORING_OP_POLL_ADD;
+						sqe.fd = shard->handleNotify;
+						sqe.poll32_events = POLLIN;
+						sqe.len = IORING_POLL_ADD_MULTI;
+						sqe.user_data = URING_NOTIFY_KEY;
+						SubmitUring(ring, &sqe);
+					}
+
+					// 파일 디스크립터가 모자라 접속 수락이 멈춰 있었다면, 세션이 정리된 지금 다시 겁니다
+					if (ring->ringIndex == 0 && !ring->isAcceptArmed)
+					{
+						ArmAcceptUring(ring);
+					}
+					continue;
+				}
+
+				// listenSocket의 수락 완료라면 받은 소켓으로 세션을 생성하고, 묶어서 알립니다
+				if (cqe.user_data == ACCEPT_COMPLETION_KEY)
+				{
+					if (cqe.res >= 0)
+					{
+						SOCKADDR_IN clientAddress;
+						socklen_t clientAddressLength = sizeof(clientAddress);
+						Session *session = nullptr;
+						if (getpeername(cqe.res, reinterpret_cast<PSOCKADDR>(&clientAddress), &clientAddressLength) == -1)
+						{
+							// 접속 요청한 클라이언트가 먼저 연결을 끊은 경우입니다
+							close(cqe.res);
+						} else if ((session = sessionTable->Alloc(shard->shardIndex)) == nullptr)
+						{
+							EXCEPTION(EXCEPTION_SESSION_CREATE);
+							close(cqe.res);
+						} else if (AcceptSession(session, (SOCKET)cqe.res, &clientAddress))
+						{
+							acceptedSessions[acceptedCount++] = session;
+							if (acceptedCount == URING_ACCEPT_BATCH_MAX)
+							{
+								ConnectSessions(acceptedSessions, acceptedCount);
+								acceptedCount = 0;
+							}
+						}
+					}
+
+					// 수락 요청이 이어진다면 요청이 남아 있습니다
+					if (cqe.flags & IORING_CQE_F_MORE) continue;
+					ring->isAcceptArmed = false;
+
+					// EBADF, EINVAL, ENOTSOCK, ECANCELED라면 listenSocket이 닫힌 서버 종료이므로 다시 걸지 않습니다
+					if (cqe.res == -EBADF || cqe.res == -EINVAL || cqe.res == -ENOTSOCK || cqe.res == -ECANCELED) continue;
+
+					// 그 외의 실패(EMFILE 등)는 예외를 발생시키고, 세션이 정리되어 종료 통지가 올 때 다시 겁니다
+					if (cqe.res < 0 && cqe.res != -ECONNABORTED && cqe.res != -EINTR)
+					{
+						EXCEPTION(EXCEPTION_SOCKET_ACCEPT, -cqe.res);
+						continue;
+					}
+					ArmAcceptUring(ring);
+					continue;
+				}
+
+				// 세션의 수신, 송신 완료를 처리합니다
+				// 요청마다 IO Count를 잡아두었으므로 세션은 완료가 모두 올 때까지 정리되지 않습니다
+				Session *session = reinterpret_cast<Session *>(cqe.user_data & ~(DWORD64)URING_OP_MASK);
+				if ((cqe.user_data & URING_OP_MASK) == URING_OP_RECV)
+				{
+					RecvCompleteUring(session, cqe.res, cqe.flags);
+				} else
+				{
+					SendCompleteUring(session, cqe.res);
+				}
+			}
+
+			// 거둔 완료에서 수락된 세션들을 알리고 수신을 시작시킵니다
+			if (acceptedCount > 0)
+			{
+				ConnectSessions(acceptedSessions, acceptedCount);
+				acceptedCount = 0;
+			}
+		}
+
+		return -1;
+	}
+
+}
+
+#endif
@@ -1,5 +1,8 @@
 ﻿#include "MemoryDump.h"
 
+// 미니덤프는 Windows DbgHelp 에 의존합니다
+#ifdef _WIN32
+
 namespace azely
 {
 
@@ -84,4 +87,6 @@ namespace azely
 		*ptr = 0;
 	}
 
-}
\ No newline at end of file
+}
+
+#endif
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 #include "Core.h"
 
+// 미니덤프는 Windows DbgHelp 에 의존합니다
+#ifdef _WIN32
+
 namespace azely
 {
 	/**
@@ -26,4 +29,6 @@ namespace azely
 
 	};
 
-}
\ No newline at end of file
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,186 @@
+﻿#pragma once
+
+#include "Core.h"
+#include "SerializedBuffer.h"
+#include "PacketView.h"
+
+namespace azely {
+
+	/**
+	 * \brief 메시지 타입마다 처리 함수를 등록해 두고, 타입 번호로 바로 찾아 호출하는 디스패처
+	 * \details 메시지 맨 앞의 USHORT 타입 번호를 읽어 MESSAGE_TYPE_COUNT 크기의 테이블에서 처리 함수를 찾으므로 switch 분기가 필요 없습니다
+	 * 등록할 메시지 구조체는 BOOL Deserialize(SerializedBuffer &message)와 BOOL Deserialize(PacketView &message) 멤버 함수로 나머지 페이로드를 읽어들이고 성공 여부를 반환해야 합니다 (PACKET_DEFINE으로 만든 구조체는 둘 다 가집니다)
+	 * 처리 함수는 Owner의 VOID (DWORD64 sessionID, MessageStruct &message) 멤버 함수를 템플릿 인자로 넘기므로, 타입마다 만들어지는 호출 함수 안에서 바로 호출됩니다
+	 * 등록은 서버를 시작하기 전에 끝내야 합니다 / 사용 예 : dispatcher.RegisterHandler<MESSAGE_CHAT, ChatMessage, &ChatServer::OnChat>();
+	 * Dispatch는 여러 PacketThread에서 동시에 호출할 수 있으며, 타입별 통계는 Interlocked로 셉니다
+	 * \tparam Owner 처리 함수를 가진 클래스
+	 * \tparam MESSAGE_TYPE_COUNT 메시지 타입 번호의 개수 (타입 번호는 0 부터 MESSAGE_TYPE_COUNT - 1 까지)
+	 */
+	template <typename Owner, INT32 MESSAGE_TYPE_COUNT>
+	class MessageDispatcher
+	{
+	public:
+		enum DispatchResult
+		{
+			DISPATCH_SUCCESS,
+			DISPATCH_UNKNOWN_TYPE,
+			DISPATCH_MALFORMED,
+		};
+
+		explicit MessageDispatcher(Owner *owner) : owner(owner), handlerTable(), unknownCount(0)
+		{
+			static_assert(MESSAGE_TYPE_COUNT > 0 && MESSAGE_TYPE_COUNT <= 65536, "MESSAGE_TYPE_COUNT must fit in USHORT message types");
+		}
+
+		/**
+		 * \brief 메시지 타입에 처리 함수를 등록합니다
+		 * \details 타입 번호가 테이블 범위를 넘으면 컴파일되지 않으며, 이미 등록된 타입이라면 덮어씁니다
+		 * \tparam MESSAGE_TYPE 메시지 타입 번호
+		 * \tparam MessageStruct 페이로드를 읽어들일 메시지 구조체
+		 * \tparam HANDLER 처리 함수
+		 */
+		template <USHORT MESSAGE_TYPE, typename MessageStruct, VOID (Owner::*HANDLER)(DWORD64, MessageStruct &)>
+		VOID RegisterHandler()
+		{
+			static_assert(MESSAGE_TYPE < MESSAGE_TYPE_COUNT, "MESSAGE_TYPE is out of the dispatch table");
+			handlerTable[MESSAGE_TYPE].invoker = &MessageDispatcher::Invoke<SerializedBuffer, MessageStruct, HANDLER>;
+			handlerTable[MESSAGE_TYPE].viewInvoker = &MessageDispatcher::Invoke<PacketView, MessageStruct, HANDLER>;
+		}
+
+		/**
+		 * \brief 메시지의 타입 번호를 읽어 등록된 처리 함수를 호출합니다
+		 * \details 타입 번호를 읽은 뒤의 페이로드를 메시지 구조체로 읽어들여 처리 함수에 넘깁니다
+		 * \param sessionID 세션 ID
+		 * \param message 수신한 메시지 (읽기 위치가 타입 번호 앞에 있는 상태)
+		 * \return 처리 결과 (등록되지 않은 타입이거나 페이로드가 잘못되었다면 처리 함수를 호출하지 않습니다)
+		 */
+		DispatchResult Dispatch(DWORD64 sessionID, SerializedBuffer *message)
+		{
+			return DispatchMessage(sessionID, *message);
+		}
+
+		/**
+		 * \brief 수신 링버퍼를 가리키는 뷰에서 타입 번호를 읽어 등록된 처리 함수를 호출합니다
+		 * \details OnRecvMessage(DWORD64, PacketView &)에서 메시지를 패킷 풀로 복사하지 않고 처리할 때 사용합니다
+		 * \param sessionID 세션 ID
+		 * \param message 수신한 메시지의 뷰 (읽기 위치가 타입 번호 앞에 있는 상태)
+		 * \return 처리 결과 (등록되지 않은 타입이거나 페이로드가 잘못되었다면 처리 함수를 호출하지 않습니다)
+		 */
+		DispatchResult Dispatch(DWORD64 sessionID, PacketView &message)
+		{
+			return DispatchMessage(sessionID, message);
+		}
+
+		/**
+		 * \brief 메시지 타입에 처리 함수가 등록되어 있는지 여부를 리턴합니다
+		 * \param messageType 메시지 타입 번호
+		 * \return 등록 여부
+		 */
+		BOOL IsRegistered(USHORT messageType) const
+		{
+			return messageType < MESSAGE_TYPE_COUNT && handlerTable[messageType].invoker != nullptr;
+		}
+
+		/**
+		 * \brief 메시지 타입별로 처리 함수까지 전달된 메시지 개수를 리턴합니다
+		 * \param messageType 메시지 타입 번호
+		 * \return 처리한 메시지 개수
+		 */
+		DWORD64 GetDispatchCount(USHORT messageType) const
+		{
+			return messageType < MESSAGE_TYPE_COUNT ? handlerTable[messageType].dispatchCount : 0;
+		}
+
+		/**
+		 * \brief 메시지 타입별로 페이로드를 읽어들이지 못한 메시지 개수를 리턴합니다
+		 * \param messageType 메시지 타입 번호
+		 * \return 잘못된 메시지 개수
+		 */
+		DWORD64 GetMalformedCount(USHORT messageType) const
+		{
+			return messageType < MESSAGE_TYPE_COUNT ? handlerTable[messageType].malformedCount : 0;
+		}
+
+		/**
+		 * \brief 등록되지 않은 타입이거나 타입 번호를 읽을 수 없었던 메시지 개수를 리턴합니다
+		 * \return 알 수 없는 메시지 개수
+		 */
+		DWORD64 GetUnknownCount() const
+		{
+			return unknownCount;
+		}
+
+	private:
+		typedef BOOL (*Invoker)(Owner *owner, DWORD64 sessionID, SerializedBuffer &message);
+		typedef BOOL (*ViewInvoker)(Owner *owner, DWORD64 sessionID, PacketView &message);
+
+		/**
+		 * \brief 타입 번호 하나의 테이블 항목
+		 * \details 다른 타입의 통계와 같은 캐시 라인을 나누지 않도록 정렬합니다
+		 */
+		struct alignas(64) HandlerEntry
+		{
+			Invoker					invoker;
+			ViewInvoker				viewInvoker;
+			volatile DWORD64		dispatchCount;
+			volatile DWORD64		malformedCount;
+		};
+
+		static Invoker GetInvoker(const HandlerEntry &entry, SerializedBuffer &)
+		{
+			return entry.invoker;
+		}
+
+		static ViewInvoker GetInvoker(const HandlerEntry &entry, PacketView &)
+		{
+			return entry.viewInvoker;
+		}
+
+		/**
+		 * \brief 타입 번호를 읽고, 메시지를 읽는 타입에 맞는 호출 함수로 처리 함수를 호출합니다
+		 * \tparam Reader SerializedBuffer 또는 PacketView
+		 */
+		template <typename Reader>
+		DispatchResult DispatchMessage(DWORD64 sessionID, Reader &message)
+		{
+			USHORT messageType;
+			if (!message.GetData(reinterpret_cast<PUCHAR>(&messageType), sizeof(messageType)) ||
+				messageType >= MESSAGE_TYPE_COUNT || handlerTable[messageType].invoker == nullptr)
+			{
+				InterlockedIncrement(&unknownCount);
+				return DISPATCH_UNKNOWN_TYPE;
+			}
+
+			HandlerEntry &entry = handlerTable[messageType];
+			if (!GetInvoker(entry, message)(owner, sessionID, message))
+			{
+				InterlockedIncrement(&entry.malformedCount);
+				return DISPATCH_MALFORMED;
+			}
+			InterlockedIncrement(&entry.dispatchCount);
+			return DISPATCH_SUCCESS;
+		}
+
+		/**
+		 * \brief 페이로드를 메시지 구조체로 읽어들여 처리 함수를 호출합니다
+		 * \tparam Reader SerializedBuffer 또는 PacketView
+		 * \return 페이로드를 읽어들였는지 여부
+		 */
+		template <typename Reader, typename MessageStruct, VOID (Owner::*HANDLER)(DWORD64, MessageStruct &)>
+		static BOOL Invoke(Owner *owner, DWORD64 sessionID, Reader &message)
+		{
+			MessageStruct messageStruct;
+			if (!messageStruct.Deserialize(message))
+			{
+				return false;
+			}
+			(owner->*HANDLER)(sessionID, messageStruct);
+			return true;
+		}
+
+		Owner						*owner;
+		HandlerEntry				handlerTable[MESSAGE_TYPE_COUNT];
+		alignas(64) volatile DWORD64	unknownCount;
+	};
+
+}
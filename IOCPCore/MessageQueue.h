@@ -1,55 +1,175 @@
 ﻿#pragma once
 
-#include <queue>
-#include<mutex>
-
-using namespace std;
+#ifdef _WIN32
+#include <Windows.h>
+#include <synchapi.h>
+#else
+#include "CoreLinux.h"
+#endif
 
 namespace azely
 {
 
+	/**
+	 * \brief 여러 스레드가 넣고 한 스레드가 꺼내는 lock-free 메시지 큐 (intrusive MPSC)
+	 * \details 노드 타입 T는 T *volatile next 멤버를 가져야 하며, 큐는 노드를 따로 할당하지 않습니다
+	 * 넣을 때는 InterlockedExchange 한 번으로 끝나며, 꺼내는 스레드는 큐가 비었을 때 WaitOnAddress로 잠듭니다
+	 * \tparam T 노드 타입
+	 */
 	template <typename T>
 	class MessageQueue
 	{
+		enum WaitState
+		{
+			WAIT_RUNNING = 0,
+			WAIT_PARKED = 1,
+			WAIT_CLOSED = 2
+		};
 
 	public:
+		MessageQueue() : head(&stub), tail(&stub), waitState(WAIT_RUNNING)
+		{
+			stub.next = nullptr;
+		}
 
-		typedef queue<T>* QueueType;
+		/**
+		 * \brief 노드를 큐에 넣습니다 (여러 스레드에서 호출할 수 있습니다)
+		 * \details 꺼내는 스레드가 잠들어 있다면 깨웁니다
+		 * \param node 넣을 노드
+		 */
+		void Enqueue(T *node)
+		{
+			Push(node);
+
+			if (waitState == WAIT_PARKED && InterlockedCompareExchange(&waitState, WAIT_RUNNING, WAIT_PARKED) == WAIT_PARKED)
+			{
+				WakeByAddressSingle((PVOID)&waitState);
+			}
+		}
 
-		MessageQueue()
+		/**
+		 * \brief 여러 노드를 한 번에 큐에 넣습니다 (여러 스레드에서 호출할 수 있습니다)
+		 * \details 노드들을 먼저 서로 연결해두고 InterlockedExchange 한 번으로 붙이므로, 배열 순서대로 이어지며 사이에 다른 스레드의 노드가 끼지 않습니다
+		 * \param nodes 넣을 노드 배열
+		 * \param count 노드 개수
+		 */
+		void EnqueueBatch(T *const *nodes, INT32 count)
 		{
-			messageQueue = new queue<T>;
+			if (count <= 0) return;
+			for (INT32 i = 0; i < count - 1; i++)
+			{
+				nodes[i]->next = nodes[i + 1];
+			}
+			Push(nodes[0], nodes[count - 1]);
+
+			if (waitState == WAIT_PARKED && InterlockedCompareExchange(&waitState, WAIT_RUNNING, WAIT_PARKED) == WAIT_PARKED)
+			{
+				WakeByAddressSingle((PVOID)&waitState);
+			}
 		}
 
-		~MessageQueue()
+		/**
+		 * \brief 큐에서 노드를 꺼냅니다 (한 스레드에서만 호출해야 합니다)
+		 * \details 다른 스레드가 넣는 도중이라 아직 연결되지 않은 노드는 꺼내지 못하고 nullptr을 반환합니다
+		 * \return 꺼낸 노드, 없다면 nullptr
+		 */
+		T *Dequeue()
 		{
-			delete messageQueue;
+			T *tailNode = tail;
+			T *nextNode = tailNode->next;
+
+			// 더미 노드는 건너뜁니다
+			if (tailNode == &stub)
+			{
+				if (nextNode == nullptr) return nullptr;
+				tail = nextNode;
+				tailNode = nextNode;
+				nextNode = nextNode->next;
+			}
+
+			if (nextNode != nullptr)
+			{
+				tail = nextNode;
+				return tailNode;
+			}
+
+			// 마지막 노드라면 더미 노드를 뒤에 넣어야 꺼낼 수 있습니다
+			// 그 사이에 다른 스레드가 넣는 중이라면 연결될 때까지 꺼내지 않습니다
+			if (tailNode != head) return nullptr;
+			Push(&stub);
+			nextNode = tailNode->next;
+			if (nextNode != nullptr)
+			{
+				tail = nextNode;
+				return tailNode;
+			}
+			return nullptr;
 		}
 
-		queue<T> *CreateQueue()
+		/**
+		 * \brief 큐가 비어있다면 노드가 들어오거나 Close가 호출될 때까지 잠듭니다 (꺼내는 스레드에서만 호출해야 합니다)
+		 * \details 깨어난 뒤에도 큐가 비어있을 수 있으므로, 호출한 쪽에서 다시 꺼내보아야 합니다
+		 */
+		void Wait()
 		{
-			return new queue<T>();
+			// 잠들기로 표시한 뒤에 큐를 확인하여, 그 사이에 넣은 스레드가 깨우기를 놓치지 않도록 합니다
+			if (InterlockedCompareExchange(&waitState, WAIT_PARKED, WAIT_RUNNING) != WAIT_RUNNING) return;
+			if (!IsEmpty())
+			{
+				InterlockedCompareExchange(&waitState, WAIT_RUNNING, WAIT_PARKED);
+				return;
+			}
+
+			LONG waitStateParked = WAIT_PARKED;
+			WaitOnAddress(&waitState, &waitStateParked, sizeof(LONG), INFINITE);
+			InterlockedCompareExchange(&waitState, WAIT_RUNNING, WAIT_PARKED);
 		}
 
-		void Enqueue(const T& data)
+		/**
+		 * \brief 잠든 스레드를 깨우고, 이후의 Wait는 바로 반환하도록 합니다
+		 */
+		void Close()
 		{
-			lock_guard<mutex> lockGuard(locker);
-			messageQueue->push(data);
+			InterlockedExchange(&waitState, WAIT_CLOSED);
+			WakeByAddressSingle((PVOID)&waitState);
 		}
 
-		void SwapQueue(QueueType &targetQueue)
+		/**
+		 * \brief 큐가 비어있는지 확인합니다
+		 * \details 넣는 도중인 노드가 있다면 비어있지 않은 것으로 봅니다
+		 * \return 비어있다면 true
+		 */
+		BOOL IsEmpty() const
 		{
-			lock_guard<mutex> lockGuard(locker);
-			queue<T> *currentQueue = messageQueue;
-			messageQueue = targetQueue;
-			targetQueue = currentQueue;
+			return tail == &stub && head == &stub;
 		}
 
 	private:
+		/**
+		 * \brief 노드를 맨 뒤에 연결합니다
+		 * \param node 연결할 노드
+		 */
+		void Push(T *node)
+		{
+			Push(node, node);
+		}
 
-		queue<T>	*messageQueue;
-		mutex		locker;
+		/**
+		 * \brief 이미 서로 연결된 노드들을 맨 뒤에 연결합니다
+		 * \param firstNode 첫 노드
+		 * \param lastNode 마지막 노드
+		 */
+		void Push(T *firstNode, T *lastNode)
+		{
+			lastNode->next = nullptr;
+			T *prevNode = static_cast<T *>(InterlockedExchangePointer((PVOID volatile *)&head, lastNode));
+			prevNode->next = firstNode;
+		}
 
+		alignas(64) T *volatile	head;
+		alignas(64) T			*tail;
+		alignas(64) volatile LONG	waitState;
+		T						stub;
 	};
 
-}
\ No newline at end of file
+}
@@ -3,6 +3,8 @@
 namespace azely
 {
 
+#ifdef _WIN32
+
 	MonitorProcess::MonitorProcess(HANDLE handleProcess) : handleProcess(handleProcess), processTotal(0), processUser(0), processKernel(0), processLastKernel{ 0 }, processLastUser{0}, processLastTime{0}
 	{
 		if (handleProcess == INVALID_HANDLE_VALUE)
@@ -50,4 +52,54 @@ namespace azely
 
 	}
 
+#else
+
+	MonitorProcess::MonitorProcess(HANDLE handleProcess) : handleProcess(handleProcess), processTotal(0), processUser(0), processKernel(0), processLastUser(0), processLastKernel(0), processLastTime(0), privateMemoryBytes(0)
+	{
+		// Linux 에서는 현재 프로세스만 모니터링합니다
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo(&systemInfo);
+		numberOfProcessors = systemInfo.dwNumberOfProcessors;
+
+		UpdateProcessTime();
+	}
+
+	VOID MonitorProcess::UpdateProcessTime()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		DWORD64 nowTime = (DWORD64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		DWORD64 userTime = (DWORD64)usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec;
+		DWORD64 kernelTime = (DWORD64)usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec;
+
+		DWORD64 timeDiff = nowTime - processLastTime;
+		DWORD64 userDiff = userTime - processLastUser;
+		DWORD64 kernelDiff = kernelTime - processLastKernel;
+		DWORD64 totalDiff = userDiff + kernelDiff;
+
+		processTotal = (float)(totalDiff / (double)numberOfProcessors / (double)timeDiff * 100.0f);
+		processKernel = (float)(kernelDiff / (double)numberOfProcessors / (double)timeDiff * 100.0f);
+		processUser = (float)(userDiff / (double)numberOfProcessors / (double)timeDiff * 100.0f);
+		processLastTime = nowTime;
+		processLastKernel = kernelTime;
+		processLastUser = userTime;
+
+		// Private Bytes 에 가장 가까운 익명 메모리 상주 크기(RssAnon)를 사용합니다
+		ifstream statusFile("/proc/self/status");
+		string line;
+		while (getline(statusFile, line))
+		{
+			if (line.compare(0, 8, "RssAnon:") == 0)
+			{
+				privateMemoryBytes = stoull(line.substr(8)) * 1024;
+				break;
+			}
+		}
+	}
+
+#endif
+
 }
\ No newline at end of file
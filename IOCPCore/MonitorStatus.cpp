@@ -3,6 +3,8 @@
 namespace azely
 {
 
+#ifdef _WIN32
+
 	MonitorStatus::MonitorStatus(HANDLE handleProcess) : ethernetData{ 0 }, handleProcess(handleProcess), ethernetQuery(nullptr), nonPagedPoolQuery(nullptr), networkRecvBytes(0), networkSendBytes(0), nonPagedPoolBytes(0), availableMemoryQuery(nullptr), availableMemoryBytes(0)
 	{
 		if (handleProcess == INVALID_HANDLE_VALUE) 
@@ -151,4 +153,99 @@ namespace azely
 		}
 	}
 
+#else
+
+	MonitorStatus::MonitorStatus(HANDLE handleProcess) : handleProcess(handleProcess), processorTotal(0), processorUser(0), processorKernel(0), processorLastKernel(0), processorLastUser(0), processorLastIdle(0),
+		nonPagedPoolBytes(0), availableMemoryBytes(0), networkLastRecvBytes(0), networkLastSendBytes(0), networkLastTime(0), networkRecvBytes(0), networkSendBytes(0)
+	{
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo(&systemInfo);
+		numberOfProcessors = systemInfo.dwNumberOfProcessors;
+
+		UpdateProcessorUsageTime();
+	}
+
+	VOID MonitorStatus::UpdateProcessorUsageTime()
+	{
+		// /proc/stat 의 첫 줄 : cpu user nice system idle iowait irq softirq steal
+		ifstream statFile("/proc/stat");
+		string cpuLabel;
+		DWORD64 user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+		statFile >> cpuLabel >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
+		if (cpuLabel == "cpu")
+		{
+			DWORD64 userTime = user + nice;
+			DWORD64 kernelTime = system + irq + softirq + steal;
+			DWORD64 idleTime = idle + iowait;
+
+			DWORD64 userDiff = userTime - processorLastUser;
+			DWORD64 kernelDiff = kernelTime - processorLastKernel;
+			DWORD64 idleDiff = idleTime - processorLastIdle;
+			DWORD64 totalDiff = userDiff + kernelDiff + idleDiff;
+
+			if (totalDiff == 0)
+			{
+				processorUser = 0.0f;
+				processorKernel = 0.0f;
+				processorTotal = 0.0f;
+			}
+			else
+			{
+				processorTotal = (double)(totalDiff - idleDiff) / totalDiff * 100.0f;
+				processorUser = (double)userDiff / totalDiff * 100.0f;
+				processorKernel = (double)kernelDiff / totalDiff * 100.0f;
+			}
+			processorLastKernel = kernelTime;
+			processorLastUser = userTime;
+			processorLastIdle = idleTime;
+		}
+
+		// /proc/net/dev 에서 루프백을 제외한 인터페이스의 누적 송수신 바이트를 합산합니다
+		ifstream netFile("/proc/net/dev");
+		string line;
+		DWORD64 recvBytesTotal = 0;
+		DWORD64 sendBytesTotal = 0;
+		while (getline(netFile, line))
+		{
+			size_t colon = line.find(':');
+			if (colon == string::npos) continue;
+			string interfaceName = line.substr(0, colon);
+			interfaceName.erase(0, interfaceName.find_first_not_of(' '));
+			if (interfaceName == "lo") continue;
+
+			DWORD64 fields[9] = { 0 };
+			istringstream fieldStream(line.substr(colon + 1));
+			for (int i = 0; i < 9; i++) fieldStream >> fields[i];
+			recvBytesTotal += fields[0];
+			sendBytesTotal += fields[8];
+		}
+
+		DWORD currentTime = timeGetTime();
+		if (networkLastTime != 0 && currentTime != networkLastTime)
+		{
+			DOUBLE elapsedSecond = (currentTime - networkLastTime) / 1000.0;
+			networkRecvBytes = (recvBytesTotal - networkLastRecvBytes) / elapsedSecond;
+			networkSendBytes = (sendBytesTotal - networkLastSendBytes) / elapsedSecond;
+		}
+		networkLastRecvBytes = recvBytesTotal;
+		networkLastSendBytes = sendBytesTotal;
+		networkLastTime = currentTime;
+
+		// Nonpaged Pool 에 가장 가까운 회수 불가능한 커널 슬랩(SUnreclaim)을 사용합니다
+		ifstream memFile("/proc/meminfo");
+		while (getline(memFile, line))
+		{
+			if (line.compare(0, 13, "MemAvailable:") == 0)
+			{
+				availableMemoryBytes = stoull(line.substr(13)) * 1024;
+			}
+			else if (line.compare(0, 11, "SUnreclaim:") == 0)
+			{
+				nonPagedPoolBytes = stoull(line.substr(11)) * 1024;
+			}
+		}
+	}
+
+#endif
+
 }
\ No newline at end of file
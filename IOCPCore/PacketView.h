@@ -0,0 +1,99 @@
+﻿#pragma once
+
+#include "Core.h"
+
+#include <type_traits>
+
+namespace azely {
+
+	/**
+	 * \brief 수신한 메시지를 복사하지 않고 읽는 읽기 전용 뷰
+	 * \details 메시지가 수신 링버퍼 안에서 끊기지 않았다면 링버퍼를 직접 가리키고, 버퍼 끝에서 끊겼다면 WorkerThread마다 둔 버퍼에 한 번 복사한 곳을 가리킵니다
+	 * 읽기 위치는 뷰 안에서만 움직이며, 가리키는 메모리는 OnRecvMessage(DWORD64, PacketView &)가 반환되면 재사용되므로 그 뒤에는 사용할 수 없습니다
+	 */
+	class PacketView
+	{
+	public:
+		PacketView(const UCHAR *data, INT32 size) : begin(data), end(data + size), read(data)
+		{
+		}
+
+		/**
+		 * \brief 메시지 전체 크기를 리턴합니다
+		 * \return 페이로드 크기
+		 */
+		__inline INT32 GetBufferSizeTotal() const
+		{
+			return static_cast<INT32>(end - begin);
+		}
+
+		/**
+		 * \brief 아직 읽지 않은 크기를 리턴합니다
+		 * \return 읽지 않은 크기
+		 */
+		__inline INT32 GetBufferSizeUsed() const
+		{
+			return static_cast<INT32>(end - read);
+		}
+
+		/**
+		 * \brief 읽기 포인터를 리턴합니다
+		 * \return 읽기 포인터
+		 */
+		__inline const UCHAR *GetBufferRead() const
+		{
+			return read;
+		}
+
+		/**
+		 * \brief 읽기 포인터를 이동시킵니다
+		 * \param moveSize 이동할 크기
+		 * \return 성공 여부
+		 */
+		__inline BOOL MoveReadPointer(INT32 moveSize)
+		{
+			if (moveSize < 0 || GetBufferSizeUsed() < moveSize)
+			{
+				return false;
+			}
+			read += moveSize;
+			return true;
+		}
+
+		/**
+		 * \brief 원하는 크기만큼 읽어들입니다
+		 * \param outBuffer [out] 읽어들일 버퍼
+		 * \param requestSize 읽어들일 크기
+		 * \return 성공 여부
+		 */
+		__inline BOOL GetData(PUCHAR outBuffer, INT32 requestSize)
+		{
+			if (GetBufferSizeUsed() < requestSize)
+			{
+				return false;
+			}
+
+			memcpy(outBuffer, read, requestSize);
+			read += requestSize;
+
+			return true;
+		}
+
+		/**
+		 * \brief SerializedBuffer의 operator >> 와 같은 방식으로 기본 타입 값을 읽어들입니다
+		 */
+		template<typename T>
+		__inline PacketView &operator >> (T &outValue)
+		{
+			static_assert(std::is_arithmetic<T>::value, "PacketView can only read arithmetic types");
+			GetData(reinterpret_cast<PUCHAR>(&outValue), sizeof(outValue));
+			return *this;
+		}
+
+	private:
+		const UCHAR	*begin;
+		const UCHAR	*end;
+		const UCHAR	*read;
+	};
+
+}
@@ -1,5 +1,11 @@
 ﻿#include "RingBuffer.h"
 
+#ifdef _WIN32
+#pragma comment(lib, "onecore.lib")
+#else
+#include <sys/mman.h>
+#endif
+
 namespace azely {
 
 	RingBuffer::RingBuffer() : RingBuffer(BUFFER_SIZE_DEFAULT)
@@ -7,17 +13,109 @@ namespace azely {
 
 	}
 
-	RingBuffer::RingBuffer(int bufferSize) : bufferSize(bufferSize)
+	RingBuffer::RingBuffer(int bufferSize) : RingBuffer(bufferSize, false)
+	{
+
+	}
+
+	RingBuffer::RingBuffer(int bufferSize, bool isMirrored, SyncMode syncMode) : bufferSize(bufferSize), syncMode(syncMode), mirrored(false), commitSlots(nullptr)
 	{
 		InitializeSRWLock(&srw);
-		begin = (char*) malloc(bufferSize);
-		end = begin + bufferSize;
-		read = write = begin;
+		if (!isMirrored || !AllocateMirrored(bufferSize))
+		{
+			begin = (char*) malloc(bufferSize);
+		}
+		end = begin + this->bufferSize;
+
+		// 커밋 슬롯은 MPSC 모드에서만 할당합니다
+		if (syncMode == SYNC_MPSC) commitSlots = (LONG64 volatile *) malloc(sizeof(LONG64) * MPSC_SLOT_COUNT);
+		Clear();
 	}
 
 	RingBuffer::~RingBuffer()
 	{
-		free(begin);
+		free((PVOID)commitSlots);
+		if (!mirrored)
+		{
+			free(begin);
+			return;
+		}
+#ifdef _WIN32
+		UnmapViewOfFile(begin);
+		UnmapViewOfFile(begin + bufferSize);
+#else
+		munmap(begin, (size_t)bufferSize * 2);
+#endif
+	}
+
+	bool RingBuffer::AllocateMirrored(int requestSize)
+	{
+#ifdef _WIN32
+		// 할당 단위(64KB)로 올림하여, 자리만 잡아둔 주소 공간을 반으로 나눈 뒤 같은 섹션을 두 번 매핑합니다
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo(&systemInfo);
+		SIZE_T granularity = systemInfo.dwAllocationGranularity;
+		SIZE_T mappingSize = ((SIZE_T)requestSize + granularity - 1) / granularity * granularity;
+
+		PCHAR placeholder = (PCHAR)VirtualAlloc2(nullptr, nullptr, mappingSize * 2, MEM_RESERVE | MEM_RESERVE_PLACEHOLDER, PAGE_NOACCESS, nullptr, 0);
+		if (placeholder == nullptr) return false;
+		if (!VirtualFree(placeholder, mappingSize, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER))
+		{
+			VirtualFree(placeholder, 0, MEM_RELEASE);
+			return false;
+		}
+
+		HANDLE section = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, (DWORD)mappingSize, nullptr);
+		if (section == nullptr)
+		{
+			VirtualFree(placeholder, 0, MEM_RELEASE);
+			VirtualFree(placeholder + mappingSize, 0, MEM_RELEASE);
+			return false;
+		}
+
+		PVOID viewFront = MapViewOfFile3(section, nullptr, placeholder, 0, mappingSize, MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+		PVOID viewBack = MapViewOfFile3(section, nullptr, placeholder + mappingSize, 0, mappingSize, MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+		CloseHandle(section);
+		if (viewFront == nullptr || viewBack == nullptr)
+		{
+			if (viewFront != nullptr) UnmapViewOfFile(viewFront);
+			else VirtualFree(placeholder, 0, MEM_RELEASE);
+			if (viewBack != nullptr) UnmapViewOfFile(viewBack);
+			else VirtualFree(placeholder + mappingSize, 0, MEM_RELEASE);
+			return false;
+		}
+#else
+		// 페이지 크기로 올림하여, 두 배 크기의 주소 공간을 잡아둔 뒤 같은 memfd를 두 번 고정 매핑합니다
+		size_t granularity = (size_t)sysconf(_SC_PAGESIZE);
+		size_t mappingSize = ((size_t)requestSize + granularity - 1) / granularity * granularity;
+
+		int memoryFile = memfd_create("RingBuffer", MFD_CLOEXEC);
+		if (memoryFile == -1) return false;
+		if (ftruncate(memoryFile, (off_t)mappingSize) == -1)
+		{
+			close(memoryFile);
+			return false;
+		}
+
+		PCHAR placeholder = (PCHAR)mmap(nullptr, mappingSize * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (placeholder == MAP_FAILED)
+		{
+			close(memoryFile);
+			return false;
+		}
+		bool isMapped = mmap(placeholder, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, memoryFile, 0) != MAP_FAILED
+			&& mmap(placeholder + mappingSize, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, memoryFile, 0) != MAP_FAILED;
+		close(memoryFile);
+		if (!isMapped)
+		{
+			munmap(placeholder, mappingSize * 2);
+			return false;
+		}
+#endif
+		begin = placeholder;
+		bufferSize = (INT32)mappingSize;
+		mirrored = true;
+		return true;
 	}
 
 	bool RingBuffer::Enqueue(const char *data, int requestSize, int *outEnqueueSize, bool isPartialEnqueueAvailable)
@@ -44,18 +142,15 @@ namespace azely {
 			return true;
 		}
 
-		int enqueuedSize = 0;
-		char *enqueuePointer = write;
-		while (enqueuedSize < requestSize)
-		{
-			*enqueuePointer = *data;
-			data++;
-			enqueuedSize++;
-			MovePointer(&enqueuePointer, 1);
-		}
-		MoveWriteBuffer(enqueuedSize);
+		// 끊김 없이 쓸 수 있는 구간과 버퍼 처음부터의 나머지 구간으로 나누어 복사합니다
+		// 미러 모드에서는 쓰기 구간이 끊기지 않으므로 한 번에 복사합니다
+		int directSize = GetSizeDirectEnqueueAble();
+		if (directSize > requestSize) directSize = requestSize;
+		memcpy(write, data, directSize);
+		if (directSize < requestSize) memcpy(begin, data + directSize, requestSize - directSize);
+		MoveWriteBuffer(requestSize);
 		
-		resultSize = enqueuedSize;
+		resultSize = requestSize;
 		if (outEnqueueSize != nullptr) *outEnqueueSize = resultSize;
 		return true;
 	}
@@ -84,22 +179,150 @@ namespace azely {
 			return true;
 		}
 
-		int dequeuedSize = 0;
-		char *dequeuePointer = read;
-		while (dequeuedSize < requestSize)
+		// 끊김 없이 읽을 수 있는 구간과 버퍼 처음부터의 나머지 구간으로 나누어 복사합니다
+		// 미러 모드에서는 읽기 구간이 끊기지 않으므로 한 번에 복사합니다
+		int directSize = GetSizeDirectDequeueAble();
+		if (directSize > requestSize) directSize = requestSize;
+		memcpy(outData, read, directSize);
+		if (directSize < requestSize) memcpy(outData + directSize, begin, requestSize - directSize);
+		if (!isPeekMode) MoveReadBuffer(requestSize);
+
+		resultSize = requestSize;
+		if (outDequeueSize != nullptr) *outDequeueSize = resultSize;
+		return true;
+	}
+
+	bool RingBuffer::Reserve(int requestSize, Reservation *outReservation)
+	{
+		if (requestSize <= 0 || GetSizeFree() < requestSize) return false;
+
+		int directSize = GetSizeDirectEnqueueAble();
+		if (directSize > requestSize) directSize = requestSize;
+		outReservation->first = write;
+		outReservation->firstSize = directSize;
+		outReservation->second = begin;
+		outReservation->secondSize = requestSize - directSize;
+		return true;
+	}
+
+	bool RingBuffer::Commit(int commitSize)
+	{
+		if (commitSize < 0 || GetSizeFree() < commitSize) return false;
+		return MoveWriteBuffer(commitSize);
+	}
+
+	bool RingBuffer::Produce(const char *data, int requestSize)
+	{
+		if (requestSize <= 0) return true;
+
+		if (syncMode == SYNC_LOCK)
 		{
-			*outData = *dequeuePointer;
-			outData++;
-			dequeuedSize++;
-			MovePointer(&dequeuePointer, 1);
+			AcquireSRWLockExclusive(&srw);
+			int enqueuedSize = 0;
+			bool enqueueResult = Enqueue(data, requestSize, &enqueuedSize);
+			ReleaseSRWLockExclusive(&srw);
+			return enqueueResult;
 		}
-		if (!isPeekMode) MoveReadBuffer(dequeuedSize);
 
-		resultSize = dequeuedSize;
-		if (outDequeueSize != nullptr) *outDequeueSize = resultSize;
+		if (syncMode == SYNC_SPSC)
+		{
+			// 쓰기 포인터는 이 스레드만 옮기므로, 읽기 포인터만 acquire로 읽어 빈 공간을 계산합니다
+			PCHAR writeObserved = write;
+			PCHAR readObserved = (PCHAR)ReadPointerAcquire((PVOID const volatile *)&read);
+			if (GetSizeTotal() - GetSizeUsed(readObserved, writeObserved) < requestSize) return false;
+
+			CopyAt(writeObserved, data, requestSize);
+			WritePointerRelease((PVOID volatile *)&write, Advance(writeObserved, requestSize));
+			return true;
+		}
+
+		// 예약 상태를 CAS로 옮겨 티켓과 [reservePointer, reservePointer + requestSize) 구간을 함께 예약합니다
+		LONG64 reserveObserved;
+		LONG64 reserveNew;
+		DWORD ticket;
+		PCHAR reservePointer;
+		do
+		{
+			reserveObserved = ReadAcquire64(&reserveState);
+			ticket = (DWORD)(reserveObserved >> 32);
+			reservePointer = begin + (INT32)(reserveObserved & 0xffffffff);
+
+			// 공개되지 않은 예약이 커밋 슬롯 수만큼 쌓였다면, 슬롯을 덮어쓰지 않도록 버퍼가 가득 찬 것처럼 실패합니다
+			if (ticket - (DWORD)(ReadAcquire64(&publishState) >> 32) >= MPSC_SLOT_COUNT) return false;
+			PCHAR readObserved = (PCHAR)ReadPointerAcquire((PVOID const volatile *)&read);
+			if (GetSizeTotal() - GetSizeUsed(readObserved, reservePointer) < requestSize) return false;
+			reserveNew = MakeState(ticket + 1, (INT32)(Advance(reservePointer, requestSize) - begin));
+		} while (InterlockedCompareExchange64(&reserveState, reserveNew, reserveObserved) != reserveObserved);
+
+		CopyAt(reservePointer, data, requestSize);
+
+		// 앞선 예약이 모두 공개되었다면 슬롯을 거치지 않고 바로 공개합니다
+		// 아니라면 복사를 마쳤음을 티켓의 커밋 슬롯에 표시하며, 앞선 생산자가 커밋할 때 이 구간까지 함께 공개합니다
+		// 어느 쪽이든 기다리지 않고, 뒤의 생산자가 먼저 커밋해둔 구간까지 공개할 수 있는 데까지 공개합니다
+		if (InterlockedCompareExchange64(&publishState, reserveNew, reserveObserved) != reserveObserved)
+		{
+			InterlockedExchange64(&commitSlots[ticket % MPSC_SLOT_COUNT], reserveNew);
+		}
+		Publish();
 		return true;
 	}
 
+	LONG64 RingBuffer::Publish()
+	{
+		for (;;)
+		{
+			LONG64 publishObserved = ReadAcquire64(&publishState);
+			DWORD ticket = (DWORD)(publishObserved >> 32);
+			LONG64 commit = ReadAcquire64(&commitSlots[ticket % MPSC_SLOT_COUNT]);
+
+			// 슬롯에 이 티켓의 커밋이 아직 쓰이지 않았다면 멈춥니다
+			if ((DWORD)(commit >> 32) != ticket + 1) return publishObserved;
+			InterlockedCompareExchange64(&publishState, commit, publishObserved);
+		}
+	}
+
+	int RingBuffer::LoadReadable(Reservation *outReadable)
+	{
+		if (syncMode == SYNC_LOCK) AcquireSRWLockShared(&srw);
+
+		// 읽기 포인터는 소비자만 옮기므로, 쓰기 포인터만 acquire로 읽습니다
+		// MPSC 모드에서는 커밋된 구간을 마저 공개한 뒤 공개 상태의 위치를 쓰기 포인터로 씁니다
+		PCHAR readObserved = read;
+		PCHAR writeObserved;
+		if (syncMode == SYNC_MPSC)
+		{
+			writeObserved = begin + (INT32)(Publish() & 0xffffffff);
+		} else
+		{
+			writeObserved = (PCHAR)ReadPointerAcquire((PVOID const volatile *)&write);
+		}
+
+		if (syncMode == SYNC_LOCK) ReleaseSRWLockShared(&srw);
+
+		int usedSize = GetSizeUsed(readObserved, writeObserved);
+		int directSize = mirrored ? usedSize : (int)(end - readObserved);
+		if (directSize > usedSize) directSize = usedSize;
+		outReadable->first = readObserved;
+		outReadable->firstSize = directSize;
+		outReadable->second = begin;
+		outReadable->secondSize = usedSize - directSize;
+		return usedSize;
+	}
+
+	void RingBuffer::Consume(int consumeSize)
+	{
+		if (syncMode == SYNC_LOCK)
+		{
+			AcquireSRWLockExclusive(&srw);
+			MoveReadBuffer(consumeSize);
+			ReleaseSRWLockExclusive(&srw);
+			return;
+		}
+
+		// 읽은 데이터를 다 사용한 뒤에 생산자가 빈 공간을 보도록 release로 옮깁니다
+		WritePointerRelease((PVOID volatile *)&read, Advance(read, consumeSize));
+	}
+
 	bool RingBuffer::Peek(char *outData, int requestSize, int *outPeekSize, bool isPartialPeekAvailable)
 	{
 		return Dequeue(outData, requestSize, outPeekSize, isPartialPeekAvailable, true);
@@ -6,55 +6,48 @@ namespace azely {
 	{
 	}
 
-	SerializedBuffer::SerializedBuffer(INT32 size)
+	SerializedBuffer::SerializedBuffer(INT32 size) : SerializedBuffer(new UCHAR[size], size)
+	{
+		isStorageOwned = true;
+	}
+
+	SerializedBuffer::SerializedBuffer(PUCHAR storage, INT32 size)
 	{
 		bufferSize = size;
-		begin = new UCHAR[bufferSize];
+		begin = storage;
 		end = begin + bufferSize;
 		write = read = begin;
+		isStorageOwned = false;
+		refCount = 0;
+		isHeaderBuilt = false;
 	}
 
 	SerializedBuffer::~SerializedBuffer()
 	{
-		delete begin;
+		if (isStorageOwned) delete[] begin;
 	}
 	
 
-	BOOL SerializedBuffer::VerifyChecksum(UCHAR checksum)
+	BOOL SerializedBuffer::VerifyChecksum(UINT32 checksum)
 	{
-		PUCHAR checkingPointer = begin + NETWORK_HEADER_SIZE;
-
-		UINT32 calculatedChecksum = 0;
-		while (checkingPointer < write)
-		{
-			calculatedChecksum += *checkingPointer;
-			checkingPointer++;
-		}
-		calculatedChecksum %= 256;
-
-		return checksum == calculatedChecksum;
+		return checksum == NETWORK_CHECKSUM(read, write - read);
 	}
 
 	VOID SerializedBuffer::BuildNetworkHeader()
 	{
+		PUCHAR payload = begin + NETWORK_HEADER_SIZE_MAX;
+
 		NetworkHeader header;
 		header.secureCode = NETWORK_SECURE_CODE;
-		header.length = GetBufferSizeUsed() - NETWORK_HEADER_SIZE;
+		header.length = write - payload;
 #ifndef _SIMPLE_HEADER
-
-		PUCHAR checkingPointer = begin + NETWORK_HEADER_SIZE;
-		UINT32 calculatedChecksum = 0;
-
-		while (checkingPointer < write)
-		{
-			calculatedChecksum += *checkingPointer;
-			checkingPointer++;
-		}
-		calculatedChecksum %= 256;
-		header.checksum = calculatedChecksum;
+		header.checksum = NETWORK_CHECKSUM(payload, write - payload);
 #endif
-		
-		memcpy(begin, &header, sizeof(NetworkHeader));
+
+		UCHAR headerBuffer[NETWORK_HEADER_SIZE_MAX];
+		INT32 headerSize = EncodeNetworkHeader(&header, headerBuffer);
+		read = payload - headerSize;
+		memcpy(read, headerBuffer, headerSize);
 	}
 
 	SerializedBuffer &SerializedBuffer::operator=(const SerializedBuffer &clSrcSerializedBuffer)
@@ -100,6 +93,7 @@ namespace azely {
 		return *this;
 	}
 
+#ifdef _WIN32
 	SerializedBuffer &SerializedBuffer::operator<<(ULONG ulongValue)
 	{
 		PutData(reinterpret_cast<PUCHAR>(&ulongValue), sizeof(ulongValue));
@@ -111,6 +105,7 @@ namespace azely {
 		PutData(reinterpret_cast<PUCHAR>(&longValue), sizeof(longValue));
 		return *this;
 	}
+#endif
 
 	SerializedBuffer &SerializedBuffer::operator<<(UINT64 uint64Value)
 	{
@@ -172,6 +167,7 @@ namespace azely {
 		return *this;
 	}
 
+#ifdef _WIN32
 	SerializedBuffer &SerializedBuffer::operator>>(ULONG &outUlongValue)
 	{
 		GetData(reinterpret_cast<PUCHAR>(&outUlongValue), sizeof(outUlongValue));
@@ -183,6 +179,7 @@ namespace azely {
 		GetData(reinterpret_cast<PUCHAR>(&outLongValue), sizeof(outLongValue));
 		return *this;
 	}
+#endif
 
 	SerializedBuffer &SerializedBuffer::operator>>(UINT64 &outUint64Value)
 	{
@@ -0,0 +1,238 @@
+﻿#include "SessionCipher.h"
+
+#ifdef _SESSION_CIPHER
+#ifdef _WIN32
+#pragma comment(lib, "bcrypt.lib")
+#include <bcrypt.h>
+#else
+#include <openssl/evp.h>
+#endif
+#endif
+
+namespace azely
+{
+	SessionCipher::SessionCipher() : suite(SUITE_NONE), sendContext(nullptr), recvContext(nullptr), sendIV{0}, recvIV{0}, sendSequence(0), recvSequence(0)
+	{
+		InitializeSRWLock(&sendSRW);
+	}
+
+	SessionCipher::~SessionCipher()
+	{
+		Release();
+	}
+
+#if !defined(_SESSION_CIPHER)
+
+	namespace
+	{
+		// 암호 라이브러리 없이 빌드했다면 컨텍스트를 만들지 못하므로 Initialize가 실패합니다
+		PVOID CreateContext(SessionCipher::Suite /*suite*/, const UCHAR * /*key*/, INT32 /*keySize*/, INT32 /*encrypt*/)
+		{
+			return nullptr;
+		}
+
+		VOID DestroyContext(PVOID /*context*/)
+		{
+		}
+	}
+
+#elif defined(_WIN32)
+
+	namespace
+	{
+		BCRYPT_ALG_HANDLE GetAlgorithm(SessionCipher::Suite suite)
+		{
+			switch (suite)
+			{
+			case SessionCipher::SUITE_AES_128_GCM:
+			case SessionCipher::SUITE_AES_256_GCM:
+				return BCRYPT_AES_GCM_ALG_HANDLE;
+#ifdef BCRYPT_CHACHA20_POLY1305_ALG_HANDLE
+			case SessionCipher::SUITE_CHACHA20_POLY1305:
+				return BCRYPT_CHACHA20_POLY1305_ALG_HANDLE;
+#endif
+			default:
+				return nullptr;
+			}
+		}
+
+		PVOID CreateContext(SessionCipher::Suite suite, const UCHAR *key, INT32 keySize, INT32 encrypt)
+		{
+			BCRYPT_ALG_HANDLE algorithm = GetAlgorithm(suite);
+			if (algorithm == nullptr) return nullptr;
+
+			BCRYPT_KEY_HANDLE keyHandle = nullptr;
+			if (!BCRYPT_SUCCESS(BCryptGenerateSymmetricKey(algorithm, &keyHandle, nullptr, 0, (PUCHAR)key, (ULONG)keySize, 0))) return nullptr;
+			return keyHandle;
+		}
+
+		VOID DestroyContext(PVOID context)
+		{
+			BCryptDestroyKey((BCRYPT_KEY_HANDLE)context);
+		}
+	}
+
+#else
+
+	namespace
+	{
+		const EVP_CIPHER *GetAlgorithm(SessionCipher::Suite suite)
+		{
+			switch (suite)
+			{
+			case SessionCipher::SUITE_AES_128_GCM:
+				return EVP_aes_128_gcm();
+			case SessionCipher::SUITE_AES_256_GCM:
+				return EVP_aes_256_gcm();
+			case SessionCipher::SUITE_CHACHA20_POLY1305:
+				return EVP_chacha20_poly1305();
+			default:
+				return nullptr;
+			}
+		}
+
+		// 키는 컨텍스트를 만들 때 한 번만 설정하고, 메시지마다 nonce만 바꾸어 다시 초기화합니다
+		PVOID CreateContext(SessionCipher::Suite suite, const UCHAR *key, INT32 keySize, INT32 encrypt)
+		{
+			const EVP_CIPHER *algorithm = GetAlgorithm(suite);
+			if (algorithm == nullptr || EVP_CIPHER_key_length(algorithm) != keySize) return nullptr;
+
+			EVP_CIPHER_CTX *context = EVP_CIPHER_CTX_new();
+			if (context == nullptr) return nullptr;
+			if (EVP_CipherInit_ex(context, algorithm, nullptr, key, nullptr, encrypt) != 1 ||
+				EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_AEAD_SET_IVLEN, SessionCipher::IV_SIZE, nullptr) != 1)
+			{
+				EVP_CIPHER_CTX_free(context);
+				return nullptr;
+			}
+			return context;
+		}
+
+		VOID DestroyContext(PVOID context)
+		{
+			EVP_CIPHER_CTX_free((EVP_CIPHER_CTX *)context);
+		}
+	}
+
+#endif
+
+	BOOL SessionCipher::Initialize(const Key *key)
+	{
+		Release();
+
+		INT32 keySize;
+		switch (key->suite)
+		{
+		case SUITE_AES_128_GCM:
+			keySize = 16;
+			break;
+		case SUITE_AES_256_GCM:
+		case SUITE_CHACHA20_POLY1305:
+			keySize = 32;
+			break;
+		default:
+			return false;
+		}
+
+		sendContext = CreateContext(key->suite, key->sendKey, keySize, 1);
+		recvContext = CreateContext(key->suite, key->recvKey, keySize, 0);
+		if (sendContext == nullptr || recvContext == nullptr)
+		{
+			Release();
+			return false;
+		}
+
+		memcpy(sendIV, key->sendIV, IV_SIZE);
+		memcpy(recvIV, key->recvIV, IV_SIZE);
+		sendSequence = 0;
+		recvSequence = 0;
+		suite = key->suite;
+		return true;
+	}
+
+	VOID SessionCipher::Release()
+	{
+		if (sendContext != nullptr) DestroyContext(sendContext);
+		if (recvContext != nullptr) DestroyContext(recvContext);
+		sendContext = nullptr;
+		recvContext = nullptr;
+		suite = SUITE_NONE;
+	}
+
+	VOID SessionCipher::MakeNonce(const UCHAR *iv, DWORD64 sequence, PUCHAR nonce)
+	{
+		// IV의 마지막 8바이트에 빅 엔디안 순번을 XOR 합니다
+		memcpy(nonce, iv, IV_SIZE);
+		for (INT32 i = 0; i < 8; i++)
+		{
+			nonce[IV_SIZE - 1 - i] ^= (UCHAR)(sequence >> (i * 8));
+		}
+	}
+
+#ifdef _SESSION_CIPHER
+
+	BOOL SessionCipher::Seal(const UCHAR *data, INT32 size, PUCHAR out, PUCHAR tag)
+	{
+		UCHAR nonce[IV_SIZE];
+		MakeNonce(sendIV, sendSequence++, nonce);
+
+#ifdef _WIN32
+		BCRYPT_AUTHENTICATED_CIPHER_MODE_INFO modeInfo;
+		BCRYPT_INIT_AUTH_MODE_INFO(modeInfo);
+		modeInfo.pbNonce = nonce;
+		modeInfo.cbNonce = IV_SIZE;
+		modeInfo.pbTag = tag;
+		modeInfo.cbTag = TAG_SIZE;
+
+		ULONG resultSize;
+		return BCRYPT_SUCCESS(BCryptEncrypt((BCRYPT_KEY_HANDLE)sendContext, (PUCHAR)data, size, &modeInfo, nullptr, 0, out, size, &resultSize, 0));
+#else
+		EVP_CIPHER_CTX *context = (EVP_CIPHER_CTX *)sendContext;
+		INT32 resultSize;
+		if (EVP_EncryptInit_ex(context, nullptr, nullptr, nullptr, nonce) != 1) return false;
+		if (size > 0 && EVP_EncryptUpdate(context, out, &resultSize, data, size) != 1) return false;
+		if (EVP_EncryptFinal_ex(context, out + size, &resultSize) != 1) return false;
+		return EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_AEAD_GET_TAG, TAG_SIZE, tag) == 1;
+#endif
+	}
+
+	BOOL SessionCipher::Open(PUCHAR data, INT32 size, const UCHAR *tag)
+	{
+		UCHAR nonce[IV_SIZE];
+		MakeNonce(recvIV, recvSequence++, nonce);
+
+#ifdef _WIN32
+		BCRYPT_AUTHENTICATED_CIPHER_MODE_INFO modeInfo;
+		BCRYPT_INIT_AUTH_MODE_INFO(modeInfo);
+		modeInfo.pbNonce = nonce;
+		modeInfo.cbNonce = IV_SIZE;
+		modeInfo.pbTag = (PUCHAR)tag;
+		modeInfo.cbTag = TAG_SIZE;
+
+		ULONG resultSize;
+		return BCRYPT_SUCCESS(BCryptDecrypt((BCRYPT_KEY_HANDLE)recvContext, data, size, &modeInfo, nullptr, 0, data, size, &resultSize, 0));
+#else
+		EVP_CIPHER_CTX *context = (EVP_CIPHER_CTX *)recvContext;
+		INT32 resultSize;
+		if (EVP_DecryptInit_ex(context, nullptr, nullptr, nullptr, nonce) != 1) return false;
+		if (size > 0 && EVP_DecryptUpdate(context, data, &resultSize, data, size) != 1) return false;
+		if (EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_AEAD_SET_TAG, TAG_SIZE, (void *)tag) != 1) return false;
+		return EVP_DecryptFinal_ex(context, data + size, &resultSize) == 1;
+#endif
+	}
+
+#else
+
+	BOOL SessionCipher::Seal(const UCHAR * /*data*/, INT32 /*size*/, PUCHAR /*out*/, PUCHAR /*tag*/)
+	{
+		return false;
+	}
+
+	BOOL SessionCipher::Open(PUCHAR /*data*/, INT32 /*size*/, const UCHAR * /*tag*/)
+	{
+		return false;
+	}
+
+#endif
+
+}
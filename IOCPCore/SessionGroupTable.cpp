@@ -0,0 +1,113 @@
+﻿#include "SessionGroupTable.h"
+
+namespace azely
+{
+
+	SessionGroupTable::SessionGroupTable(INT32 capacity) : capacity(capacity)
+	{
+		slotGroups = new vector<DWORD64>[capacity];
+	}
+
+	SessionGroupTable::~SessionGroupTable()
+	{
+		for (auto &groupEntry : groups)
+		{
+			delete groupEntry.second;
+		}
+		delete[] slotGroups;
+	}
+
+	BOOL SessionGroupTable::Join(DWORD64 groupID, DWORD64 sessionID)
+	{
+		DWORD slotIndex = static_cast<DWORD>(sessionID);
+		if (slotIndex >= static_cast<DWORD>(capacity)) return false;
+
+		// 그룹이 없다면 만듭니다
+		Group *&group = groups[groupID];
+		if (group == nullptr) group = new Group;
+
+		// 멤버 배열의 맨 뒤에 넣고 위치를 기록합니다
+		if (!group->memberPositions.emplace(slotIndex, (INT32)group->members.size()).second) return false;
+		group->members.push_back(sessionID);
+		slotGroups[slotIndex].push_back(groupID);
+		return true;
+	}
+
+	BOOL SessionGroupTable::Leave(DWORD64 groupID, DWORD64 sessionID)
+	{
+		DWORD slotIndex = static_cast<DWORD>(sessionID);
+		if (slotIndex >= static_cast<DWORD>(capacity)) return false;
+
+		auto groupEntry = groups.find(groupID);
+		if (groupEntry == groups.end()) return false;
+		if (!RemoveMember(groupEntry->second, slotIndex)) return false;
+
+		// 마지막 멤버가 나갔다면 그룹을 지웁니다
+		if (groupEntry->second->members.empty())
+		{
+			delete groupEntry->second;
+			groups.erase(groupEntry);
+		}
+
+		// 슬롯의 그룹 목록에서도 지웁니다 (세션이 들어간 그룹 수는 적으므로 순서대로 찾습니다)
+		vector<DWORD64> &joinedGroups = slotGroups[slotIndex];
+		for (size_t i = 0; i < joinedGroups.size(); i++)
+		{
+			if (joinedGroups[i] != groupID) continue;
+			joinedGroups[i] = joinedGroups.back();
+			joinedGroups.pop_back();
+			break;
+		}
+		return true;
+	}
+
+	VOID SessionGroupTable::LeaveAll(DWORD64 sessionID)
+	{
+		DWORD slotIndex = static_cast<DWORD>(sessionID);
+		if (slotIndex >= static_cast<DWORD>(capacity)) return;
+
+		for (DWORD64 groupID : slotGroups[slotIndex])
+		{
+			auto groupEntry = groups.find(groupID);
+			if (groupEntry == groups.end()) continue;
+			RemoveMember(groupEntry->second, slotIndex);
+			if (groupEntry->second->members.empty())
+			{
+				delete groupEntry->second;
+				groups.erase(groupEntry);
+			}
+		}
+		slotGroups[slotIndex].clear();
+	}
+
+	const DWORD64 *SessionGroupTable::GetMembers(DWORD64 groupID, INT32 *outMemberCount) const
+	{
+		auto groupEntry = groups.find(groupID);
+		if (groupEntry == groups.end())
+		{
+			*outMemberCount = 0;
+			return nullptr;
+		}
+		*outMemberCount = (INT32)groupEntry->second->members.size();
+		return groupEntry->second->members.data();
+	}
+
+	BOOL SessionGroupTable::RemoveMember(Group *group, DWORD slotIndex)
+	{
+		auto positionEntry = group->memberPositions.find(slotIndex);
+		if (positionEntry == group->memberPositions.end()) return false;
+
+		// 마지막 멤버를 지울 자리로 옮기고 그 위치를 갱신합니다
+		INT32 position = positionEntry->second;
+		group->memberPositions.erase(positionEntry);
+		DWORD64 lastMember = group->members.back();
+		group->members.pop_back();
+		if (position < (INT32)group->members.size())
+		{
+			group->members[position] = lastMember;
+			group->memberPositions[static_cast<DWORD>(lastMember)] = position;
+		}
+		return true;
+	}
+
+}
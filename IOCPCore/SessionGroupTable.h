@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include "Core.h"
+
+#include <vector>
+
+namespace azely
+{
+	/**
+	 * \brief 세션 그룹(방, 채널) 목록
+	 * \details 그룹마다 멤버 세션 ID를 빈틈없는 배열로 가지며, 나갈 때는 마지막 멤버를 그 자리로 옮겨 O(1)로 지웁니다
+	 * 세션 테이블의 슬롯마다 들어가 있는 그룹 목록을 가지므로, 세션이 정리될 때 모든 그룹에서 한 번에 뺄 수 있습니다
+	 * 그룹은 처음 들어올 때 만들어지고, 마지막 멤버가 나가면 지워집니다
+	 * 잠금은 사용하는 쪽에서 걸어야 합니다
+	 */
+	class SessionGroupTable
+	{
+	public:
+		/**
+		 * \brief 세션 그룹 목록 생성자
+		 * \param capacity 세션 테이블의 최대 세션 개수
+		 */
+		SessionGroupTable(INT32 capacity);
+		~SessionGroupTable();
+
+		/**
+		 * \brief 세션을 그룹에 넣습니다
+		 * \param groupID 그룹 ID
+		 * \param sessionID 세션 ID
+		 * \return 이미 들어가 있다면 false
+		 */
+		BOOL		Join(DWORD64 groupID, DWORD64 sessionID);
+
+		/**
+		 * \brief 세션을 그룹에서 뺍니다
+		 * \param groupID 그룹 ID
+		 * \param sessionID 세션 ID
+		 * \return 들어가 있지 않았다면 false
+		 */
+		BOOL		Leave(DWORD64 groupID, DWORD64 sessionID);
+
+		/**
+		 * \brief 세션을 들어가 있는 모든 그룹에서 뺍니다
+		 * \param sessionID 세션 ID
+		 */
+		VOID		LeaveAll(DWORD64 sessionID);
+
+		/**
+		 * \brief 그룹의 멤버 세션 ID 배열을 반환합니다
+		 * \details 반환한 배열은 다음 Join, Leave, LeaveAll 전까지만 유효합니다
+		 * \param groupID 그룹 ID
+		 * \param outMemberCount [out] 멤버 수
+		 * \return 멤버 세션 ID 배열, 그룹이 없다면 nullptr
+		 */
+		const DWORD64	*GetMembers(DWORD64 groupID, INT32 *outMemberCount) const;
+
+		/**
+		 * \brief 멤버가 있는 그룹 개수를 반환합니다
+		 * \return 그룹 개수
+		 */
+		INT32		GetGroupCount() const
+		{
+			return (INT32)groups.size();
+		}
+
+	private:
+		/**
+		 * \brief 그룹의 멤버 배열과, 슬롯 번호로 멤버 배열의 위치를 찾는 표
+		 */
+		struct Group
+		{
+			vector<DWORD64>					members;
+			unordered_map<DWORD, INT32>		memberPositions;
+		};
+
+		/**
+		 * \brief 그룹에서 슬롯의 멤버를 지웁니다 (마지막 멤버를 지운 자리로 옮깁니다)
+		 * \param group 그룹
+		 * \param slotIndex 지울 멤버의 슬롯 번호
+		 * \return 멤버가 없었다면 false
+		 */
+		BOOL		RemoveMember(Group *group, DWORD slotIndex);
+
+		unordered_map<DWORD64, Group *>		groups;
+		vector<DWORD64>						*slotGroups;
+		INT32								capacity;
+	};
+
+}
@@ -0,0 +1,103 @@
+﻿#include "SessionTable.h"
+
+#include <new>
+
+namespace azely
+{
+
+	SessionTable::SessionTable(INT32 capacity, INT32 shardCount, bool isRingBufferMirrored, RingBuffer::SyncMode sendSyncMode) : capacity(capacity), shardCount(shardCount), countUse(0)
+	{
+		// 세션과 샤드별 빈 슬롯 스택은 alignas(64) 멤버를 가지므로 캐시라인 정렬된 메모리에 생성합니다
+		sessions = static_cast<Session *>(_aligned_malloc(sizeof(Session) * capacity, alignof(Session)));
+		slotNext = new DWORD[capacity];
+		slotStacks = static_cast<SlotStack *>(_aligned_malloc(sizeof(SlotStack) * shardCount, alignof(SlotStack)));
+
+		for (int i = 0; i < shardCount; i++)
+		{
+			new (&slotStacks[i]) SlotStack();
+			slotStacks[i].top = SLOT_EMPTY;
+		}
+
+		// 슬롯 번호가 작은 슬롯부터 할당되도록 뒤에서부터 빈 슬롯 스택에 넣습니다
+		for (int i = capacity - 1; i >= 0; i--)
+		{
+			new (&sessions[i]) Session(isRingBufferMirrored, sendSyncMode);
+			PushSlot(i % shardCount, i);
+		}
+	}
+
+	SessionTable::~SessionTable()
+	{
+		for (int i = 0; i < capacity; i++)
+		{
+			sessions[i].~Session();
+		}
+		_aligned_free(sessions);
+		delete[] slotNext;
+		_aligned_free(slotStacks);
+	}
+
+	Session *SessionTable::Alloc(INT32 shardIndex)
+	{
+		// 지정한 샤드부터 차례로 빈 슬롯을 찾습니다
+		DWORD slotIndex = SLOT_EMPTY;
+		for (int i = 0; i < shardCount && slotIndex == SLOT_EMPTY; i++)
+		{
+			slotIndex = PopSlot((shardIndex + i) % shardCount);
+		}
+		if (slotIndex == SLOT_EMPTY) return nullptr;
+
+		// 슬롯의 세대를 증가시켜 새 세션 ID를 부여합니다
+		// 세대가 0이 되지 않도록 하여, 세션 ID가 0xffffffff 이하의 통지용 completionKey와 겹치지 않게 합니다
+		Session *session = &sessions[slotIndex];
+		DWORD generation = static_cast<DWORD>(session->sessionID >> 32) + 1;
+		if (generation == 0) generation = 1;
+		session->sessionID = (static_cast<DWORD64>(generation) << 32) | slotIndex;
+
+		InterlockedIncrement(&countUse);
+		return session;
+	}
+
+	VOID SessionTable::Free(Session *session)
+	{
+		InterlockedDecrement(&countUse);
+
+		DWORD slotIndex = static_cast<DWORD>(session - sessions);
+		PushSlot(slotIndex % shardCount, slotIndex);
+	}
+
+	DWORD SessionTable::PopSlot(INT32 shardIndex)
+	{
+		SlotStack *stack = &slotStacks[shardIndex];
+		DWORD64 topObserved;
+		DWORD64 topNew;
+		DWORD slotIndex;
+
+		do
+		{
+			topObserved = stack->top;
+			slotIndex = static_cast<DWORD>(topObserved);
+			if (slotIndex == SLOT_EMPTY) return SLOT_EMPTY;
+
+			// 태그를 증가시켜, 꺼내는 사이에 같은 슬롯이 반환되어 다시 맨 위가 되더라도 교체에 실패하도록 합니다
+			topNew = (((topObserved >> 32) + 1) << 32) | slotNext[slotIndex];
+		} while (InterlockedCompareExchange(&stack->top, topNew, topObserved) != topObserved);
+
+		return slotIndex;
+	}
+
+	VOID SessionTable::PushSlot(INT32 shardIndex, DWORD slotIndex)
+	{
+		SlotStack *stack = &slotStacks[shardIndex];
+		DWORD64 topObserved;
+		DWORD64 topNew;
+
+		do
+		{
+			topObserved = stack->top;
+			slotNext[slotIndex] = static_cast<DWORD>(topObserved);
+			topNew = (((topObserved >> 32) + 1) << 32) | slotIndex;
+		} while (InterlockedCompareExchange(&stack->top, topNew, topObserved) != topObserved);
+	}
+
+}
@@ -0,0 +1,130 @@
+﻿#include "TimerWheel.h"
+
+namespace azely
+{
+
+	TimerWheel::TimerWheel(INT32 capacity, DWORD tickInterval, DWORD currentTime) : tickInterval(tickInterval), tickTime(currentTime), tickCurrent(0)
+	{
+		for (int level = 0; level < LEVEL_COUNT; level++)
+		{
+			INT32 slotCount = (level == 0) ? LEVEL_FIRST_SIZE : LEVEL_SIZE;
+			slots[level] = new DWORD[slotCount];
+			for (int i = 0; i < slotCount; i++)
+			{
+				slots[level][i] = ENTRY_NONE;
+			}
+		}
+		entryNext = new DWORD[capacity];
+		entryExpireTick = new DWORD[capacity];
+		entryLinked = new BOOL[capacity];
+		for (int i = 0; i < capacity; i++)
+		{
+			entryNext[i] = ENTRY_NONE;
+			entryExpireTick[i] = 0;
+			entryLinked[i] = false;
+		}
+	}
+
+	TimerWheel::~TimerWheel()
+	{
+		for (int level = 0; level < LEVEL_COUNT; level++)
+		{
+			delete[] slots[level];
+		}
+		delete[] entryNext;
+		delete[] entryExpireTick;
+		delete[] entryLinked;
+	}
+
+	VOID TimerWheel::Schedule(DWORD entryIndex, DWORD expireTime)
+	{
+		if (entryLinked[entryIndex]) return;
+
+		// 만료 시간을 틱으로 바꿉니다 (timeGetTime이 한 바퀴 돌아도 차이로 계산되도록 합니다)
+		// 이미 지난 시간이라면 다음 진행에서 만료되도록 현재 틱에 넣습니다
+		INT32 timeRemain = static_cast<INT32>(expireTime - tickTime);
+		DWORD tickRemain = (timeRemain <= 0) ? 0 : (timeRemain - 1) / tickInterval;
+		if (tickRemain > static_cast<DWORD>(TICK_SPAN_MAX)) tickRemain = TICK_SPAN_MAX;
+
+		entryExpireTick[entryIndex] = tickCurrent + tickRemain;
+		entryLinked[entryIndex] = true;
+		Link(entryIndex);
+	}
+
+	INT32 TimerWheel::Advance(DWORD currentTime, DWORD *expiredEntries)
+	{
+		INT32 expiredCount = 0;
+
+		// 지난 틱만큼 한 틱씩 진행합니다
+		while (currentTime - tickTime >= tickInterval)
+		{
+			DWORD slotIndex = tickCurrent & (LEVEL_FIRST_SIZE - 1);
+
+			// 1단계가 한 바퀴 돌 때마다 상위 단계의 차례가 된 칸을 내립니다
+			if (slotIndex == 0)
+			{
+				for (int level = 1; level < LEVEL_COUNT; level++)
+				{
+					DWORD levelSlotIndex = (tickCurrent >> (LEVEL_FIRST_BITS + LEVEL_BITS * (level - 1))) & (LEVEL_SIZE - 1);
+					Cascade(level, levelSlotIndex);
+					if (levelSlotIndex != 0) break;
+				}
+			}
+
+			// 1단계의 현재 칸을 통째로 떼어내어 만료 처리합니다
+			DWORD entryIndex = slots[0][slotIndex];
+			slots[0][slotIndex] = ENTRY_NONE;
+			while (entryIndex != ENTRY_NONE)
+			{
+				DWORD entryIndexNext = entryNext[entryIndex];
+				entryLinked[entryIndex] = false;
+				expiredEntries[expiredCount++] = entryIndex;
+				entryIndex = entryIndexNext;
+			}
+
+			tickCurrent++;
+			tickTime += tickInterval;
+		}
+
+		return expiredCount;
+	}
+
+	VOID TimerWheel::Link(DWORD entryIndex)
+	{
+		DWORD expireTick = entryExpireTick[entryIndex];
+		INT32 tickRemain = static_cast<INT32>(expireTick - tickCurrent);
+		if (tickRemain < 0)
+		{
+			expireTick = tickCurrent;
+			tickRemain = 0;
+		}
+
+		// 남은 틱이 들어가는 가장 낮은 단계를 찾습니다
+		DWORD *slot;
+		if (tickRemain < LEVEL_FIRST_SIZE)
+		{
+			slot = &slots[0][expireTick & (LEVEL_FIRST_SIZE - 1)];
+		} else
+		{
+			INT32 level = 1;
+			while (level < LEVEL_COUNT - 1 && tickRemain >= (1 << (LEVEL_FIRST_BITS + LEVEL_BITS * level))) level++;
+			slot = &slots[level][(expireTick >> (LEVEL_FIRST_BITS + LEVEL_BITS * (level - 1))) & (LEVEL_SIZE - 1)];
+		}
+
+		entryNext[entryIndex] = *slot;
+		*slot = entryIndex;
+	}
+
+	VOID TimerWheel::Cascade(INT32 level, DWORD slotIndex)
+	{
+		DWORD entryIndex = slots[level][slotIndex];
+		slots[level][slotIndex] = ENTRY_NONE;
+		while (entryIndex != ENTRY_NONE)
+		{
+			DWORD entryIndexNext = entryNext[entryIndex];
+			Link(entryIndex);
+			entryIndex = entryIndexNext;
+		}
+	}
+
+}
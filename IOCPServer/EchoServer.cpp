@@ -3,9 +3,9 @@
 namespace azely
 {
 
-	EchoServer::EchoServer()
+	EchoServer::EchoServer() : echoDispatch(0), dispatcher(this)
 	{
-
+		dispatcher.RegisterHandler<ECHO_MESSAGE, EchoMessage, &EchoServer::OnEchoMessage>();
 	}
 
 	EchoServer::~EchoServer()
@@ -44,6 +44,17 @@ namespace azely
 			config.GetInt(IOCPServerSettings::workerThreadRunningKey, &settings.workerThreadRunning);
 			config.GetInt(IOCPServerSettings::sessionCountMaxKey, &settings.sessionCountMax);
 			config.GetInt(IOCPServerSettings::sessionTimeoutKey, &settings.sessionTimeout);
+			config.GetInt(IOCPServerSettings::acceptPostCountKey, &settings.acceptPostCount);
+			config.GetInt(IOCPServerSettings::shardCountKey, &settings.shardCount);
+			config.GetInt(IOCPServerSettings::timeoutTickKey, &settings.timeoutTick);
+			config.GetInt(IOCPServerSettings::logicThreadCountKey, &settings.logicThreadCount);
+			config.GetInt(IOCPServerSettings::inlineDispatchKey, &settings.inlineDispatch);
+			config.GetInt(IOCPServerSettings::ringBufferMirroredKey, &settings.ringBufferMirrored);
+			config.GetInt(IOCPServerSettings::sendQueueModeKey, &settings.sendQueueMode);
+			config.GetInt(IOCPServerSettings::sendZeroCopyKey, &settings.sendZeroCopy);
+			config.GetInt(IOCPServerSettings::messageSizeMaxKey, &settings.messageSizeMax);
+			config.GetInt(IOCPServerSettings::ioBackendKey, &settings.ioBackend);
+			config.GetInt("echoDispatch", &echoDispatch);
 		} else
 		{
 			wcout << L"configuration NOT loaded" << endl;
@@ -129,8 +140,12 @@ namespace azely
 			cout << "Packet Pool Size : " << serverMonitoringInfo.packetPoolSize << " Used : " << serverMonitoringInfo.packetPoolUsed << endl;
 			cout << "Message Pool Size : " << serverMonitoringInfo.messagePoolSize << " Used : " << serverMonitoringInfo.messagePoolUsed << endl;
 			cout << "--------------------THREAD STATUS--------------------" << endl;
-			cout << "Accept Thread FPS : " << serverMonitoringInfo.framePerSecondAccept << endl;
+			cout << "Accept Batch Per Second : " << serverMonitoringInfo.acceptBatchPerSecond << endl;
 			cout << "Packet Thread FPS : " << serverMonitoringInfo.framePerSecondPacket << endl;
+			for (int i = 0; i < serverMonitoringInfo.logicThreadCount; i++)
+			{
+				cout << "Packet Thread [" << i << "] Queue / FPS : " << serverMonitoringInfo.logicQueueDepth[i] << " / " << serverMonitoringInfo.logicFramePerSecond[i] << endl;
+			}
 			cout << "-------------------NETWORK MESSAGE-------------------" << endl;
 			cout << "Accept Per Second : " << serverMonitoringInfo.acceptPerSecond << endl;
 			cout << "Recv Message Per Second : " << serverMonitoringInfo.recvMessagePerSecond << endl;
@@ -154,13 +169,62 @@ namespace azely
 
 	VOID EchoServer::OnRecvMessage(DWORD64 sessionID, SerializedBuffer *message)
 	{
+		// 만일 echoDispatch 설정이라면 메시지 타입으로 처리 함수를 찾아 호출하고, 처리하지 못한 메시지는 연결을 해제합니다
+		if (echoDispatch != 0)
+		{
+			if (dispatcher.Dispatch(sessionID, message) != MessageDispatcher<EchoServer, ECHO_MESSAGE_TYPE_COUNT>::DISPATCH_SUCCESS)
+			{
+				DisconnectSession(sessionID);
+			}
+			return;
+		}
+
 		// 에코서버이기에, 받은 메시지를 그대로 되돌립니다
-		DWORD64 data;
+		// 만일 메시지가 DWORD64보다 짧다면 잘못된 메시지이므로 연결을 해제합니다
+		DWORD64 data = 0;
+		if (message->GetBufferSizeUsed() < static_cast<INT32>(sizeof(data)))
+		{
+			DisconnectSession(sessionID);
+			return;
+		}
 		*message >> data;
-		SerializedBuffer echoPacket;
-		echoPacket.Clear(true);
-		echoPacket << data;
-		SendPacket(sessionID, &echoPacket);
+		SerializedBuffer *echoPacket = AllocPacket(sizeof(data));
+		*echoPacket << data;
+		SendPacketPooled(sessionID, echoPacket);
+		FreePacket(echoPacket);
+	}
+
+	BOOL EchoServer::OnRecvMessage(DWORD64 sessionID, PacketView &message)
+	{
+		// 만일 echoDispatch 설정이라면 수신 링버퍼에서 바로 메시지 타입을 읽어 처리 함수를 호출합니다
+		if (echoDispatch != 0)
+		{
+			if (dispatcher.Dispatch(sessionID, message) != MessageDispatcher<EchoServer, ECHO_MESSAGE_TYPE_COUNT>::DISPATCH_SUCCESS)
+			{
+				DisconnectSession(sessionID);
+			}
+			return true;
+		}
+
+		// 받은 메시지를 수신 링버퍼에서 바로 읽어 되돌립니다
+		// 만일 메시지가 DWORD64보다 짧다면 PacketThread의 OnRecvMessage로 넘겨 그쪽에서 처리합니다
+		DWORD64 data = 0;
+		if (message.GetBufferSizeUsed() < static_cast<INT32>(sizeof(data))) return false;
+		message >> data;
+		SerializedBuffer *echoPacket = AllocPacket(sizeof(data));
+		*echoPacket << data;
+		SendPacketPooled(sessionID, echoPacket);
+		FreePacket(echoPacket);
+		return true;
+	}
+
+	VOID EchoServer::OnEchoMessage(DWORD64 sessionID, EchoMessage &message)
+	{
+		// 받은 메시지를 같은 타입으로 그대로 되돌립니다
+		SerializedBuffer *echoPacket = AllocPacket(message.GetSerializedSize());
+		message.Serialize(*echoPacket);
+		SendPacketPooled(sessionID, echoPacket);
+		FreePacket(echoPacket);
 	}
 
 	BOOL EchoServer::OnSessionConnectionRequest(DWORD addressIP, USHORT addressPort, PCWSTR addressString)
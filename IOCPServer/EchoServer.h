@@ -1,14 +1,34 @@
 ﻿#pragma once
 
 #include "../lib/header/IOCPServer.h"
+#include "../lib/header/MessageDispatcher.h"
+#include "../lib/header/PacketSchema.h"
 #include "../lib/header/MonitorProcess.h"
 #include "../lib/header/MonitorStatus.h"
 #include "../lib/header/SimpleConfig.h"
 
 namespace azely
 {
+	/**
+	 * \brief echoDispatch 설정에서 쓰는 메시지 타입 번호
+	 */
+	enum EchoMessageType
+	{
+		ECHO_MESSAGE = 0,
+		ECHO_MESSAGE_TYPE_COUNT
+	};
+
+	// echoDispatch 설정에서 되돌릴 메시지 (USHORT 메시지 타입 뒤에 DWORD64 페이로드)
+#define PACKET_ECHO(FIELD, ARRAY)	FIELD(DWORD64, data)
+
+#pragma pack(push, 1)
+	PACKET_DEFINE(EchoMessage, ECHO_MESSAGE, PACKET_ECHO)
+#pragma pack(pop)
+
 	/**
 	 * \brief IOCPServer를 상속받아 EchoServer를 구현한 클래스
+	 * \details 기본적으로 받은 DWORD64 페이로드를 그대로 되돌리며, 설정 파일의 echoDispatch가 1이라면
+	 * USHORT 메시지 타입이 붙은 메시지를 MessageDispatcher로 처리하여 같은 타입의 메시지로 되돌립니다
 	 */
 	class EchoServer : public IOCPServer
 	{
@@ -38,6 +58,13 @@ namespace azely
 
 	private:
 
+		/**
+		 * \brief echoDispatch 설정에서 ECHO_MESSAGE를 받았을 때 처리할 함수
+		 * \param sessionID 세션 아이디
+		 * \param message 수신한 메시지
+		 */
+		void		OnEchoMessage(DWORD64 sessionID, EchoMessage &message);
+
 		/**
 		 * \brief 메시지가 수신되었을 때 처리할 함수
 		 * \param sessionID 세션 아이디
@@ -45,6 +72,14 @@ namespace azely
 		 */
 		void		OnRecvMessage(DWORD64 sessionID, SerializedBuffer *message) override;
 
+		/**
+		 * \brief inlineDispatch 설정에서 메시지를 수신 링버퍼에서 복사하지 않고 처리할 함수
+		 * \param sessionID 세션 아이디
+		 * \param message 수신한 메시지의 뷰
+		 * \return 처리 여부
+		 */
+		BOOL		OnRecvMessage(DWORD64 sessionID, PacketView &message) override;
+
 		/**
 		 * \brief 소켓 연결이 수립되었을 때 이를 허용할지 여부를 결정하는 함수
 		 * \param addressIP 연결 시도중인 IP
@@ -84,6 +119,11 @@ namespace azely
 		MonitorStatus		monitorStatus;
 		MonitorProcess		monitorProcess;
 
+		// 만일 1이라면, 메시지 타입을 붙인 메시지를 dispatcher로 처리합니다
+		// Setting File Key Name : echoDispatch
+		INT32				echoDispatch;
+		MessageDispatcher<EchoServer, ECHO_MESSAGE_TYPE_COUNT>	dispatcher;
+
 	};
 
 }
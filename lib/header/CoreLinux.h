@@ -0,0 +1,522 @@
+﻿#pragma once
+
+//----------------------------------------------------------
+// Linux 에서 Windows API 를 사용하는 코드가 그대로 빌드되도록
+// 필요한 타입과 함수를 POSIX 로 대응시킵니다
+//----------------------------------------------------------
+
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <pthread.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <linux/io_uring.h>
+#include <time.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <cctype>
+#include <climits>
+#include <string>
+
+//----------------------------------------------------------
+// 기본 타입
+// LONG, ULONG 은 Windows 와 같이 32비트로 맞춥니다
+//----------------------------------------------------------
+typedef int					BOOL;
+typedef unsigned char		BYTE;
+typedef char				CHAR;
+typedef char				*PCHAR;
+typedef const char			*PCSTR;
+typedef unsigned char		UCHAR;
+typedef unsigned char		*PUCHAR;
+typedef short				SHORT;
+typedef unsigned short		USHORT;
+typedef int					INT;
+typedef int					*PINT;
+typedef int32_t				INT32;
+typedef int32_t				*PINT32;
+typedef int64_t				INT64;
+typedef unsigned int		UINT;
+typedef unsigned int		UINT32;
+typedef uint64_t			UINT64;
+typedef int32_t				LONG;
+typedef int32_t				*PLONG;
+typedef int64_t				LONG64;
+typedef uint32_t			ULONG;
+typedef uint32_t			DWORD;
+typedef uint32_t			*LPDWORD;
+typedef uint64_t			DWORD64;
+typedef uint64_t			ULONG64;
+typedef uint64_t			*PULONG64;
+typedef intptr_t			LONG_PTR;
+typedef uintptr_t			ULONG_PTR;
+typedef uintptr_t			UINT_PTR;
+typedef float				FLOAT;
+typedef double				DOUBLE;
+typedef void				*PVOID;
+typedef void				*HANDLE;
+typedef wchar_t				WCHAR;
+typedef wchar_t				*PWSTR;
+typedef wchar_t				*LPWSTR;
+typedef const wchar_t		*PCWSTR;
+typedef unsigned short		WORD;
+
+#define VOID				void
+#define WINAPI
+#define INFINITE			0xFFFFFFFF
+#define MAX_PATH			260
+#define INVALID_HANDLE_VALUE ((HANDLE)(LONG_PTR)-1)
+#define MAKEWORD(a, b)		((WORD)(((BYTE)(a)) | ((WORD)((BYTE)(b))) << 8))
+
+// MSVC 의 __FUNCTIONW__ 에 대응합니다 (호출식이 끝날 때까지 유효한 임시 문자열)
+#define __FUNCTIONW__		(std::wstring(__func__, __func__ + strlen(__func__)).c_str())
+
+//----------------------------------------------------------
+// 소켓
+//----------------------------------------------------------
+typedef UINT_PTR			SOCKET;
+typedef struct sockaddr		SOCKADDR;
+typedef struct sockaddr		*PSOCKADDR;
+typedef struct sockaddr		*LPSOCKADDR;
+typedef struct sockaddr_in	SOCKADDR_IN;
+typedef struct linger		LINGER;
+
+#define INVALID_SOCKET		((SOCKET)(~0))
+#define SOCKET_ERROR		(-1)
+#define SOMAXCONN_HINT(b)	(b)
+#define SD_BOTH				SHUT_RDWR
+
+struct WSADATA
+{
+	WORD wVersion;
+};
+
+inline int WSAStartup(WORD versionRequested, WSADATA *wsaData)
+{
+	wsaData->wVersion = versionRequested;
+	return 0;
+}
+
+inline int WSACleanup()
+{
+	return 0;
+}
+
+inline int WSAGetLastError()
+{
+	return errno;
+}
+
+inline int closesocket(SOCKET socket)
+{
+	return close((int)socket);
+}
+
+inline int WSAHtons(SOCKET socket, USHORT hostShort, USHORT *outNetShort)
+{
+	*outNetShort = htons(hostShort);
+	return 0;
+}
+
+inline int WSANtohs(SOCKET socket, USHORT netShort, USHORT *outHostShort)
+{
+	*outHostShort = ntohs(netShort);
+	return 0;
+}
+
+inline int WSANtohl(SOCKET socket, ULONG netLong, DWORD *outHostLong)
+{
+	*outHostLong = ntohl(netLong);
+	return 0;
+}
+
+/**
+ * \brief "a.b.c.d" 혹은 "a.b.c.d:port" 형식의 문자열을 주소로 변환합니다
+ */
+inline int WSAStringToAddressW(LPWSTR addressString, INT addressFamily, PVOID protocolInfo, LPSOCKADDR outAddress, PINT addressLength)
+{
+	if (addressString == nullptr || addressFamily != AF_INET || *addressLength < (INT)sizeof(SOCKADDR_IN)) return SOCKET_ERROR;
+
+	char narrowString[64] = { 0 };
+	if (wcstombs(narrowString, addressString, sizeof(narrowString) - 1) == (size_t)-1) return SOCKET_ERROR;
+
+	USHORT port = 0;
+	char *portString = strchr(narrowString, ':');
+	if (portString != nullptr)
+	{
+		*portString = '\0';
+		port = (USHORT)atoi(portString + 1);
+	}
+
+	SOCKADDR_IN *address = reinterpret_cast<SOCKADDR_IN *>(outAddress);
+	if (inet_pton(AF_INET, narrowString, &address->sin_addr) != 1) return SOCKET_ERROR;
+	address->sin_family = AF_INET;
+	address->sin_port = htons(port);
+	*addressLength = sizeof(SOCKADDR_IN);
+	return 0;
+}
+
+/**
+ * \brief 주소를 "a.b.c.d:port" 형식의 문자열로 변환합니다
+ * \details Windows 와 같이 outLength 가 부족하면 필요한 길이를 채우고 실패합니다
+ */
+inline int WSAAddressToStringW(LPSOCKADDR address, DWORD addressLength, PVOID protocolInfo, LPWSTR outString, LPDWORD outLength)
+{
+	if (address == nullptr || address->sa_family != AF_INET || outLength == nullptr) return SOCKET_ERROR;
+
+	SOCKADDR_IN *addressIn = reinterpret_cast<SOCKADDR_IN *>(address);
+	char narrowString[INET_ADDRSTRLEN] = { 0 };
+	inet_ntop(AF_INET, &addressIn->sin_addr, narrowString, sizeof(narrowString));
+
+	WCHAR wideString[INET_ADDRSTRLEN + 8] = { 0 };
+	int wideLength;
+	if (addressIn->sin_port != 0)
+	{
+		wideLength = swprintf(wideString, INET_ADDRSTRLEN + 8, L"%s:%u", narrowString, ntohs(addressIn->sin_port));
+	}
+	else
+	{
+		wideLength = swprintf(wideString, INET_ADDRSTRLEN + 8, L"%s", narrowString);
+	}
+
+	if (outString == nullptr || *outLength < (DWORD)wideLength + 1)
+	{
+		*outLength = wideLength + 1;
+		errno = EFAULT;
+		return SOCKET_ERROR;
+	}
+	wmemcpy(outString, wideString, wideLength + 1);
+	*outLength = wideLength + 1;
+	return 0;
+}
+
+//----------------------------------------------------------
+// Interlocked
+//----------------------------------------------------------
+template <typename T>
+inline T InterlockedIncrement(volatile T *target)
+{
+	return __atomic_add_fetch(target, 1, __ATOMIC_SEQ_CST);
+}
+
+template <typename T>
+inline T InterlockedDecrement(volatile T *target)
+{
+	return __atomic_sub_fetch(target, 1, __ATOMIC_SEQ_CST);
+}
+
+template <typename T, typename U>
+inline T InterlockedExchange(volatile T *target, U value)
+{
+	return __atomic_exchange_n(target, (T)value, __ATOMIC_SEQ_CST);
+}
+
+inline PVOID InterlockedExchangePointer(PVOID volatile *target, PVOID value)
+{
+	return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+inline PVOID InterlockedCompareExchangePointer(PVOID volatile *target, PVOID exchange, PVOID comparand)
+{
+	__atomic_compare_exchange_n(target, &comparand, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return comparand;
+}
+
+inline PVOID ReadPointerAcquire(PVOID const volatile *source)
+{
+	return __atomic_load_n(source, __ATOMIC_ACQUIRE);
+}
+
+inline void WritePointerRelease(PVOID volatile *destination, PVOID value)
+{
+	__atomic_store_n(destination, value, __ATOMIC_RELEASE);
+}
+
+inline LONG64 InterlockedExchange64(LONG64 volatile *target, LONG64 value)
+{
+	return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+inline LONG64 InterlockedCompareExchange64(LONG64 volatile *target, LONG64 exchange, LONG64 comparand)
+{
+	__atomic_compare_exchange_n(target, &comparand, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return comparand;
+}
+
+inline LONG64 ReadAcquire64(LONG64 const volatile *source)
+{
+	return __atomic_load_n(source, __ATOMIC_ACQUIRE);
+}
+
+inline BOOL SwitchToThread()
+{
+	return sched_yield() == 0;
+}
+
+inline void YieldProcessor()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+template <typename T, typename U>
+inline T InterlockedExchangeAdd(volatile T *target, U value)
+{
+	return __atomic_fetch_add(target, (T)value, __ATOMIC_SEQ_CST);
+}
+
+template <typename T, typename U, typename V>
+inline T InterlockedCompareExchange(volatile T *target, U exchange, V comparand)
+{
+	T expected = (T)comparand;
+	__atomic_compare_exchange_n(target, &expected, (T)exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return expected;
+}
+
+template <typename T, typename U>
+inline T InterlockedAnd(volatile T *target, U value)
+{
+	return __atomic_fetch_and(target, (T)value, __ATOMIC_SEQ_CST);
+}
+
+template <typename T, typename U>
+inline T InterlockedOr(volatile T *target, U value)
+{
+	return __atomic_fetch_or(target, (T)value, __ATOMIC_SEQ_CST);
+}
+
+//----------------------------------------------------------
+// SRWLOCK
+//----------------------------------------------------------
+typedef pthread_rwlock_t	SRWLOCK;
+
+inline void InitializeSRWLock(SRWLOCK *srw)
+{
+	pthread_rwlock_init(srw, nullptr);
+}
+
+inline void AcquireSRWLockShared(SRWLOCK *srw)
+{
+	pthread_rwlock_rdlock(srw);
+}
+
+inline void ReleaseSRWLockShared(SRWLOCK *srw)
+{
+	pthread_rwlock_unlock(srw);
+}
+
+inline void AcquireSRWLockExclusive(SRWLOCK *srw)
+{
+	pthread_rwlock_wrlock(srw);
+}
+
+inline void ReleaseSRWLockExclusive(SRWLOCK *srw)
+{
+	pthread_rwlock_unlock(srw);
+}
+
+//----------------------------------------------------------
+// WaitOnAddress (futex)
+//----------------------------------------------------------
+inline BOOL WaitOnAddress(volatile void *address, PVOID compareAddress, size_t addressSize, DWORD milliseconds)
+{
+	timespec timeout;
+	timeout.tv_sec = milliseconds / 1000;
+	timeout.tv_nsec = (long)(milliseconds % 1000) * 1000000;
+	long waitResult = syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, *(int *)compareAddress, milliseconds == INFINITE ? nullptr : &timeout, nullptr, 0);
+	return waitResult == 0 || errno != ETIMEDOUT;
+}
+
+inline void WakeByAddressSingle(PVOID address)
+{
+	syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+//----------------------------------------------------------
+// TLS
+//----------------------------------------------------------
+#define TLS_OUT_OF_INDEXES	((DWORD)0xFFFFFFFF)
+
+inline DWORD TlsAlloc()
+{
+	pthread_key_t key;
+	if (pthread_key_create(&key, nullptr) != 0) return TLS_OUT_OF_INDEXES;
+	return (DWORD)key;
+}
+
+inline PVOID TlsGetValue(DWORD index)
+{
+	return pthread_getspecific((pthread_key_t)index);
+}
+
+inline BOOL TlsSetValue(DWORD index, PVOID value)
+{
+	return pthread_setspecific((pthread_key_t)index, value) == 0;
+}
+
+inline BOOL TlsFree(DWORD index)
+{
+	return pthread_key_delete((pthread_key_t)index) == 0;
+}
+
+//----------------------------------------------------------
+// 시간
+//----------------------------------------------------------
+inline DWORD timeGetTime()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (DWORD)((UINT64)now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+inline UINT timeBeginPeriod(UINT period)
+{
+	return 0;
+}
+
+inline UINT timeEndPeriod(UINT period)
+{
+	return 0;
+}
+
+inline void Sleep(DWORD milliseconds)
+{
+	usleep((useconds_t)milliseconds * 1000);
+}
+
+inline void ZeroMemory(PVOID destination, size_t length)
+{
+	memset(destination, 0, length);
+}
+
+/**
+ * \brief alignment 바이트 경계에 맞춘 메모리를 할당합니다, 실패시 nullptr 을 반환합니다
+ */
+inline void *_aligned_malloc(size_t size, size_t alignment)
+{
+	void *memory = nullptr;
+	if (posix_memalign(&memory, alignment < sizeof(void *) ? sizeof(void *) : alignment, size) != 0) return nullptr;
+	return memory;
+}
+
+/**
+ * \brief _aligned_malloc 으로 할당한 메모리를 해제합니다
+ */
+inline void _aligned_free(void *memory)
+{
+	free(memory);
+}
+
+//----------------------------------------------------------
+// 시스템 정보
+//----------------------------------------------------------
+struct SYSTEM_INFO
+{
+	DWORD dwNumberOfProcessors;
+};
+
+inline void GetSystemInfo(SYSTEM_INFO *systemInfo)
+{
+	systemInfo->dwNumberOfProcessors = (DWORD)sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+//----------------------------------------------------------
+// 스레드
+//----------------------------------------------------------
+struct ThreadStartContext
+{
+	UINT	(*startAddress)(PVOID);
+	PVOID	argument;
+};
+
+inline void *ThreadStartRoutine(void *param)
+{
+	ThreadStartContext context = *reinterpret_cast<ThreadStartContext *>(param);
+	delete reinterpret_cast<ThreadStartContext *>(param);
+	context.startAddress(context.argument);
+	return nullptr;
+}
+
+/**
+ * \brief 실패시 0 을 반환하며, 성공시 pthread_t 를 반환합니다
+ */
+inline uintptr_t _beginthreadex(PVOID security, UINT stackSize, UINT (*startAddress)(PVOID), PVOID argument, UINT initFlag, UINT *threadAddress)
+{
+	ThreadStartContext *context = new ThreadStartContext{ startAddress, argument };
+	pthread_t thread;
+	if (pthread_create(&thread, nullptr, ThreadStartRoutine, context) != 0)
+	{
+		delete context;
+		return 0;
+	}
+	return (uintptr_t)thread;
+}
+
+/**
+ * \brief _beginthreadex 로 만든 스레드의 종료를 기다립니다
+ */
+inline DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds)
+{
+	pthread_join((pthread_t)(uintptr_t)handle, nullptr);
+	return 0;
+}
+
+inline DWORD WaitForMultipleObjects(DWORD count, const HANDLE *handles, BOOL waitAll, DWORD milliseconds)
+{
+	for (DWORD i = 0; i < count; i++)
+	{
+		pthread_join((pthread_t)(uintptr_t)handles[i], nullptr);
+	}
+	return 0;
+}
+
+//----------------------------------------------------------
+// 콘솔
+//----------------------------------------------------------
+inline int _kbhit()
+{
+	termios oldTerminal;
+	if (tcgetattr(STDIN_FILENO, &oldTerminal) != 0) return 0;
+	termios newTerminal = oldTerminal;
+	newTerminal.c_lflag &= ~(ICANON | ECHO);
+	tcsetattr(STDIN_FILENO, TCSANOW, &newTerminal);
+	int bytesWaiting = 0;
+	ioctl(STDIN_FILENO, FIONREAD, &bytesWaiting);
+	tcsetattr(STDIN_FILENO, TCSANOW, &oldTerminal);
+	return bytesWaiting > 0;
+}
+
+inline int _getch()
+{
+	termios oldTerminal;
+	bool isTerminal = tcgetattr(STDIN_FILENO, &oldTerminal) == 0;
+	if (isTerminal)
+	{
+		termios newTerminal = oldTerminal;
+		newTerminal.c_lflag &= ~(ICANON | ECHO);
+		tcsetattr(STDIN_FILENO, TCSANOW, &newTerminal);
+	}
+	unsigned char key = 0;
+	ssize_t readResult = read(STDIN_FILENO, &key, 1);
+	if (isTerminal) tcsetattr(STDIN_FILENO, TCSANOW, &oldTerminal);
+	return readResult == 1 ? key : -1;
+}
@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include <cstddef>
+
 typedef unsigned int        UINT32;
 
 namespace azely {
@@ -29,7 +31,7 @@ namespace azely {
 				return;
 			}
 
-			_bufferGuardValue = reinterpret_cast<UINT32>(this);
+			_bufferGuardValue = static_cast<UINT32>(reinterpret_cast<UINT_PTR>(this));
 			_freeNode = nullptr;
 			_countUse = 0;
 			_countPool = 0;
@@ -38,7 +40,7 @@ namespace azely {
 			{
 				for (int i = 0; i < sizeInitialize; i++)
 				{
-					Node *newNode = (Node *)malloc(sizeof(Node));
+					Node *newNode = AllocNode();
 					newNode->BUFFER_GUARD_FRONT = _bufferGuardValue;
 					newNode->BUFFER_GUARD_END = _bufferGuardValue;
 					//if (!isPlacementNew)
@@ -61,7 +63,11 @@ namespace azely {
 			while (deleteNode != nullptr)
 			{
 				Node *nextNode = deleteNode->next;
-				delete deleteNode;
+				if (!_isPlacementNew)
+				{
+					deleteNode->data.~T();
+				}
+				FreeNode(deleteNode);
 				deleteNode = nextNode;
 				_countPool--;
 			}
@@ -85,7 +91,7 @@ namespace azely {
 				}
 				return &returnNode->data;
 			}
-			Node *newNode = (Node *)malloc(sizeof(Node));
+			Node *newNode = AllocNode();
 			newNode->BUFFER_GUARD_FRONT = _bufferGuardValue;
 			newNode->BUFFER_GUARD_END = _bufferGuardValue;
 			newNode->next = nullptr;
@@ -108,7 +114,7 @@ namespace azely {
 			{
 				return false;
 			}
-			Node *ptrNode = reinterpret_cast<Node *>(reinterpret_cast<PCHAR>(ptr) - 4);
+			Node *ptrNode = reinterpret_cast<Node *>(reinterpret_cast<PCHAR>(ptr) - offsetof(Node, data));
 			if (ptrNode->BUFFER_GUARD_FRONT != _bufferGuardValue ||
 				ptrNode->BUFFER_GUARD_END != _bufferGuardValue)
 			{
@@ -128,7 +134,7 @@ namespace azely {
 			else
 			{
 				_countPool--;
-				free(ptrNode);
+				FreeNode(ptrNode);
 			}
 			return true;
 		}
@@ -152,10 +158,9 @@ namespace azely {
 		}
 
 	private:
-	#pragma pack(push)
-	#pragma pack(1)
 		/**
 		 * \brief 메모리풀 노드
+		 * \details alignas 멤버를 가진 오브젝트도 정렬이 깨지지 않도록 pack 하지 않습니다
 		 */
 		struct Node
 		{
@@ -164,7 +169,35 @@ namespace azely {
 			UINT BUFFER_GUARD_END = 0;
 			Node *next = nullptr;
 		};
-	#pragma pack(pop)
+
+		/**
+		 * \brief 오브젝트 정렬을 지키는 노드를 할당합니다
+		 * \return 할당된 노드 (생성자 호출 전)
+		 */
+		static Node *AllocNode()
+		{
+#ifdef _WIN32
+			return static_cast<Node *>(_aligned_malloc(sizeof(Node), alignof(Node)));
+#else
+			void *node = nullptr;
+			if (posix_memalign(&node, alignof(Node) < sizeof(void *) ? sizeof(void *) : alignof(Node), sizeof(Node)) != 0) return nullptr;
+			return static_cast<Node *>(node);
+#endif
+		}
+
+		/**
+		 * \brief AllocNode 로 할당한 노드를 해제합니다
+		 * \param node 해제할 노드 (소멸자 호출 후)
+		 */
+		static void FreeNode(Node *node)
+		{
+#ifdef _WIN32
+			_aligned_free(node);
+#else
+			free(node);
+#endif
+		}
+
 		BOOL _isPlacementNew;
 		UINT32 _sizeInitialize;
 		UINT32 _sizeMax;
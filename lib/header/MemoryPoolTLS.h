@@ -0,0 +1,377 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+typedef unsigned int        UINT32;
+
+namespace azely {
+
+	/**
+	 * \brief 스레드마다 매거진을 캐싱하는 멀티스레드용 메모리 풀
+	 * \details 스레드마다 오브젝트 묶음(매거진) 두 개를 들고 있어, 대부분의 Alloc, Free는 잠금과 Interlocked 없이 처리됩니다
+	 * 매거진이 비거나 가득 찼을 때만 공용 창고(depot)에 잠금을 걸어 가득 찬 매거진을 통째로 주고받습니다
+	 * 사용 개수는 스레드마다 따로 센 값을 합하여 반환하므로, 잠금 없이도 정확합니다
+	 * 스레드가 종료되면 그 스레드의 매거진은 풀을 정리할 때까지 재사용되지 않습니다
+	 * \tparam T 메모리 풀을 만들 오브젝트 타입
+	 */
+	template <typename T>
+	class MemoryPoolTLS
+	{
+		enum Constants
+		{
+			MAGAZINE_SIZE = 64
+		};
+
+	public:
+		/**
+		 * \brief 메모리풀 생성자
+		 * \param isPlacementNew 만일 New 시, Alloc, Free 시 placement New를 통해 생성자와 소멸자를 호출합니다.
+		 * \param sizeInitialize 초기 메모리풀 오브젝트 개수 (매거진 단위로 올림하여 창고에 채워둡니다)
+		 */
+		MemoryPoolTLS(BOOL isPlacementNew = true, UINT32 sizeInitialize = 0) : _isPlacementNew(isPlacementNew), _cacheList(nullptr), _countPool(0)
+		{
+			_bufferGuardValue = static_cast<UINT32>(reinterpret_cast<UINT_PTR>(this));
+			_tlsIndex = TlsAlloc();
+			InitializeSRWLock(&_depotSRW);
+
+			for (UINT32 i = 0; i < sizeInitialize; i += MAGAZINE_SIZE)
+			{
+				Node *magazine = nullptr;
+				for (int j = 0; j < MAGAZINE_SIZE; j++)
+				{
+					Node *newNode = CreateNode();
+					if (_isPlacementNew)
+					{
+						GetData(newNode)->~T();
+					}
+					newNode->next = magazine;
+					magazine = newNode;
+				}
+				_depot.push_back(magazine);
+			}
+		}
+
+		/**
+		 * \brief 모든 남아있는 메모리 오브젝트를 정리합니다.
+		 * \details 모든 스레드가 풀 사용을 마친 뒤에 호출해야 합니다
+		 */
+		virtual ~MemoryPoolTLS()
+		{
+			for (Node *magazine : _depot)
+			{
+				DestroyMagazine(magazine);
+			}
+			ThreadCache *cache = _cacheList;
+			while (cache != nullptr)
+			{
+				ThreadCache *nextCache = cache->next;
+				DestroyMagazine(cache->loaded);
+				DestroyMagazine(cache->previous);
+				cache->~ThreadCache();
+				_aligned_free(cache);
+				cache = nextCache;
+			}
+			TlsFree(_tlsIndex);
+		}
+
+		/**
+		 * \brief 메모리풀에서 오브젝트를 할당받습니다.
+		 * \return 할당받은 오브젝트 포인터
+		 */
+		T *Alloc()
+		{
+			ThreadCache *cache = GetThreadCache();
+
+			// 들고 있는 매거진이 비었다면 예비 매거진과 바꾸고, 둘 다 비었다면 창고에서 가득 찬 매거진을 가져옵니다
+			if (cache->loadedCount == 0)
+			{
+				if (cache->previousCount != 0)
+				{
+					SwapMagazine(cache);
+				} else
+				{
+					AcquireSRWLockExclusive(&_depotSRW);
+					if (!_depot.empty())
+					{
+						cache->loaded = _depot.back();
+						cache->loadedCount = MAGAZINE_SIZE;
+						_depot.pop_back();
+					}
+					ReleaseSRWLockExclusive(&_depotSRW);
+				}
+			}
+
+			cache->countAlloc++;
+
+			// 창고도 비었다면 새 노드를 만듭니다
+			if (cache->loadedCount == 0)
+			{
+				return GetData(CreateNode());
+			}
+
+			Node *returnNode = cache->loaded;
+			cache->loaded = returnNode->next;
+			cache->loadedCount--;
+			if (_isPlacementNew)
+			{
+				new (GetData(returnNode)) T;
+			}
+			return GetData(returnNode);
+		}
+
+		/**
+		 * \brief 메모리풀에 오브젝트를 반납합니다.
+		 * \details 다른 스레드에서 할당받은 오브젝트도 반납할 수 있습니다
+		 * \param ptr 반납할 오브젝트 포인터
+		 * \return 성공 실패여부
+		 */
+		BOOL Free(T *ptr)
+		{
+			return FreeToCache(GetThreadCache(), ptr);
+		}
+
+		/**
+		 * \brief 여러 오브젝트를 한 번에 메모리풀에 반납합니다.
+		 * \details 스레드 캐시를 한 번만 찾고, 오브젝트마다 Free와 같은 방식으로 반납합니다
+		 * \param ptrs 반납할 오브젝트 포인터 배열
+		 * \param count 오브젝트 개수
+		 * \return 모두 반납했는지 여부
+		 */
+		BOOL FreeBulk(T *const *ptrs, INT32 count)
+		{
+			ThreadCache *cache = GetThreadCache();
+			BOOL freeResult = true;
+			for (INT32 i = 0; i < count; i++)
+			{
+				if (!FreeToCache(cache, ptrs[i])) freeResult = false;
+			}
+			return freeResult;
+		}
+
+		/**
+		 * \brief 사용자에게 넘겨진 메모리풀 오브젝트 개수를 반환합니다
+		 * \details 스레드마다 센 할당 개수와 반납 개수의 차이를 합합니다
+		 * \return  사용되는 메모리풀 오브젝트 개수
+		 */
+		UINT32 GetCountUse()
+		{
+			INT64 countUse = 0;
+			AcquireSRWLockShared(&_depotSRW);
+			for (ThreadCache *cache = _cacheList; cache != nullptr; cache = cache->next)
+			{
+				countUse += cache->countAlloc - cache->countFree;
+			}
+			ReleaseSRWLockShared(&_depotSRW);
+			return static_cast<UINT32>(countUse);
+		}
+
+		/**
+		 * \brief 메모리풀이 관리하는 모든 오브젝트 개수를 반환합니다
+		 * \return 메모리풀이 할당한 모든 오브젝트 개수
+		 */
+		UINT32 GetCountPool()
+		{
+			return _countPool;
+		}
+
+	private:
+		/**
+		 * \brief 메모리풀 노드
+		 * \details alignas 멤버를 가진 오브젝트도 정렬이 깨지지 않도록 pack 하지 않습니다
+		 * 오브젝트는 정렬을 맞춘 공간에 placement new로 만들어, 노드가 표준 레이아웃이 되어 offsetof로 노드를 되찾을 수 있습니다
+		 */
+		struct Node
+		{
+			UINT BUFFER_GUARD_FRONT;
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type data;
+			UINT BUFFER_GUARD_END;
+			Node *next;
+		};
+
+		/**
+		 * \brief 스레드마다 가지는 매거진 캐시
+		 * \details 예비 매거진은 항상 비었거나 가득 찬 상태입니다
+		 * 할당, 반납 개수는 소유 스레드만 쓰고, GetCountUse에서 읽기만 합니다
+		 */
+		struct ThreadCache
+		{
+			Node *loaded = nullptr;
+			UINT32 loadedCount = 0;
+			Node *previous = nullptr;
+			UINT32 previousCount = 0;
+			alignas(64) volatile INT64 countAlloc = 0;
+			volatile INT64 countFree = 0;
+			ThreadCache *next = nullptr;
+		};
+
+		/**
+		 * \brief 현재 스레드의 매거진 캐시를 반환합니다
+		 * \details 처음 사용하는 스레드라면 캐시를 만들어 목록에 등록합니다
+		 * \return 현재 스레드의 매거진 캐시
+		 */
+		ThreadCache *GetThreadCache()
+		{
+			ThreadCache *cache = static_cast<ThreadCache *>(TlsGetValue(_tlsIndex));
+			if (cache != nullptr)
+			{
+				return cache;
+			}
+			// 캐시는 alignas(64) 멤버를 가지므로 캐시라인 정렬된 메모리에 생성합니다
+			cache = new (_aligned_malloc(sizeof(ThreadCache), alignof(ThreadCache))) ThreadCache;
+			AcquireSRWLockExclusive(&_depotSRW);
+			cache->next = _cacheList;
+			_cacheList = cache;
+			ReleaseSRWLockExclusive(&_depotSRW);
+			TlsSetValue(_tlsIndex, cache);
+			return cache;
+		}
+
+		/**
+		 * \brief 주어진 스레드 캐시에 오브젝트를 반납합니다
+		 * \param cache 현재 스레드의 매거진 캐시
+		 * \param ptr 반납할 오브젝트 포인터
+		 * \return 성공 실패여부
+		 */
+		BOOL FreeToCache(ThreadCache *cache, T *ptr)
+		{
+			if (ptr == nullptr)
+			{
+				return false;
+			}
+			Node *ptrNode = reinterpret_cast<Node *>(reinterpret_cast<PCHAR>(ptr) - offsetof(Node, data));
+			if (ptrNode->BUFFER_GUARD_FRONT != _bufferGuardValue ||
+				ptrNode->BUFFER_GUARD_END != _bufferGuardValue)
+			{
+				// STACK GUARD CHECK FAILED
+				return false;
+			}
+			if (_isPlacementNew)
+			{
+				GetData(ptrNode)->~T();
+			}
+
+			// 들고 있는 매거진이 가득 찼다면 예비 매거진과 바꾸고, 예비 매거진도 가득 찼다면 예비 매거진을 창고에 넣습니다
+			if (cache->loadedCount == MAGAZINE_SIZE)
+			{
+				if (cache->previousCount == 0)
+				{
+					SwapMagazine(cache);
+				} else
+				{
+					AcquireSRWLockExclusive(&_depotSRW);
+					_depot.push_back(cache->previous);
+					ReleaseSRWLockExclusive(&_depotSRW);
+					cache->previous = cache->loaded;
+					cache->previousCount = MAGAZINE_SIZE;
+					cache->loaded = nullptr;
+					cache->loadedCount = 0;
+				}
+			}
+
+			ptrNode->next = cache->loaded;
+			cache->loaded = ptrNode;
+			cache->loadedCount++;
+			cache->countFree++;
+			return true;
+		}
+
+		/**
+		 * \brief 들고 있는 매거진과 예비 매거진을 바꿉니다
+		 * \param cache 현재 스레드의 매거진 캐시
+		 */
+		static void SwapMagazine(ThreadCache *cache)
+		{
+			Node *magazine = cache->loaded;
+			UINT32 magazineCount = cache->loadedCount;
+			cache->loaded = cache->previous;
+			cache->loadedCount = cache->previousCount;
+			cache->previous = magazine;
+			cache->previousCount = magazineCount;
+		}
+
+		/**
+		 * \brief 노드에 담긴 오브젝트를 반환합니다
+		 * \param node 노드
+		 * \return 노드의 오브젝트 공간
+		 */
+		static T *GetData(Node *node)
+		{
+			return reinterpret_cast<T *>(&node->data);
+		}
+
+		/**
+		 * \brief 새 노드를 만들고 풀 전체 오브젝트 개수를 늘립니다
+		 * \return 오브젝트가 생성된 노드
+		 */
+		Node *CreateNode()
+		{
+			Node *newNode = AllocNode();
+			newNode->BUFFER_GUARD_FRONT = _bufferGuardValue;
+			newNode->BUFFER_GUARD_END = _bufferGuardValue;
+			newNode->next = nullptr;
+			new (GetData(newNode)) T;
+			InterlockedIncrement(&_countPool);
+			return newNode;
+		}
+
+		/**
+		 * \brief 매거진의 노드를 모두 해제합니다
+		 * \param magazine 해제할 매거진의 첫 노드
+		 */
+		void DestroyMagazine(Node *magazine)
+		{
+			while (magazine != nullptr)
+			{
+				Node *nextNode = magazine->next;
+				if (!_isPlacementNew)
+				{
+					GetData(magazine)->~T();
+				}
+				FreeNode(magazine);
+				magazine = nextNode;
+				_countPool--;
+			}
+		}
+
+		/**
+		 * \brief 오브젝트 정렬을 지키는 노드를 할당합니다
+		 * \return 할당된 노드 (생성자 호출 전)
+		 */
+		static Node *AllocNode()
+		{
+#ifdef _WIN32
+			return static_cast<Node *>(_aligned_malloc(sizeof(Node), alignof(Node)));
+#else
+			void *node = nullptr;
+			if (posix_memalign(&node, alignof(Node) < sizeof(void *) ? sizeof(void *) : alignof(Node), sizeof(Node)) != 0) return nullptr;
+			return static_cast<Node *>(node);
+#endif
+		}
+
+		/**
+		 * \brief AllocNode 로 할당한 노드를 해제합니다
+		 * \param node 해제할 노드 (소멸자 호출 후)
+		 */
+		static void FreeNode(Node *node)
+		{
+#ifdef _WIN32
+			_aligned_free(node);
+#else
+			free(node);
+#endif
+		}
+
+		BOOL _isPlacementNew;
+		DWORD _tlsIndex;
+		SRWLOCK _depotSRW;
+		std::vector<Node *> _depot;
+		ThreadCache *_cacheList;
+		volatile LONG _countPool;
+
+		UINT32 _bufferGuardValue;
+	};
+
+}
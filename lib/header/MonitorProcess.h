@@ -45,16 +45,25 @@ namespace azely
 	private:
 
 		HANDLE			handleProcess;
+#ifdef _WIN32
 		WCHAR			processName[MAX_PATH];
+#endif
 		INT32			numberOfProcessors;
 
 		FLOAT			processTotal;
 		FLOAT			processUser;
 		FLOAT			processKernel;
 
+#ifdef _WIN32
 		ULARGE_INTEGER	processLastUser;
 		ULARGE_INTEGER	processLastKernel;
 		ULARGE_INTEGER	processLastTime;
+#else
+		// 마이크로초 단위
+		DWORD64			processLastUser;
+		DWORD64			processLastKernel;
+		DWORD64			processLastTime;
+#endif
 		DWORD64			privateMemoryBytes;
 
 	};
@@ -14,6 +14,7 @@ namespace azely
 
 	private:
 
+#ifdef _WIN32
 		struct EthernetPDH
 		{
 			bool used;
@@ -21,6 +22,7 @@ namespace azely
 			PDH_HCOUNTER counterNetworkRecvBytes;
 			PDH_HCOUNTER counterNetworkSendBytes;
 		};
+#endif
 
 	public:
 
@@ -96,25 +98,44 @@ namespace azely
 
 		HANDLE			handleProcess;
 		INT32			numberOfProcessors;
+#ifdef _WIN32
 		PDH_HQUERY		nonPagedPoolQuery;
 		PDH_HQUERY		availableMemoryQuery;
 		PDH_HQUERY		ethernetQuery;
 		WCHAR			processName[MAX_PATH];
+#endif
 
 		
 		DOUBLE			processorTotal;
 		DOUBLE			processorUser;
 		DOUBLE			processorKernel;
+#ifdef _WIN32
 		ULARGE_INTEGER	processorLastKernel;
 		ULARGE_INTEGER	processorLastUser;
 		ULARGE_INTEGER	processorLastIdle;
+#else
+		DWORD64			processorLastKernel;
+		DWORD64			processorLastUser;
+		DWORD64			processorLastIdle;
+#endif
 
+#ifdef _WIN32
 		PDH_HCOUNTER	nonPagedPoolCounter;
+#endif
 		DWORD64			nonPagedPoolBytes;
+#ifdef _WIN32
 		PDH_HCOUNTER	availableMemoryCounter;
+#endif
 		DWORD64			availableMemoryBytes;
 
+#ifdef _WIN32
 		EthernetPDH		ethernetData[PDH_ETHERNET_MAX];
+#else
+		// /proc/net/dev 의 누적 바이트로부터 초당 바이트를 계산합니다
+		DWORD64			networkLastRecvBytes;
+		DWORD64			networkLastSendBytes;
+		DWORD			networkLastTime;
+#endif
 		DOUBLE			networkRecvBytes;
 		DOUBLE			networkSendBytes;
 
@@ -1,25 +1,147 @@
-﻿#define _SIMPLE_HEADER
+﻿#pragma once
+
+#include "Checksum.h"
+
+#define _SIMPLE_HEADER
 
-#define NETWORK_HEADER_SIZE sizeof(NetworkHeader)
 #define NETWORK_SECURE_CODE 0x89
 
+// 헤더의 길이 필드는 7비트씩 나누어 담는 가변 길이 정수로, 최대 NETWORK_LENGTH_SIZE_MAX 바이트를 사용합니다
+// 127 바이트 이하의 메시지는 길이 필드가 1 바이트이므로, 기존 고정 길이 헤더와 같은 모양이 됩니다
+#define NETWORK_LENGTH_SIZE_MAX 4
+#define NETWORK_MESSAGE_SIZE_LIMIT ((1 << (7 * NETWORK_LENGTH_SIZE_MAX)) - 1)
+
+#ifdef _SIMPLE_HEADER
+#define NETWORK_HEADER_SIZE_MIN 2
+#else
+#define NETWORK_HEADER_SIZE_MIN 6
+#endif
+#define NETWORK_HEADER_SIZE_MAX (NETWORK_HEADER_SIZE_MIN - 1 + NETWORK_LENGTH_SIZE_MAX)
+
+// _SIMPLE_HEADER 가 아닐 때 헤더의 checksum 필드를 계산할 함수 (const UCHAR *data, size_t size) -> UINT32
+// 무결성 검사 방식을 바꾸려면 이 정의만 바꾸면 됩니다
+#define NETWORK_CHECKSUM(data, size) Checksum::CRC32C(data, size)
+
 namespace azely
 {
-	#pragma pack(push, 1)
+	/**
+	 * \brief 네트워크 헤더
+	 * \details 네트워크에서는 secureCode, 가변 길이 length, (리틀 엔디언 4바이트 checksum) 순서로 주고받으며, 이 구조체는 해석한 값을 담습니다
+	 */
 	struct NetworkHeader
 	{
-#ifdef _SIMPLE_HEADER
 		BYTE secureCode;
-		BYTE length;
-#else
-		unsigned char secureCode;
-		unsigned short length;
-		unsigned char checksum;
+		UINT32 length;
+#ifndef _SIMPLE_HEADER
+		UINT32 checksum;
 #endif
 	};
-	#pragma pack(pop)
 
+	/**
+	 * \brief 네트워크 헤더를 바이트 열로 만듭니다
+	 * \param header 만들 헤더
+	 * \param outBuffer [out] 헤더를 쓸 버퍼 (NETWORK_HEADER_SIZE_MAX 이상)
+	 * \return 쓴 헤더 크기
+	 */
+	__inline INT32 EncodeNetworkHeader(const NetworkHeader *header, PUCHAR outBuffer)
+	{
+		INT32 index = 0;
+		outBuffer[index++] = header->secureCode;
+		UINT32 length = header->length;
+		while (length >= 0x80)
+		{
+			outBuffer[index++] = static_cast<UCHAR>(length | 0x80);
+			length >>= 7;
+		}
+		outBuffer[index++] = static_cast<UCHAR>(length);
+#ifndef _SIMPLE_HEADER
+		for (int i = 0; i < 4; i++)
+		{
+			outBuffer[index++] = static_cast<UCHAR>(header->checksum >> (8 * i));
+		}
+#endif
+		return index;
+	}
+
+	/**
+	 * \brief 바이트 열에서 네트워크 헤더를 해석합니다
+	 * \param buffer 해석할 버퍼
+	 * \param size 버퍼 크기
+	 * \param outHeader [out] 해석한 헤더
+	 * \return 헤더 크기, 헤더가 아직 다 오지 않았다면 0, 잘못된 헤더라면 -1
+	 */
+	__inline INT32 DecodeNetworkHeader(const UCHAR *buffer, INT32 size, NetworkHeader *outHeader)
+	{
+		if (size < 1) return 0;
+		outHeader->secureCode = buffer[0];
+		if (outHeader->secureCode != NETWORK_SECURE_CODE) return -1;
 
+		INT32 index = 1;
+		UINT32 length = 0;
+		for (INT32 shift = 0; ; shift += 7)
+		{
+			if (index > NETWORK_LENGTH_SIZE_MAX) return -1;
+			if (index >= size) return 0;
+			UCHAR lengthByte = buffer[index++];
+			length |= static_cast<UINT32>(lengthByte & 0x7F) << shift;
+			if ((lengthByte & 0x80) == 0) break;
+		}
+		outHeader->length = length;
+#ifndef _SIMPLE_HEADER
+		if (index + 4 > size) return 0;
+		outHeader->checksum = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			outHeader->checksum |= static_cast<UINT32>(buffer[index++]) << (8 * i);
+		}
+#endif
+		return index;
+	}
 
+	/**
+	 * \brief 수신한 데이터 안에서 찾은 메시지 하나의 위치
+	 */
+	struct NetworkFrame
+	{
+		INT32 offset;
+		INT32 length;
+#ifndef _SIMPLE_HEADER
+		UINT32 checksum;
+#endif
+	};
+
+	/**
+	 * \brief 연속된 수신 데이터를 한 번 훑어 완성된 메시지들의 위치를 찾습니다
+	 * \details 헤더가 잘못되었거나, 페이로드가 lengthMax보다 크거나, 다 오지 않은 메시지를 만나면 그 앞에서 멈춥니다
+	 * \param buffer 훑을 버퍼
+	 * \param size 버퍼 크기
+	 * \param lengthMax 받을 수 있는 페이로드 최대 크기
+	 * \param outFrames [out] 찾은 메시지들 (offset은 버퍼 처음부터 페이로드까지의 거리)
+	 * \param frameMax outFrames 크기
+	 * \param outScannedSize [out] 찾은 메시지들이 차지하는 크기 (헤더 포함)
+	 * \return 찾은 메시지 개수
+	 */
+	__inline INT32 DecodeNetworkFrames(const UCHAR *buffer, INT32 size, UINT32 lengthMax, NetworkFrame *outFrames, INT32 frameMax, PINT32 outScannedSize)
+	{
+		INT32 scannedSize = 0;
+		INT32 frameCount = 0;
+		while (frameCount < frameMax)
+		{
+			NetworkHeader header;
+			INT32 remainSize = size - scannedSize;
+			INT32 headerSize = DecodeNetworkHeader(buffer + scannedSize, remainSize, &header);
+			if (headerSize <= 0 || header.length > lengthMax || remainSize - headerSize < static_cast<INT32>(header.length)) break;
+
+			NetworkFrame *frame = &outFrames[frameCount++];
+			frame->offset = scannedSize + headerSize;
+			frame->length = static_cast<INT32>(header.length);
+#ifndef _SIMPLE_HEADER
+			frame->checksum = header.checksum;
+#endif
+			scannedSize = frame->offset + frame->length;
+		}
+		*outScannedSize = scannedSize;
+		return frameCount;
+	}
 
 }
\ No newline at end of file
@@ -0,0 +1,194 @@
+﻿#pragma once
+
+#include "Core.h"
+#include "MemoryPoolTLS.h"
+#include "SerializedBuffer.h"
+
+namespace azely {
+
+	/**
+	 * \brief 크기 등급별 직렬화 버퍼 풀
+	 * \details 버퍼 크기를 64, 256, 1460, 16K, 64K 등급으로 나누어 등급마다 MemoryPoolTLS를 따로 두고, 요청한 크기가 들어가는 가장 작은 등급에서 할당합니다
+	 * 풀의 버퍼는 SerializedBufferInline이므로 오브젝트와 버퍼가 한 번에 할당됩니다 / 가장 큰 등급보다 큰 버퍼는 풀을 거치지 않고 따로 할당합니다
+	 * 반납할 때는 버퍼 크기로 등급을 찾으므로, 다른 스레드에서 할당한 버퍼도 반납할 수 있습니다
+	 */
+	class PacketPool
+	{
+	public:
+		enum Constants
+		{
+			SIZE_CLASS_64,
+			SIZE_CLASS_256,
+			SIZE_CLASS_1460,
+			SIZE_CLASS_16K,
+			SIZE_CLASS_64K,
+			SIZE_CLASS_COUNT
+		};
+
+		PacketPool() : pool64(false), pool256(false), pool1460(false), pool16K(false), pool64K(false)
+		{
+		}
+
+		/**
+		 * \brief 버퍼 크기가 들어가는 가장 작은 크기 등급을 리턴합니다
+		 * \param bufferSize 필요한 버퍼 크기
+		 * \return 크기 등급, 가장 큰 등급보다 크다면 SIZE_CLASS_COUNT
+		 */
+		static INT32 GetSizeClass(INT32 bufferSize)
+		{
+			if (bufferSize <= 64) return SIZE_CLASS_64;
+			if (bufferSize <= 256) return SIZE_CLASS_256;
+			if (bufferSize <= SerializedBuffer::BUFFER_SIZE_DEFAULT) return SIZE_CLASS_1460;
+			if (bufferSize <= 16384) return SIZE_CLASS_16K;
+			if (bufferSize <= 65536) return SIZE_CLASS_64K;
+			return SIZE_CLASS_COUNT;
+		}
+
+		/**
+		 * \brief 버퍼 크기에 맞는 등급에서 직렬화 버퍼를 할당합니다
+		 * \param bufferSize 필요한 버퍼 크기
+		 * \return 할당한 직렬화 버퍼 (초기화하지 않은 상태, 버퍼 크기는 등급 크기)
+		 */
+		SerializedBuffer *Alloc(INT32 bufferSize)
+		{
+			switch (GetSizeClass(bufferSize))
+			{
+			case SIZE_CLASS_64:
+				return pool64.Alloc();
+			case SIZE_CLASS_256:
+				return pool256.Alloc();
+			case SIZE_CLASS_1460:
+				return pool1460.Alloc();
+			case SIZE_CLASS_16K:
+				return pool16K.Alloc();
+			case SIZE_CLASS_64K:
+				return pool64K.Alloc();
+			default:
+				return new SerializedBuffer(bufferSize);
+			}
+		}
+
+		/**
+		 * \brief Alloc으로 할당한 직렬화 버퍼를 등급에 맞는 풀에 반납합니다
+		 * \param packet 반납할 직렬화 버퍼
+		 */
+		VOID Free(SerializedBuffer *packet)
+		{
+			switch (GetSizeClass(packet->GetBufferSizeTotal()))
+			{
+			case SIZE_CLASS_64:
+				pool64.Free(static_cast<SerializedBufferInline<64> *>(packet));
+				break;
+			case SIZE_CLASS_256:
+				pool256.Free(static_cast<SerializedBufferInline<256> *>(packet));
+				break;
+			case SIZE_CLASS_1460:
+				pool1460.Free(static_cast<SerializedBufferInline<SerializedBuffer::BUFFER_SIZE_DEFAULT> *>(packet));
+				break;
+			case SIZE_CLASS_16K:
+				pool16K.Free(static_cast<SerializedBufferInline<16384> *>(packet));
+				break;
+			case SIZE_CLASS_64K:
+				pool64K.Free(static_cast<SerializedBufferInline<65536> *>(packet));
+				break;
+			default:
+				delete packet;
+				break;
+			}
+		}
+
+		/**
+		 * \brief 여러 직렬화 버퍼를 한 번에 반납합니다
+		 * \details 같은 등급이 연속된 구간마다 그 등급 풀의 FreeBulk를 한 번 호출합니다
+		 * \param packets 반납할 직렬화 버퍼 배열
+		 * \param count 직렬화 버퍼 개수
+		 */
+		VOID FreeBulk(SerializedBuffer *const *packets, INT32 count)
+		{
+			INT32 runBegin = 0;
+			while (runBegin < count)
+			{
+				INT32 sizeClass = GetSizeClass(packets[runBegin]->GetBufferSizeTotal());
+				INT32 runEnd = runBegin + 1;
+				while (runEnd < count && GetSizeClass(packets[runEnd]->GetBufferSizeTotal()) == sizeClass)
+				{
+					runEnd++;
+				}
+
+				switch (sizeClass)
+				{
+				case SIZE_CLASS_64:
+					FreeRun(pool64, packets + runBegin, runEnd - runBegin);
+					break;
+				case SIZE_CLASS_256:
+					FreeRun(pool256, packets + runBegin, runEnd - runBegin);
+					break;
+				case SIZE_CLASS_1460:
+					FreeRun(pool1460, packets + runBegin, runEnd - runBegin);
+					break;
+				case SIZE_CLASS_16K:
+					FreeRun(pool16K, packets + runBegin, runEnd - runBegin);
+					break;
+				case SIZE_CLASS_64K:
+					FreeRun(pool64K, packets + runBegin, runEnd - runBegin);
+					break;
+				default:
+					for (INT32 i = runBegin; i < runEnd; i++)
+					{
+						delete packets[i];
+					}
+					break;
+				}
+				runBegin = runEnd;
+			}
+		}
+
+		/**
+		 * \brief 모든 등급의 풀이 만든 직렬화 버퍼 개수를 리턴합니다
+		 * \return 풀이 만든 직렬화 버퍼 개수
+		 */
+		UINT32 GetCountPool()
+		{
+			return pool64.GetCountPool() + pool256.GetCountPool() + pool1460.GetCountPool() + pool16K.GetCountPool() + pool64K.GetCountPool();
+		}
+
+		/**
+		 * \brief 모든 등급의 풀에서 사용중인 직렬화 버퍼 개수를 리턴합니다
+		 * \return 사용중인 직렬화 버퍼 개수
+		 */
+		UINT32 GetCountUse()
+		{
+			return pool64.GetCountUse() + pool256.GetCountUse() + pool1460.GetCountUse() + pool16K.GetCountUse() + pool64K.GetCountUse();
+		}
+
+	private:
+		/**
+		 * \brief 같은 등급의 직렬화 버퍼들을 그 등급 풀에 한 번에 반납합니다
+		 * \param pool 등급 풀
+		 * \param packets 반납할 직렬화 버퍼 배열
+		 * \param count 직렬화 버퍼 개수
+		 */
+		template <typename InlineBuffer>
+		static VOID FreeRun(MemoryPoolTLS<InlineBuffer> &pool, SerializedBuffer *const *packets, INT32 count)
+		{
+			const INT32 chunkMax = 64;
+			InlineBuffer *castPackets[chunkMax];
+			for (INT32 freed = 0; freed < count; freed += chunkMax)
+			{
+				INT32 chunk = min(count - freed, chunkMax);
+				for (INT32 i = 0; i < chunk; i++)
+				{
+					castPackets[i] = static_cast<InlineBuffer *>(packets[freed + i]);
+				}
+				pool.FreeBulk(castPackets, chunk);
+			}
+		}
+
+		MemoryPoolTLS<SerializedBufferInline<64>>									pool64;
+		MemoryPoolTLS<SerializedBufferInline<256>>									pool256;
+		MemoryPoolTLS<SerializedBufferInline<SerializedBuffer::BUFFER_SIZE_DEFAULT>>	pool1460;
+		MemoryPoolTLS<SerializedBufferInline<16384>>								pool16K;
+		MemoryPoolTLS<SerializedBufferInline<65536>>								pool64K;
+	};
+
+}
\ No newline at end of file
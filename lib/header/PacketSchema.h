@@ -0,0 +1,186 @@
+﻿#pragma once
+
+#include "Core.h"
+#include "SerializedBuffer.h"
+#include "PacketView.h"
+#include "RingBuffer.h"
+
+#include <type_traits>
+
+//----------------------------------------------------------
+// 메시지 스키마로부터 고정 레이아웃 메시지 구조체를 만드는 매크로
+//----------------------------------------------------------
+//
+// 메시지마다 필드 목록 매크로를 정의하고 PACKET_DEFINE에 넘기면, 전처리기가 메시지 구조체와 직렬화 함수를 만들어냅니다
+// 필드 목록 매크로는 FIELD(타입, 이름)과 ARRAY(원소 타입, 이름, 최대 개수)를 받아 필드를 순서대로 나열합니다
+// FIELD는 크기가 고정된 기본 타입 필드이며, ARRAY는 USHORT 개수 뒤에 원소들이 이어지는 가변 길이 필드입니다
+// 와이어 포맷은 USHORT 메시지 타입, 모든 FIELD, 모든 ARRAY 순서이며, 직렬화 버퍼의 >> 연산자와 같은 바이트 순서를 씁니다
+// 정의는 #pragma pack(push, 1) 과 #pragma pack(pop) 사이에 두어야 하며, 빠뜨리면 컴파일되지 않습니다
+// FIELD는 정렬되지 않은 위치에 놓일 수 있으므로, 값으로 읽고 쓰며 참조나 포인터로 넘기지 않아야 합니다 (직렬화 버퍼의 >> 연산자도 참조를 받습니다)
+//
+// #define PACKET_CHAT(FIELD, ARRAY)	FIELD(UINT32, roomID) FIELD(DWORD64, senderID) ARRAY(WCHAR, text, 256)
+//
+// #pragma pack(push, 1)
+// PACKET_DEFINE(ChatMessage, MESSAGE_CHAT, PACKET_CHAT)
+// #pragma pack(pop)
+//
+// 만들어진 구조체는 MessageDispatcher에 그대로 등록할 수 있습니다 (Deserialize는 메시지 타입 뒤의 페이로드를 읽습니다)
+// 링버퍼에 바로 직렬화할 때는 GetSerializedSize 크기로 Reserve한 구간을 SerializeTo에 넘긴 뒤 Commit합니다 (미러 모드가 아니라면 끊긴 구간에 나누어 씁니다)
+
+namespace azely
+{
+	/**
+	 * \brief 예약 구간의 offset 위치부터 데이터를 복사하며, first 구간이 끝나면 나머지는 second 구간에 이어 씁니다
+	 * \param reservation RingBuffer::Reserve로 예약한 구간
+	 * \param offset 예약 구간 안에서 쓰기 시작할 위치
+	 * \param data 쓸 데이터
+	 * \param size 쓸 크기
+	 */
+	inline VOID PacketWriteReservation(RingBuffer::Reservation &reservation, INT32 offset, const VOID *data, INT32 size)
+	{
+		const UCHAR *source = static_cast<const UCHAR *>(data);
+		if (offset < reservation.firstSize)
+		{
+			INT32 firstWriteSize = reservation.firstSize - offset < size ? reservation.firstSize - offset : size;
+			memcpy(reservation.first + offset, source, firstWriteSize);
+			source += firstWriteSize;
+			offset += firstWriteSize;
+			size -= firstWriteSize;
+		}
+		if (size > 0)
+		{
+			memcpy(reservation.second + (offset - reservation.firstSize), source, size);
+		}
+	}
+}
+
+#define PACKET_DECLARE_FIELD(fieldType, fieldName) \
+	static_assert(std::is_arithmetic<fieldType>::value, "PACKET field must be an arithmetic type"); \
+	fieldType fieldName;
+#define PACKET_DECLARE_ARRAY(elementType, arrayName, countMax) \
+	static_assert(std::is_arithmetic<elementType>::value, "PACKET array must hold an arithmetic type"); \
+	static_assert((countMax) > 0 && (countMax) <= 0xFFFF, "PACKET array count must fit in USHORT"); \
+	elementType arrayName[countMax]; \
+	USHORT arrayName##Count;
+#define PACKET_SIZE_FIELD(fieldType, fieldName) + static_cast<INT32>(sizeof(fieldType))
+#define PACKET_SIZE_ARRAY(elementType, arrayName, countMax) + static_cast<INT32>(sizeof(USHORT) + arrayName##Count * sizeof(elementType))
+#define PACKET_WRITE_ARRAY(elementType, arrayName, countMax) \
+	memcpy(cursor, &arrayName##Count, sizeof(USHORT)); \
+	cursor += sizeof(USHORT); \
+	memcpy(cursor, arrayName, arrayName##Count * sizeof(elementType)); \
+	cursor += arrayName##Count * sizeof(elementType);
+#define PACKET_WRITE_ARRAY_RESERVATION(elementType, arrayName, countMax) \
+	azely::PacketWriteReservation(reservation, offset, &arrayName##Count, sizeof(USHORT)); \
+	offset += sizeof(USHORT); \
+	azely::PacketWriteReservation(reservation, offset, arrayName, arrayName##Count * sizeof(elementType)); \
+	offset += arrayName##Count * sizeof(elementType);
+#define PACKET_READ_ARRAY(elementType, arrayName, countMax) \
+	if (end - cursor < static_cast<INT32>(sizeof(USHORT))) return -1; \
+	memcpy(&arrayName##Count, cursor, sizeof(USHORT)); \
+	cursor += sizeof(USHORT); \
+	if (arrayName##Count > (countMax) || end - cursor < static_cast<INT32>(arrayName##Count * sizeof(elementType))) return -1; \
+	memcpy(arrayName, cursor, arrayName##Count * sizeof(elementType)); \
+	cursor += arrayName##Count * sizeof(elementType);
+#define PACKET_IGNORE_FIELD(fieldType, fieldName)
+#define PACKET_IGNORE_ARRAY(elementType, arrayName, countMax)
+
+/**
+ * \brief 필드 목록으로 메시지 구조체를 정의합니다
+ * \details 메시지 타입과 FIELD들은 packetName##Layout 구조체에 빈틈 없이 모여 있어, 고정 부분은 memcpy 한 번으로 읽고 씁니다
+ * ARRAY가 없는 메시지는 고정 부분이 전부이므로, 직렬화와 역직렬화가 크기 검사 한 번과 memcpy 한 번으로 끝납니다
+ * ARRAY가 있다면 전체 크기를 먼저 계산하여 버퍼 크기를 한 번만 검사한 뒤 필드마다 검사 없이 복사합니다
+ * \param packetName 메시지 구조체 이름
+ * \param packetType 메시지 타입 번호 (USHORT)
+ * \param PACKET_FIELDS 필드 목록 매크로
+ */
+#define PACKET_DEFINE(packetName, packetType, PACKET_FIELDS) \
+	struct packetName##Layout \
+	{ \
+		USHORT messageType; \
+		PACKET_FIELDS(PACKET_DECLARE_FIELD, PACKET_IGNORE_ARRAY) \
+	}; \
+	static_assert(static_cast<INT32>(sizeof(packetName##Layout)) == static_cast<INT32>(sizeof(USHORT)) PACKET_FIELDS(PACKET_SIZE_FIELD, PACKET_IGNORE_ARRAY), \
+		#packetName " must be defined between #pragma pack(push, 1) and #pragma pack(pop)"); \
+	struct packetName : public packetName##Layout \
+	{ \
+		enum Constants \
+		{ \
+			MESSAGE_TYPE = (packetType), \
+			FIXED_SIZE = sizeof(packetName##Layout), \
+		}; \
+		\
+		PACKET_FIELDS(PACKET_IGNORE_FIELD, PACKET_DECLARE_ARRAY) \
+		\
+		packetName() \
+		{ \
+			messageType = MESSAGE_TYPE; \
+		} \
+		\
+		/* 메시지 타입을 포함한 직렬화 크기를 리턴합니다 */ \
+		INT32 GetSerializedSize() const \
+		{ \
+			return FIXED_SIZE PACKET_FIELDS(PACKET_IGNORE_FIELD, PACKET_SIZE_ARRAY); \
+		} \
+		\
+		/* GetSerializedSize 크기 이상의 메모리에 메시지 타입부터 직렬화하고, 쓴 크기를 리턴합니다 */ \
+		INT32 SerializeTo(PUCHAR out) const \
+		{ \
+			PUCHAR cursor = out; \
+			memcpy(cursor, static_cast<const packetName##Layout *>(this), FIXED_SIZE); \
+			cursor += FIXED_SIZE; \
+			PACKET_FIELDS(PACKET_IGNORE_FIELD, PACKET_WRITE_ARRAY) \
+			return static_cast<INT32>(cursor - out); \
+		} \
+		\
+		/* 링버퍼에 예약한 구간에 메시지 타입부터 직렬화하고 쓴 크기를 리턴합니다, 예약 구간이 부족하면 아무것도 쓰지 않고 -1을 리턴합니다 */ \
+		INT32 SerializeTo(azely::RingBuffer::Reservation &reservation) const \
+		{ \
+			INT32 serializedSize = GetSerializedSize(); \
+			if (reservation.firstSize + reservation.secondSize < serializedSize) return -1; \
+			if (reservation.firstSize >= serializedSize) return SerializeTo(reinterpret_cast<PUCHAR>(reservation.first)); \
+			INT32 offset = 0; \
+			azely::PacketWriteReservation(reservation, offset, static_cast<const packetName##Layout *>(this), FIXED_SIZE); \
+			offset += FIXED_SIZE; \
+			PACKET_FIELDS(PACKET_IGNORE_FIELD, PACKET_WRITE_ARRAY_RESERVATION) \
+			return offset; \
+		} \
+		\
+		/* 직렬화 버퍼의 쓰기 위치에 메시지 타입부터 직렬화합니다, 남은 공간이 부족하면 아무것도 쓰지 않고 false를 리턴합니다 */ \
+		BOOL Serialize(SerializedBuffer &buffer) const \
+		{ \
+			INT32 serializedSize = GetSerializedSize(); \
+			if (buffer.GetBufferSizeFree() < serializedSize) return false; \
+			INT32 movedSize; \
+			return buffer.MoveWritePointer(SerializeTo(buffer.GetBufferWrite()), &movedSize); \
+		} \
+		\
+		/* 메시지 타입 뒤의 페이로드를 읽어들이고 읽은 크기를 리턴합니다, 페이로드가 잘못되었다면 -1을 리턴합니다 */ \
+		INT32 DeserializeFrom(const UCHAR *data, INT32 size) \
+		{ \
+			const INT32 fixedBodySize = FIXED_SIZE - static_cast<INT32>(sizeof(USHORT)); \
+			if (size < fixedBodySize) return -1; \
+			memcpy(reinterpret_cast<PUCHAR>(static_cast<packetName##Layout *>(this)) + sizeof(USHORT), data, fixedBodySize); \
+			const UCHAR *cursor = data + fixedBodySize; \
+			const UCHAR *end = data + size; \
+			(void)end; \
+			PACKET_FIELDS(PACKET_IGNORE_FIELD, PACKET_READ_ARRAY) \
+			return static_cast<INT32>(cursor - data); \
+		} \
+		\
+		/* 직렬화 버퍼의 읽기 위치부터 메시지 타입 뒤의 페이로드를 읽어들입니다 */ \
+		BOOL Deserialize(SerializedBuffer &message) \
+		{ \
+			INT32 readSize = DeserializeFrom(message.GetBufferRead(), message.GetBufferSizeUsed()); \
+			if (readSize < 0) return false; \
+			INT32 movedSize; \
+			return message.MoveReadPointer(readSize, &movedSize); \
+		} \
+		\
+		/* PacketView의 읽기 위치부터 메시지 타입 뒤의 페이로드를 읽어들입니다 */ \
+		BOOL Deserialize(PacketView &message) \
+		{ \
+			INT32 readSize = DeserializeFrom(message.GetBufferRead(), message.GetBufferSizeUsed()); \
+			if (readSize < 0) return false; \
+			return message.MoveReadPointer(readSize); \
+		} \
+	};
@@ -1,25 +1,86 @@
 ﻿#pragma once
 
+#ifdef _WIN32
 #include <Windows.h>
 #include <synchapi.h>
+#else
+#include "CoreLinux.h"
+#endif
 
 namespace azely {
 
 	/**
 	 * \brief TCP 수신 및 송신 L7 레벨 버퍼링을 위한 링버퍼
+	 * \details 미러 모드에서는 같은 물리 페이지를 가상 주소에 두 번 이어 매핑하여, 읽기와 쓰기 구간이 경계에서 끊기지 않습니다
+	 * Produce, LoadReadable, Consume은 동기화 모드에 맞게 동기화하며, 그 외의 함수는 호출한 쪽에서 동기화해야 합니다
+	 * SYNC_MPSC에서는 공개된 쓰기 위치를 쓰기 포인터 대신 공개 상태에 두므로, 크기를 구하는 함수들은 SYNC_LOCK, SYNC_SPSC에서만 맞는 값을 리턴합니다
 	 */
 	class RingBuffer
 	{
+	public:
 		enum Constants
 		{
-			BUFFER_SIZE_DEFAULT = 10240
+			BUFFER_SIZE_DEFAULT = 10240,
+			MPSC_SLOT_COUNT = 256
+		};
+
+		/**
+		 * \brief Produce, LoadReadable, Consume의 동기화 모드
+		 */
+		enum SyncMode
+		{
+			// 내부 SRW 락으로 동기화합니다
+			SYNC_LOCK = 0,
+			// 생산자 스레드가 하나일 때, 락 없이 읽기 포인터와 쓰기 포인터를 acquire/release로 주고받습니다
+			SYNC_SPSC = 1,
+			// 생산자 스레드가 여럿일 때, 구간과 티켓을 CAS 한 번으로 예약하고 복사를 마치면 티켓의 커밋 슬롯에 표시합니다
+			// 커밋 슬롯을 확인한 스레드가 앞에서부터 이어서 커밋된 구간을 한 번에 공개하므로, 생산자끼리 서로를 기다리지 않습니다
+			// 선점된 생산자가 있으면 그 뒤의 구간은 공개가 늦어질 뿐이며, 공개되지 않은 예약이 MPSC_SLOT_COUNT개를 넘으면 버퍼가 가득 찬 것처럼 실패합니다
+			SYNC_MPSC = 2
+		};
+
+		/**
+		 * \brief Reserve로 예약한 쓰기 구간, 또는 LoadReadable로 가져온 읽기 구간
+		 * \details 구간이 버퍼 끝에서 끊긴다면 나머지는 second 에 이어집니다 (끊기지 않는다면 secondSize는 0)
+		 */
+		struct Reservation
+		{
+			PCHAR	first;
+			INT32	firstSize;
+			PCHAR	second;
+			INT32	secondSize;
 		};
 
-	public:
 		RingBuffer();
 		RingBuffer(int bufferSize);
+
+		/**
+		 * \brief 링버퍼 생성자
+		 * \param bufferSize 버퍼 크기
+		 * \param isMirrored true라면 미러 모드로 만듭니다 (크기는 할당 단위로 올림되며, 매핑에 실패하면 일반 모드로 만듭니다)
+		 * \param syncMode Produce, LoadReadable, Consume의 동기화 모드
+		 */
+		RingBuffer(int bufferSize, bool isMirrored, SyncMode syncMode = SYNC_LOCK);
 		~RingBuffer();
 
+		/**
+		 * \brief 미러 모드인지 여부를 리턴합니다
+		 * \return 미러 모드 여부
+		 */
+		bool IsMirrored() const
+		{
+			return mirrored;
+		}
+
+		/**
+		 * \brief 동기화 모드를 리턴합니다
+		 * \return 동기화 모드
+		 */
+		SyncMode GetSyncMode() const
+		{
+			return syncMode;
+		}
+
 		/**
 		 * \brief 버퍼의 총 크기를 리턴합니다
 		 * \return 버퍼의 총 크기
@@ -61,8 +122,11 @@ namespace azely {
 		 */
 		int GetSizeDirectEnqueueAble() const
 		{
+			if (mirrored) return GetSizeFree();
 			if (write >= read)
 			{
+				// 읽기 포인터가 버퍼 처음에 있다면, 쓰기 포인터가 끝까지 가서 읽기 포인터와 겹치지 않도록 한 칸을 비워둡니다
+				if (read == begin) return end - write - 1;
 				return end - write;
 			}
 			return read - write - 1;
@@ -74,6 +138,7 @@ namespace azely {
 		 */
 		int GetSizeDirectDequeueAble() const
 		{
+			if (mirrored) return GetSizeUsed();
 			if (write >= read)
 			{
 				return write - read;
@@ -112,12 +177,54 @@ namespace azely {
 		 */
 		bool Peek(char *outData, int requestSize, int *outPeekSize, bool isPartialPeekAvailable = true);
 
+		/**
+		 * \brief 쓰기 포인터는 옮기지 않고, 직접 쓸 수 있는 구간을 예약합니다
+		 * \details 예약한 구간에 데이터를 쓴 뒤 Commit으로 쓴 크기만큼 쓰기 포인터를 이동시킵니다
+		 * 중간 버퍼 없이 링버퍼에 바로 직렬화할 때 사용합니다
+		 * \param requestSize 예약할 크기
+		 * \param outReservation [out] 예약된 쓰기 구간
+		 * \return 빈 공간이 부족하다면 false
+		 */
+		bool Reserve(int requestSize, Reservation *outReservation);
+
+		/**
+		 * \brief Reserve로 예약한 구간 중 실제로 쓴 크기만큼 쓰기 포인터를 이동시킵니다
+		 * \param commitSize 쓴 크기
+		 * \return 빈 공간보다 크다면 false
+		 */
+		bool Commit(int commitSize);
+
+		/**
+		 * \brief 생산자 스레드에서 동기화 모드에 맞게 데이터를 인큐합니다
+		 * \details 데이터 전체가 들어갈 공간이 없다면 아무것도 넣지 않습니다
+		 * \param data 넣을 데이터
+		 * \param requestSize 넣을 크기
+		 * \return 빈 공간이 부족하다면 false
+		 */
+		bool Produce(const char *data, int requestSize);
+
+		/**
+		 * \brief 소비자 스레드에서 동기화 모드에 맞게 읽을 수 있는 구간을 가져옵니다
+		 * \details 소비자는 한 번에 하나의 스레드만 될 수 있습니다
+		 * \param outReadable [out] 읽을 수 있는 구간 (버퍼 끝에서 끊긴다면 나머지는 second)
+		 * \return 읽을 수 있는 크기
+		 */
+		int LoadReadable(Reservation *outReadable);
+
+		/**
+		 * \brief 소비자 스레드에서 읽은 크기만큼 동기화 모드에 맞게 읽기 포인터를 이동시킵니다
+		 * \param consumeSize 읽은 크기
+		 */
+		void Consume(int consumeSize);
+
 		/**
 		 * \brief 링버퍼를 초기화합니다
 		 */
 		void Clear()
 		{
 			read = write = begin;
+			reserveState = publishState = 0;
+			if (commitSlots != nullptr) ZeroMemory((PVOID)commitSlots, sizeof(LONG64) * MPSC_SLOT_COUNT);
 		}
 
 		/**
@@ -229,26 +336,82 @@ namespace azely {
 	private:
 
 		/**
-		 * \brief 포인터를 링버퍼의 경계에 맞추어 이동시킵니다
-		 * \param movingPointer 이동시킬 포인터의 포인터
-		 * \param movingSize 이동할 크기
+		 * \brief 같은 메모리를 두 번 이어 매핑한 버퍼를 만듭니다
+		 * \param requestSize 요청 크기 (할당 단위로 올림됩니다)
+		 * \return 성공 여부
+		 */
+		bool AllocateMirrored(int requestSize);
+
+		/**
+		 * \brief 포인터를 링버퍼의 경계에 맞추어 이동시킨 위치를 리턴합니다
+		 * \param pointer 기준 포인터
+		 * \param moveSize 이동할 크기
+		 * \return 이동한 포인터
+		 */
+		inline PCHAR Advance(PCHAR pointer, int moveSize) const
+		{
+			pointer += moveSize;
+			if (pointer >= end) pointer -= bufferSize;
+			return pointer;
+		}
+
+		/**
+		 * \brief 스냅샷한 읽기 포인터와 쓰기 포인터 사이의 사용중인 크기를 리턴합니다
+		 */
+		inline int GetSizeUsed(PCHAR readObserved, PCHAR writeObserved) const
+		{
+			if (writeObserved >= readObserved) return (int)(writeObserved - readObserved);
+			return (int)((end - readObserved) + (writeObserved - begin));
+		}
+
+		/**
+		 * \brief 티켓과 버퍼 안의 위치를 예약, 공개 상태 하나로 묶습니다
+		 * \param ticket 상위 32비트에 들어갈 티켓
+		 * \param offset 하위 32비트에 들어갈 버퍼 시작으로부터의 위치
+		 */
+		static inline LONG64 MakeState(DWORD ticket, INT32 offset)
+		{
+			return (LONG64)(((DWORD64)ticket << 32) | (DWORD)offset);
+		}
+
+		/**
+		 * \brief 공개 상태의 다음 티켓부터 이어서 커밋된 구간들을 공개합니다 (SYNC_MPSC)
+		 * \details 여러 스레드가 동시에 호출해도 공개 상태는 CAS로만 앞으로 옮겨지며, 커밋되지 않은 티켓을 만나면 멈춥니다
+		 * \return 공개 상태
+		 */
+		LONG64 Publish();
+
+		/**
+		 * \brief 스냅샷한 포인터 위치부터 [writeFrom, writeFrom + size) 구간에 데이터를 복사합니다
 		 */
-		inline void MovePointer(char **movingPointer, int movingSize)
+		inline void CopyAt(PCHAR writeFrom, const char *data, int size)
 		{
-			*movingPointer = *movingPointer + movingSize;
-			if (*movingPointer >= end)
+			int directSize = (int)(end - writeFrom);
+			if (mirrored || directSize >= size)
 			{
-				int adjust = (int)(*movingPointer - end);
-				*movingPointer = begin + adjust;
+				memcpy(writeFrom, data, size);
+				return;
 			}
+			memcpy(writeFrom, data, directSize);
+			memcpy(begin, data + directSize, size - directSize);
 		}
 
 		SRWLOCK srw;
 		PCHAR	begin;
 		PCHAR	end;
 		INT32	bufferSize;
-		PCHAR	read;
-		PCHAR	write;
+		SyncMode syncMode;
+		bool	mirrored;
+
+		// 소비자가 옮기는 읽기 포인터와 생산자가 옮기는 쓰기, 예약 포인터는 서로 다른 캐시라인에 둡니다
+		alignas(64) PCHAR volatile	read;
+		alignas(64) PCHAR volatile	write;
+
+		// SYNC_MPSC의 예약 상태와 공개 상태 (상위 32비트 다음 티켓, 하위 32비트 버퍼 시작으로부터의 위치)
+		// 커밋 슬롯에는 티켓 t의 구간 복사를 마친 생산자가 t + 1과 구간 끝 위치를 묶어 t % MPSC_SLOT_COUNT번에 씁니다
+		alignas(64) LONG64 volatile	reserveState;
+		alignas(64) LONG64 volatile	publishState;
+		LONG64 volatile				*commitSlots;
 	};
 
 }
\ No newline at end of file
@@ -21,21 +21,32 @@ namespace azely {
 
 		virtual ~SerializedBuffer();
 
+	protected:
+		/**
+		 * \brief 이미 할당된 공간을 버퍼로 사용하는 직렬화 버퍼를 만듭니다 (소멸할 때 버퍼를 해제하지 않습니다)
+		 * \param storage 버퍼로 사용할 공간
+		 * \param bufferSize 버퍼 크기
+		 */
+		SerializedBuffer(PUCHAR storage, INT32 bufferSize);
+
+	public:
+
 		/**
 		 * \brief 직렬화 버퍼를 초기화합니다
-		 * \param reserveHeaderSize 네트워크 헤더 크기만큼의 공간을 할당할지 여부
+		 * \param reserveHeaderSize 네트워크 헤더 최대 크기만큼의 공간을 할당할지 여부
 		 */
 		__inline VOID Clear(bool reserveHeaderSize)
 		{
 			if (reserveHeaderSize) 
 			{
-				write = begin + NETWORK_HEADER_SIZE;
+				write = begin + NETWORK_HEADER_SIZE_MAX;
 			}
 			else 
 			{
 				write = begin;
 			}
 			read = begin;
+			isHeaderBuilt = false;
 		}
 
 		/**
@@ -44,7 +55,7 @@ namespace azely {
 		 */
 		__inline INT32 GetBufferSizeTotal() const
 		{
-			return BUFFER_SIZE_DEFAULT;
+			return bufferSize;
 		}
 
 		/**
@@ -62,7 +73,7 @@ namespace azely {
 		 */
 		__inline INT32 GetBufferSizeFree() const
 		{
-			return GetBufferSizeTotal() - GetBufferSizeUsed();
+			return end - write;
 		}
 
 		/**
@@ -91,7 +102,7 @@ namespace azely {
 		 */
 		BOOL MoveReadPointer(INT32 moveSize, PINT32 outMovedSize)
 		{
-			if (read + moveSize >= end)
+			if (read + moveSize > end)
 			{
 				return false;
 			}
@@ -108,7 +119,7 @@ namespace azely {
 		 */
 		BOOL MoveWritePointer(INT32 moveSize, PINT32 outMovedSize)
 		{
-			if (write + moveSize >= end)
+			if (write + moveSize > end)
 			{
 				return false;
 			}
@@ -156,14 +167,16 @@ namespace azely {
 		}
 
 		/**
-		 * \brief 체크섬을 비교합니다
+		 * \brief 읽기 포인터부터 쓰기 포인터까지의 페이로드로 NETWORK_CHECKSUM을 계산하여 비교합니다
 		 * \param checksum 비교할 체크섬
 		 * \return 체크섬 유효 여부
 		 */
-		BOOL VerifyChecksum(UCHAR checksum);
+		BOOL VerifyChecksum(UINT32 checksum);
 
 		/**
 		 * \brief 네트워크 헤더에 맞추어 직렬화 버퍼의 맨 앞 부분을 채웁니다
+		 * \details Clear(true)로 비워둔 공간 중 페이로드 바로 앞에 헤더를 채우고, 읽기 포인터를 헤더 시작으로 옮깁니다
+		 * 헤더 크기는 페이로드 길이에 따라 달라지며, 여러 번 호출해도 같은 결과가 됩니다
 		 */
 		VOID BuildNetworkHeader();
 
@@ -180,8 +193,11 @@ namespace azely {
 		SerializedBuffer &operator << (SHORT shortValue);
 		SerializedBuffer &operator << (UINT32 uintValue);
 		SerializedBuffer &operator << (INT32 intValue);
+#ifdef _WIN32
+		// Linux 에서 LONG, ULONG 은 INT32, UINT32 와 같은 타입입니다
 		SerializedBuffer &operator << (ULONG ulongValue);
 		SerializedBuffer &operator << (LONG longValue);
+#endif
 		SerializedBuffer &operator << (UINT64 uint64Value);
 		SerializedBuffer &operator << (INT64 int64Value);
 		SerializedBuffer &operator << (FLOAT floatValue);
@@ -193,8 +209,10 @@ namespace azely {
 		SerializedBuffer &operator >> (SHORT &outShortValue);
 		SerializedBuffer &operator >> (UINT32 &outUintValue);
 		SerializedBuffer &operator >> (INT32 &outIntValue);
+#ifdef _WIN32
 		SerializedBuffer &operator >> (ULONG &outUlongValue);
 		SerializedBuffer &operator >> (LONG &outLongValue);
+#endif
 		SerializedBuffer &operator >> (UINT64 &outUint64Value);
 		SerializedBuffer &operator >> (INT64 &outInt64Value);
 		SerializedBuffer &operator >> (FLOAT &outFloatValue);
@@ -207,9 +225,33 @@ namespace azely {
 		PUCHAR	write;
 		PUCHAR	read;
 		INT32	bufferSize;
+		// 버퍼를 직접 할당하여 소멸할 때 해제해야 하는지 여부
+		BOOL	isStorageOwned;
+
+		// IOCPServer::AllocPacket으로 할당한 메시지의 참조 카운트 (송신 큐에 들어있는 개수 + 호출한 쪽의 참조)
+		volatile LONG	refCount;
+		// SendPacketPooled에서 네트워크 헤더를 이미 채웠는지 여부
+		BOOL			isHeaderBuilt;
 
 		friend class IOCPServer;
 
 	};
 
+	/**
+	 * \brief 버퍼를 오브젝트 안에 이어서 가지는 직렬화 버퍼
+	 * \details 오브젝트와 버퍼를 한 번에 할당하므로, 헤더와 페이로드 앞부분이 같은 캐시 라인에 놓입니다 / PacketPool의 크기 등급마다 하나씩 사용합니다
+	 * \tparam SIZE 버퍼 크기
+	 */
+	template <INT32 SIZE>
+	class SerializedBufferInline : public SerializedBuffer
+	{
+	public:
+		SerializedBufferInline() : SerializedBuffer(storage, SIZE)
+		{
+		}
+
+	private:
+		UCHAR	storage[SIZE];
+	};
+
 }
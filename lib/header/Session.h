@@ -3,23 +3,53 @@
 #include "Core.h"
 
 #include "RingBuffer.h"
+#include "MessageQueue.h"
+#include "NetworkHeader.h"
+#include "SessionCipher.h"
 
 #define SESSION_ADDRESS_WCHAR_LENGTH 32
 
+// sendZeroCopy 설정이 켜져 있을 때, 한 번의 송신 요청에 모아 넘길 수 있는 최대 패킷 개수
+#define SESSION_SEND_GATHER_MAX 64
+
+// AcceptEx 가 주소 하나를 기록하는데 필요한 크기
+#define SESSION_ACCEPT_ADDRESS_LENGTH (sizeof(SOCKADDR_IN) + 16)
+
 namespace azely
 {
+	class SerializedBuffer;
+
+	/**
+	 * \brief 메시지 큐의 노드
+	 * \details 수신한 메시지를 PacketThread로 넘기거나, sendZeroCopy 설정에서 보낼 패킷을 세션의 송신 큐에 넣을 때 사용합니다
+	 */
+	struct NetworkMessage
+	{
+		DWORD64				sessionID;
+		SerializedBuffer	*packet;
+		NetworkMessage		*volatile next;
+	};
+
 	/**
-	 * \brief OVERLAPPED 구조체를 확장하여 수신과 송신을 구분합니다
+	 * \brief OVERLAPPED 구조체를 확장하여 수신과 송신, 접속 수락을 구분합니다
+	 * \details epoll 백엔드에서는 OVERLAPPED 대신 준비 통지 상태를 담습니다
 	 */
 	struct OVERLAPPED_EXPAND
 	{
 		enum OVERLAPPED_TYPE
 		{
 			TYPE_RECV,
-			TYPE_SEND
+			TYPE_SEND,
+			TYPE_ACCEPT
 		};
 
+#ifdef _WIN32
 		OVERLAPPED			overlapped;
+#else
+		// epoll 준비 통지를 받은 횟수 (io_uring 백엔드에서는 사용하지 않습니다)
+		// 한 세션의 수신, 송신을 한 스레드만 처리하도록 하기 위해 사용합니다
+		DWORD				readiness;
+#endif
 		OVERLAPPED_TYPE		type;
 
 	};
@@ -29,8 +59,14 @@ namespace azely
 	 */
 	struct Session
 	{
-		Session() : sessionID(0), socket(INVALID_SOCKET), socketAddressIP(0), socketAddressPort(0), socketAddressString{0},
-			TimeoutTime(0), ioCount(0x80000000), ioFlag(0)
+		Session(bool isRingBufferMirrored = false, RingBuffer::SyncMode sendSyncMode = RingBuffer::SYNC_LOCK) : sessionID(0), socket(INVALID_SOCKET),
+			socketAddressIP(0), socketAddressPort(0), socketAddressString{0}, TimeoutTime(0),
+			RecvRingBuffer(RingBuffer::BUFFER_SIZE_DEFAULT, isRingBufferMirrored), RecvLargePacket(nullptr), RecvLargeRemain(0),
+			SendRingBuffer(RingBuffer::BUFFER_SIZE_DEFAULT, isRingBufferMirrored, sendSyncMode), SendGatherCount(0), SendGatherOffset(0),
+#ifndef _WIN32
+			RecvBufferRing(nullptr), RecvBufferTail(0), RecvWrittenSize(0), RecvProvidedSize(0),
+#endif
+			ioCount(0x80000000), ioFlag(0)
 		{
 			
 		}
@@ -44,8 +80,36 @@ namespace azely
 		DWORD				TimeoutTime;
 		OVERLAPPED_EXPAND	RecvOverlapped;
 		RingBuffer			RecvRingBuffer;
+		// 기본 패킷에 들어가지 않는 큰 메시지를 수신 링버퍼 밖에서 모으는 패킷과, 그 메시지의 헤더, 아직 받지 못한 페이로드 크기
+		SerializedBuffer	*RecvLargePacket;
+		NetworkHeader		RecvLargeHeader;
+		INT32				RecvLargeRemain;
 		OVERLAPPED_EXPAND	SendOverlapped;
 		RingBuffer			SendRingBuffer;
+		// SetSessionCipher로 켜는 메시지 암호화 상태 (꺼져 있다면 평문으로 주고받습니다)
+		SessionCipher		Cipher;
+
+		// sendZeroCopy 설정이 켜져 있을 때, 송신 링버퍼 대신 보낼 패킷을 넣는 송신 큐
+		MessageQueue<NetworkMessage>	SendQueue;
+		// 송신 큐에서 꺼내 보내는 중인 패킷들과, 그 중 첫 패킷에서 이미 보낸 크기
+		NetworkMessage		*SendGather[SESSION_SEND_GATHER_MAX];
+		INT32				SendGatherCount;
+		INT32				SendGatherOffset;
+#ifdef _WIN32
+		// 세션 테이블에서 미리 할당된 세션에 AcceptEx 를 걸어두기 위해 사용합니다
+		OVERLAPPED_EXPAND	AcceptOverlapped;
+		CHAR				AcceptAddressBuffer[SESSION_ACCEPT_ADDRESS_LENGTH * 2];
+#else
+		// io_uring 백엔드에서 보내는 중인 sendmsg 요청의 iovec과 msghdr (ioFlag를 든 동안만 사용합니다)
+		iovec				SendVector[SESSION_SEND_GATHER_MAX];
+		msghdr				SendMessage;
+		// io_uring multishot 수신에서 수신 링버퍼의 빈 구간을 커널에 빌려주는 슬롯의 버퍼 링과 그 tail,
+		// 커널이 채운 크기와 빌려준 크기의 누적값 (슬롯이 재사용되어도 이어서 사용하므로 세션을 생성할 때 초기화하지 않습니다)
+		io_uring_buf_ring	*RecvBufferRing;
+		USHORT				RecvBufferTail;
+		DWORD64				RecvWrittenSize;
+		DWORD64				RecvProvidedSize;
+#endif
 
 		alignas(64)	DWORD	ioCount;
 		alignas(64)	DWORD	ioFlag;
@@ -0,0 +1,109 @@
+﻿#pragma once
+
+#include "Core.h"
+
+// 세션 암호화 빌드 옵션
+// Windows에서는 운영체제의 CNG(bcrypt.lib)를 링크하고, Linux에서는 OpenSSL(libcrypto)을 사용하므로 -lcrypto 로 링크해야 합니다
+// 주석 처리하면 암호 라이브러리 없이 빌드되며, 그때 SetSessionCipher는 항상 실패합니다
+#define _SESSION_CIPHER
+
+namespace azely
+{
+	/**
+	 * \brief 세션 단위 AEAD 암호화
+	 * \details 세션의 송신과 수신 방향마다 따로 키와 IV를 두고, 메시지의 페이로드를 암호화하여 16바이트 인증 태그를 붙이고, 수신한 메시지는 제자리에서 복호화합니다
+	 * nonce는 TLS 1.3처럼 방향별 IV에 64비트 메시지 순번을 XOR 하여 만들기 때문에, 순번이 어긋난 메시지(재전송, 누락, 순서 뒤바뀜)는 인증에 실패합니다
+	 * 암호 연산은 Windows에서는 CNG(BCrypt), Linux에서는 OpenSSL(libcrypto)을 사용하며, 두 라이브러리 모두 CPU에 맞는 AES-NI, AVX2 구현을 골라 사용합니다
+	 */
+	class SessionCipher
+	{
+	public:
+		enum Suite
+		{
+			SUITE_NONE,
+			SUITE_AES_128_GCM,
+			SUITE_AES_256_GCM,
+			SUITE_CHACHA20_POLY1305
+		};
+
+		enum Constants
+		{
+			KEY_SIZE_MAX = 32,
+			IV_SIZE = 12,
+			TAG_SIZE = 16
+		};
+
+		/**
+		 * \brief 세션에 설정할 키 재료
+		 * \details 송신 키는 상대방의 수신 키와, 수신 키는 상대방의 송신 키와 같아야 합니다
+		 */
+		struct Key
+		{
+			Suite	suite;
+			UCHAR	sendKey[KEY_SIZE_MAX];
+			UCHAR	sendIV[IV_SIZE];
+			UCHAR	recvKey[KEY_SIZE_MAX];
+			UCHAR	recvIV[IV_SIZE];
+		};
+
+		SessionCipher();
+		~SessionCipher();
+
+		SessionCipher(const SessionCipher&) = delete;
+		SessionCipher& operator=(const SessionCipher&) = delete;
+
+		/**
+		 * \brief 키를 설정하고 암호화를 켭니다 / 메시지 순번은 0부터 시작합니다
+		 * \param key 키 재료
+		 * \return 성공 여부 (지원하지 않는 알고리즘이거나 _SESSION_CIPHER 없이 빌드했다면 실패합니다)
+		 */
+		BOOL Initialize(const Key *key);
+
+		/**
+		 * \brief 키를 지우고 암호화를 끕니다
+		 */
+		VOID Release();
+
+		/**
+		 * \brief 암호화가 켜져 있는지 여부를 리턴합니다
+		 */
+		inline BOOL IsEnabled() const { return suite != SUITE_NONE; }
+
+		/**
+		 * \brief 송신 순번의 nonce로 데이터를 암호화합니다
+		 * \details 순번이 곧 송신 순서여야 하므로, 암호화부터 송신 버퍼에 넣기까지 LockSend로 잠근 상태에서 호출해야 합니다
+		 * \param data 암호화할 데이터
+		 * \param size 데이터 크기
+		 * \param out 암호문을 기록할 위치 (data와 같으면 제자리에서 암호화합니다)
+		 * \param tag 인증 태그를 기록할 위치 (TAG_SIZE 바이트)
+		 * \return 성공 여부
+		 */
+		BOOL Seal(const UCHAR *data, INT32 size, PUCHAR out, PUCHAR tag);
+
+		/**
+		 * \brief 수신 순번의 nonce로 데이터를 제자리에서 복호화하고 인증 태그를 검증합니다
+		 * \param data 복호화할 데이터 (평문으로 덮어씁니다)
+		 * \param size 데이터 크기
+		 * \param tag 수신한 인증 태그 (TAG_SIZE 바이트)
+		 * \return 인증 성공 여부
+		 */
+		BOOL Open(PUCHAR data, INT32 size, const UCHAR *tag);
+
+		inline VOID LockSend() { AcquireSRWLockExclusive(&sendSRW); }
+		inline VOID UnlockSend() { ReleaseSRWLockExclusive(&sendSRW); }
+
+	private:
+		VOID MakeNonce(const UCHAR *iv, DWORD64 sequence, PUCHAR nonce);
+
+		Suite		suite;
+		// 방향별 암호 컨텍스트 (Windows에서는 BCRYPT_KEY_HANDLE, Linux에서는 EVP_CIPHER_CTX)
+		PVOID		sendContext;
+		PVOID		recvContext;
+		UCHAR		sendIV[IV_SIZE];
+		UCHAR		recvIV[IV_SIZE];
+		DWORD64		sendSequence;
+		DWORD64		recvSequence;
+		SRWLOCK		sendSRW;
+	};
+
+}
@@ -0,0 +1,142 @@
+﻿#pragma once
+
+#include "Core.h"
+
+#include "Session.h"
+
+namespace azely
+{
+	/**
+	 * \brief 최대 세션 개수만큼 세션을 미리 만들어두는 고정 크기 세션 테이블
+	 * \details 세션 ID의 하위 32비트는 슬롯 번호, 상위 32비트는 슬롯을 재사용할 때마다 증가하는 세대입니다
+	 * 세션을 찾을 때는 잠금 없이 슬롯을 인덱싱하고 세대를 비교합니다
+	 * 빈 슬롯은 샤드마다 따로 가진 lock-free 스택으로 관리하며, 슬롯 번호를 샤드 개수로 나눈 나머지가 슬롯의 샤드입니다
+	 */
+	class SessionTable
+	{
+		enum Constants
+		{
+			SLOT_EMPTY = 0xffffffff
+		};
+
+	public:
+		/**
+		 * \brief 세션 테이블 생성자
+		 * \param capacity 최대 세션 개수
+		 * \param shardCount 빈 슬롯 스택을 나눌 샤드 개수
+		 * \param isRingBufferMirrored 세션의 송수신 링버퍼를 미러 모드로 만들지 여부
+		 * \param sendSyncMode 세션의 송신 링버퍼 동기화 모드
+		 */
+		SessionTable(INT32 capacity, INT32 shardCount, bool isRingBufferMirrored, RingBuffer::SyncMode sendSyncMode);
+		~SessionTable();
+
+		/**
+		 * \brief 빈 슬롯을 할당하고 세대를 증가시켜 새 세션 ID를 부여합니다
+		 * \details 지정한 샤드에 빈 슬롯이 없다면 다른 샤드의 빈 슬롯을 할당합니다
+		 * \param shardIndex 우선 할당할 샤드 번호
+		 * \return 할당된 세션 (세션 ID가 부여된 상태), 빈 슬롯이 없다면 nullptr
+		 */
+		Session		*Alloc(INT32 shardIndex);
+
+		/**
+		 * \brief 세션의 슬롯을 빈 슬롯으로 반환합니다
+		 * \param session 반환할 세션
+		 */
+		VOID		Free(Session *session);
+
+		/**
+		 * \brief 세션 ID로 세션을 찾습니다
+		 * \details 세션의 IO Count를 올리기 전에는 슬롯이 재사용될 수 있으므로, 호출한 쪽에서 다시 세션 ID를 확인해야 합니다
+		 * \param sessionID 찾을 세션 ID
+		 * \return 세대까지 일치하는 세션, 없다면 nullptr
+		 */
+		Session		*Find(DWORD64 sessionID) const
+		{
+			DWORD slotIndex = static_cast<DWORD>(sessionID);
+			if (slotIndex >= static_cast<DWORD>(capacity)) return nullptr;
+			Session *session = &sessions[slotIndex];
+			if (session->sessionID != sessionID) return nullptr;
+			return session;
+		}
+
+		/**
+		 * \brief 슬롯 번호로 세션을 가져옵니다
+		 * \param slotIndex 슬롯 번호
+		 * \return 슬롯의 세션
+		 */
+		Session		*At(INT32 slotIndex) const
+		{
+			return &sessions[slotIndex];
+		}
+
+		/**
+		 * \brief 세션 ID의 슬롯 번호를 반환합니다
+		 * \param sessionID 세션 ID
+		 * \return 슬롯 번호
+		 */
+		DWORD		GetSlotIndex(DWORD64 sessionID) const
+		{
+			return static_cast<DWORD>(sessionID);
+		}
+
+		/**
+		 * \brief 세션 ID가 속한 샤드 번호를 반환합니다
+		 * \param sessionID 세션 ID
+		 * \return 샤드 번호
+		 */
+		INT32		GetShardIndex(DWORD64 sessionID) const
+		{
+			return static_cast<DWORD>(sessionID) % shardCount;
+		}
+
+		/**
+		 * \brief 세션 테이블의 최대 세션 개수를 반환합니다
+		 * \return 최대 세션 개수
+		 */
+		INT32		GetCapacity() const
+		{
+			return capacity;
+		}
+
+		/**
+		 * \brief 사용중인 슬롯 개수를 반환합니다
+		 * \return 사용중인 슬롯 개수
+		 */
+		INT32		GetCountUse() const
+		{
+			return countUse;
+		}
+
+	private:
+		/**
+		 * \brief 샤드의 빈 슬롯 스택에서 슬롯을 꺼냅니다
+		 * \param shardIndex 샤드 번호
+		 * \return 슬롯 번호, 비어있다면 SLOT_EMPTY
+		 */
+		DWORD		PopSlot(INT32 shardIndex);
+
+		/**
+		 * \brief 샤드의 빈 슬롯 스택에 슬롯을 넣습니다
+		 * \param shardIndex 샤드 번호
+		 * \param slotIndex 슬롯 번호
+		 */
+		VOID		PushSlot(INT32 shardIndex, DWORD slotIndex);
+
+		/**
+		 * \brief 샤드의 빈 슬롯 스택 머리
+		 * \details 상위 32비트는 ABA 방지용 태그, 하위 32비트는 맨 위 슬롯 번호입니다
+		 */
+		struct SlotStack
+		{
+			alignas(64) volatile DWORD64	top;
+		};
+
+		Session								*sessions;
+		DWORD								*slotNext;
+		SlotStack							*slotStacks;
+		INT32								capacity;
+		INT32								shardCount;
+		alignas(64) volatile LONG			countUse;
+	};
+
+}
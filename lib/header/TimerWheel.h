@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include "Core.h"
+
+namespace azely
+{
+	/**
+	 * \brief 항목 번호(세션 테이블의 슬롯 번호)에 만료 시간을 거는 계층형 타이머 휠
+	 * \details 1단계는 틱 단위 256칸, 2~4단계는 앞 단계 한 바퀴 단위 64칸이며, 상위 단계의 칸은 차례가 되면 하위 단계로 내려갑니다
+	 * 항목마다 한 번만 걸리며, 이미 걸린 항목을 다시 걸면 무시됩니다 (만료 시점에 실제 만료 시간을 확인하여 다시 거는 방식)
+	 * 잠금은 사용하는 쪽에서 걸어야 합니다
+	 */
+	class TimerWheel
+	{
+		// 빈 슬롯과 목록의 끝을 뜻하는 항목 번호, 부호 있는 크기 상수들과 섞이지 않도록 enum 밖에 둡니다
+		static const DWORD ENTRY_NONE = 0xffffffff;
+
+		enum Constants
+		{
+			LEVEL_COUNT = 4,
+			LEVEL_FIRST_BITS = 8,
+			LEVEL_BITS = 6,
+			LEVEL_FIRST_SIZE = 1 << LEVEL_FIRST_BITS,
+			LEVEL_SIZE = 1 << LEVEL_BITS,
+			TICK_SPAN_MAX = (1 << (LEVEL_FIRST_BITS + LEVEL_BITS * (LEVEL_COUNT - 1))) - 1
+		};
+
+	public:
+		/**
+		 * \brief 타이머 휠 생성자
+		 * \param capacity 최대 항목 개수
+		 * \param tickInterval 한 틱의 길이 (ms)
+		 * \param currentTime 현재 시간 (timeGetTime)
+		 */
+		TimerWheel(INT32 capacity, DWORD tickInterval, DWORD currentTime);
+		~TimerWheel();
+
+		/**
+		 * \brief 항목에 만료 시간을 겁니다
+		 * \details 이미 걸려있는 항목이라면 아무것도 하지 않습니다
+		 * \param entryIndex 항목 번호
+		 * \param expireTime 만료 시간 (timeGetTime 기준)
+		 */
+		VOID	Schedule(DWORD entryIndex, DWORD expireTime);
+
+		/**
+		 * \brief 현재 시간까지 휠을 진행시키고, 만료된 항목을 휠에서 빼내어 반환합니다
+		 * \param currentTime 현재 시간 (timeGetTime)
+		 * \param expiredEntries 만료된 항목 번호를 담을 배열 (최대 항목 개수 크기)
+		 * \return 만료된 항목 개수
+		 */
+		INT32	Advance(DWORD currentTime, DWORD *expiredEntries);
+
+	private:
+		/**
+		 * \brief 만료 틱에 맞는 단계와 칸을 찾아 항목을 넣습니다
+		 * \param entryIndex 항목 번호
+		 */
+		VOID	Link(DWORD entryIndex);
+
+		/**
+		 * \brief 상위 단계의 칸을 비우고 항목들을 다시 넣어 하위 단계로 내립니다
+		 * \param level 단계
+		 * \param slotIndex 칸 번호
+		 */
+		VOID	Cascade(INT32 level, DWORD slotIndex);
+
+		DWORD	*slots[LEVEL_COUNT];
+		DWORD	*entryNext;
+		DWORD	*entryExpireTick;
+		BOOL	*entryLinked;
+		DWORD	tickInterval;
+		DWORD	tickTime;
+		DWORD	tickCurrent;
+	};
+
+}